@@ -0,0 +1,58 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmark of the aggregation of small messages : rate of items exchanged between all the
+// processes for several batch sizes ( a batch of one item is one message per item )
+//
+// Usage : bench_aggregation [nb_items_per_process] [max_batch_size]
+#include "parallel/aggregator.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include <iostream>
+#include <mpi.h>
+#include <string>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    long nb_items              = (nargs > 1 ? std::stol(argv[1]) : 1000000L);
+    std::size_t max_batch_size = (nargs > 2 ? std::stoul(argv[2]) : std::size_t(16384));
+
+    if (com.rank == 0) {
+        std::cout << "# Exchange of " << nb_items << " items of " << sizeof(long) << " bytes per process on "
+                  << com.size << " processes" << std::endl;
+        std::cout << "batch_size,messages,time(s),items/s" << std::endl;
+    }
+    for (std::size_t batch_size = 1; batch_size <= max_batch_size; batch_size *= 4) {
+        long sum = 0;
+        // The one item batches are much slower : less items are sent
+        long n = (batch_size == 1 ? std::min(nb_items, 100000L) : nb_items);
+        Parallel::Aggregator<long> channel(com, [&sum](int, const long &item) { sum += item; }, batch_size);
+        com.barrier();
+        double start = MPI_Wtime();
+        for (long i = 0; i < n; ++i) {
+            channel.send(i, int((com.rank + i) % com.size));
+            if ((i & 1023) == 0) channel.poll();
+        }
+        channel.finish();
+        double loc_time = MPI_Wtime() - start, time;
+        com.allreduce(loc_time, time, Parallel::max);
+        std::size_t messages, loc_messages = channel.nbMessagesSent();
+        com.allreduce(loc_messages, messages, Parallel::sum);
+        if (com.rank == 0)
+            std::cout << batch_size << "," << messages << "," << time << "," << double(n) * com.size / time
+                      << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
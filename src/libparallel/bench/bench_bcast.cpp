@@ -0,0 +1,74 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmark of the pipelined broadcast against the plain MPI_Bcast for several message sizes
+//
+// Usage : bench_bcast [max_size_in_bytes] [segment_size_in_bytes] [nb_repetitions]
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace {
+// Return the maximal time ( over all processes ) spent for one call of the broadcast function
+double measure(const Parallel::Communicator &com, int nb_repetitions, const std::function<void()> &bcast) {
+    bcast(); // Warm up
+    com.barrier();
+    double start = MPI_Wtime();
+    for (int i = 0; i < nb_repetitions; ++i) bcast();
+    double loc_time = (MPI_Wtime() - start) / nb_repetitions, time;
+    com.allreduce(loc_time, time, Parallel::max);
+    return time;
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    std::size_t max_size     = (nargs > 1 ? std::stoul(argv[1]) : std::size_t(64) << 20);
+    std::size_t segment_size = (nargs > 2 ? std::stoul(argv[2]) : Parallel::Communicator::default_segment_size);
+    int nb_repetitions       = (nargs > 3 ? std::stoi(argv[3]) : 10);
+
+    if (com.rank == 0) {
+        std::cout << "# Broadcast on " << com.size << " processes, segments of " << segment_size << " bytes"
+                  << std::endl;
+        std::cout << "bytes,algorithm,time(s),bandwidth(MB/s)" << std::endl;
+    }
+    for (std::size_t size = 1024; size <= max_size; size *= 4) {
+        std::vector<char> buffer(size, char(com.rank));
+        std::vector<std::pair<std::string, std::function<void()>>> algorithms{
+            {"MPI_Bcast", [&]() { MPI_Bcast(buffer.data(), int(size), MPI_CHAR, 0, MPI_COMM_WORLD); }},
+            {"bcast", [&]() { com.bcast(size, buffer.data(), buffer.data(), 0); }},
+            {"pipelined_chain",
+             [&]() {
+                 com.pipelined_bcast(size, buffer.data(), buffer.data(), 0, segment_size,
+                                     Parallel::Communicator::BroadcastTree::chain);
+             }},
+            {"pipelined_binary", [&]() {
+                 com.pipelined_bcast(size, buffer.data(), buffer.data(), 0, segment_size,
+                                     Parallel::Communicator::BroadcastTree::binary);
+             }}};
+        for (const auto &algo : algorithms) {
+            double time = measure(com, nb_repetitions, algo.second);
+            if (com.rank == 0)
+                std::cout << size << "," << algo.first << "," << std::scientific << std::setprecision(4) << time
+                          << "," << std::fixed << std::setprecision(1) << (size / time) * 1.E-6 << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
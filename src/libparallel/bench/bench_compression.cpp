@@ -0,0 +1,74 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmark of the compressed broadcast against the plain broadcast of double buffers, for a smooth
+// field and for random values. The effective bandwidth is the size of the raw buffer divided by
+// the time of the broadcast ( compression and decompression included ).
+//
+// Usage : bench_compression [max_size_in_bytes] [nb_repetitions]
+#include "parallel/communicator"
+#include "parallel/compression.hpp"
+#include "parallel/context.hpp"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <mpi.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+double measure(const Parallel::Communicator &com, int nb_repetitions, const std::function<void()> &bcast) {
+    bcast(); // Warm up
+    com.barrier();
+    double start = MPI_Wtime();
+    for (int i = 0; i < nb_repetitions; ++i) bcast();
+    double loc_time = (MPI_Wtime() - start) / nb_repetitions, time;
+    com.allreduce(loc_time, time, Parallel::max);
+    return time;
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    std::size_t max_size = (nargs > 1 ? std::stoul(argv[1]) : std::size_t(64) << 20);
+    int nb_repetitions   = (nargs > 2 ? std::stoi(argv[2]) : 10);
+
+    if (com.rank == 0) {
+        std::cout << "# Broadcast of double buffers on " << com.size << " processes" << std::endl;
+        std::cout << "bytes,data,ratio,plain(MB/s),compressed(MB/s),gain" << std::endl;
+    }
+    std::mt19937_64 gen(2017);
+    std::uniform_real_distribution<double> dist(0., 1.);
+    for (std::size_t size = 1 << 16; size <= max_size; size *= 4) {
+        const std::size_t n = size / sizeof(double);
+        std::vector<double> smooth(n), noise(n), buffer(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            smooth[i] = std::exp(-1.E-6 * double(i)) * std::cos(1.E-3 * double(i));
+            noise[i]  = dist(gen);
+        }
+        for (auto data : {std::make_pair("smooth", &smooth), std::make_pair("random", &noise)}) {
+            const std::vector<double> &values = *data.second;
+            double ratio = double(size) / double(Parallel::Compression::compress(n, values.data()).size());
+            double plain = measure(com, nb_repetitions, [&]() { com.bcast(n, values.data(), buffer.data(), 0); });
+            double compressed =
+                measure(com, nb_repetitions, [&]() { com.bcastCompressed(n, values.data(), buffer.data(), 0); });
+            if (com.rank == 0)
+                std::cout << size << "," << data.first << "," << ratio << "," << 1.E-6 * size / plain << ","
+                          << 1.E-6 * size / compressed << "," << plain / compressed << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,83 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmark of the two level ( node aware ) broadcast and allreduce against the flat MPI versions.
+// Run it on 1, 8, 64, ... nodes with several processes per node : the number of nodes is printed
+// in the header of the results.
+//
+// Usage : bench_hierarchical [ranks_per_node] [max_size_in_bytes] [nb_repetitions]
+//         ranks_per_node = 0 uses the shared memory nodes, a positive value emulates nodes of
+//         ranks_per_node consecutive ranks
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace {
+// Return the maximal time ( over all processes ) spent for one call of the function
+double measure(const Parallel::Communicator &com, int nb_repetitions, const std::function<void()> &fct) {
+    fct(); // Warm up
+    com.barrier();
+    double start = MPI_Wtime();
+    for (int i = 0; i < nb_repetitions; ++i) fct();
+    double loc_time = (MPI_Wtime() - start) / nb_repetitions, time;
+    com.allreduce(loc_time, time, Parallel::max);
+    return time;
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    int ranks_per_node   = (nargs > 1 ? std::stoi(argv[1]) : 0);
+    std::size_t max_size = (nargs > 2 ? std::stoul(argv[2]) : std::size_t(16) << 20);
+    int nb_repetitions   = (nargs > 3 ? std::stoi(argv[3]) : 20);
+    com.setHierarchicalCollectives(std::numeric_limits<std::size_t>::max(), ranks_per_node);
+
+    int nb_nodes;
+    if (ranks_per_node > 0)
+        nb_nodes = (com.size + ranks_per_node - 1) / ranks_per_node;
+    else {
+        int is_leader = (com.split_shared()->rank == 0 ? 1 : 0);
+        com.allreduce(is_leader, nb_nodes, Parallel::sum);
+    }
+    if (com.rank == 0) {
+        std::cout << "# Collective operations on " << com.size << " processes and " << nb_nodes << " nodes"
+                  << std::endl;
+        std::cout << "bytes,algorithm,time(s),bandwidth(MB/s)" << std::endl;
+    }
+    for (std::size_t size = 8; size <= max_size; size *= 8) {
+        const std::size_t n = size / sizeof(double);
+        std::vector<double> snd(n, double(com.rank)), rcv(n);
+        std::vector<std::pair<std::string, std::function<void()>>> algorithms{
+            {"MPI_Bcast", [&]() { MPI_Bcast(rcv.data(), int(n), MPI_DOUBLE, 0, MPI_COMM_WORLD); }},
+            {"hierarchical_bcast", [&]() { com.hierarchical_bcast(n, rcv.data(), rcv.data(), 0); }},
+            {"MPI_Allreduce",
+             [&]() { MPI_Allreduce(snd.data(), rcv.data(), int(n), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD); }},
+            {"hierarchical_allreduce",
+             [&]() { com.hierarchical_allreduce(n, snd.data(), rcv.data(), Parallel::sum); }}};
+        for (const auto &algo : algorithms) {
+            double time = measure(com, nb_repetitions, algo.second);
+            if (com.rank == 0)
+                std::cout << size << "," << algo.first << "," << std::scientific << std::setprecision(4) << time
+                          << "," << std::fixed << std::setprecision(1) << (size / time) * 1.E-6 << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
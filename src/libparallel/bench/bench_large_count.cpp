@@ -0,0 +1,78 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmark of the messages and broadcasts of buffers around and above 2^31 bytes ( single calls,
+// the library splits them in blocks of Communicator::maxCount() elements when needed )
+//
+// Usage : bench_large_count [max_size_in_bytes] [nb_repetitions]
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace {
+// Return the maximal time ( over all processes ) spent for one call of the function
+double measure(const Parallel::Communicator &com, int nb_repetitions, const std::function<void()> &fct) {
+    fct(); // Warm up
+    com.barrier();
+    double start = MPI_Wtime();
+    for (int i = 0; i < nb_repetitions; ++i) fct();
+    double loc_time = (MPI_Wtime() - start) / nb_repetitions, time;
+    com.allreduce(loc_time, time, Parallel::max);
+    return time;
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    std::size_t max_size = (nargs > 1 ? std::stoul(argv[1]) : std::size_t(3) << 30);
+    int nb_repetitions   = (nargs > 2 ? std::stoi(argv[2]) : 3);
+
+    if (com.rank == 0) {
+        std::cout << "# Large messages on " << com.size << " processes, largest count " << Parallel::Communicator::maxCount()
+                  << std::endl;
+        std::cout << "bytes,operation,time(s),bandwidth(MB/s)" << std::endl;
+    }
+    for (std::size_t size = std::size_t(1) << 28; size <= max_size; size *= 2) {
+        std::vector<char> buffer(size, char(com.rank));
+        std::vector<std::pair<std::string, std::function<void()>>> operations{
+            {"bcast", [&]() { com.bcast(size, buffer.data(), buffer.data(), 0); }},
+            {"send_recv", [&]() {
+                 if (com.size < 2) return;
+                 if (com.rank == 0) com.send(size, buffer.data(), 1, 0);
+                 if (com.rank == 1) com.recv(size, buffer.data(), 0, 0);
+             }}};
+        for (const auto &operation : operations) {
+            double time = measure(com, nb_repetitions, operation.second);
+            if (com.rank == 0)
+                std::cout << size << "," << operation.first << "," << std::scientific << std::setprecision(4) << time
+                          << "," << std::fixed << std::setprecision(1) << (size / time) * 1.E-6 << std::endl;
+        }
+        // Above 2^31 bytes : the same buffer with a largest count of 2^30 ( several blocks )
+        if (size > std::size_t(Parallel::Communicator::default_max_count)) {
+            Parallel::Communicator::setMaxCount(std::size_t(1) << 30);
+            double time = measure(com, nb_repetitions, [&]() { com.bcast(size, buffer.data(), buffer.data(), 0); });
+            if (com.rank == 0)
+                std::cout << size << ",bcast_blocks_2^30," << std::scientific << std::setprecision(4) << time << ","
+                          << std::fixed << std::setprecision(1) << (size / time) * 1.E-6 << std::endl;
+            Parallel::Communicator::setMaxCount(Parallel::Communicator::default_max_count);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Microbenchmarks of the point to point and collective communications, each one measured with the
+// Communicator and with the raw MPI call on the same communicator, so the overhead of the wrapper
+// can be followed. The results are printed in CSV :
+//
+//   benchmark,implementation,processes,bytes,time(s),bandwidth(MB/s),rate(msg/s)
+//
+// time is the time of one operation ( half a round trip for the ping-pong, one message for the
+// message rate ). The point to point benchmarks use the ranks 0 and size/2 ( on another node when
+// the processes are placed by node ), the collective ones run on 2, 4, 8, ... processes and on all
+// the processes.
+//
+// Usage : bench_micro [max_size_in_bytes] [nb_repetitions] [benchmarks]
+//         benchmarks is a comma separated list among pingpong,bidirectional,rate,bcast,reduce,
+//         allreduce,alltoall ( all by default )
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mpi.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+// Return the maximal time ( over all processes ) spent for one call of the function
+double measure(const Parallel::Communicator &com, int nb_repetitions, const std::function<void()> &fct) {
+    fct(); // Warm up
+    com.barrier();
+    double start = MPI_Wtime();
+    for (int i = 0; i < nb_repetitions; ++i) fct();
+    double loc_time = (MPI_Wtime() - start) / nb_repetitions, time;
+    com.allreduce(loc_time, time, Parallel::max);
+    return time;
+}
+void print(const std::string &benchmark, const std::string &implementation, int nb_procs, std::size_t size,
+           double time, double nb_messages = 1.) {
+    std::cout << benchmark << "," << implementation << "," << nb_procs << "," << size << "," << std::scientific
+              << std::setprecision(4) << time << "," << std::fixed << std::setprecision(1)
+              << (nb_messages * size / time) * 1.E-6 << "," << std::setprecision(0) << nb_messages / time
+              << std::endl;
+}
+// Number of messages in flight for the message rate
+const int window_size = 64;
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    std::size_t max_size = (nargs > 1 ? std::stoul(argv[1]) : std::size_t(4) << 20);
+    int nb_repetitions   = (nargs > 2 ? std::stoi(argv[2]) : 50);
+    std::vector<std::string> selected;
+    std::istringstream list(nargs > 3 ? argv[3] : "pingpong,bidirectional,rate,bcast,reduce,allreduce,alltoall");
+    for (std::string name; std::getline(list, name, ',');) selected.push_back(name);
+    auto is_selected = [&](const std::string &name) {
+        for (const auto &s : selected)
+            if (s == name) return true;
+        return false;
+    };
+    if (com.rank == 0) {
+        std::cout << "# Communications on " << com.size << " processes" << std::endl;
+        std::cout << "benchmark,implementation,processes,bytes,time(s),bandwidth(MB/s),rate(msg/s)" << std::endl;
+    }
+
+    // Point to point between the ranks 0 and size/2
+    const int partner = com.size / 2;
+    const bool active = (com.size > 1) && ((com.rank == 0) || (com.rank == partner));
+    const int other   = (com.rank == 0 ? partner : 0);
+    // The raw MPI calls use the communicator of the wrapper
+    const MPI_Comm &mpi_com = com.externalCommunicator();
+    for (std::size_t size = 1; (com.size > 1) && (size <= max_size); size *= 4) {
+        std::vector<char> snd(size, 'a'), rcv(size), window(window_size * size);
+        if (is_selected("pingpong")) {
+            double t = measure(com, nb_repetitions, [&]() {
+                if (!active) return;
+                if (com.rank == 0) {
+                    com.send(size, snd.data(), other, 1);
+                    com.recv(size, rcv.data(), other, 1);
+                } else {
+                    com.recv(size, rcv.data(), other, 1);
+                    com.send(size, snd.data(), other, 1);
+                }
+            });
+            if (com.rank == 0) print("pingpong", "Communicator", 2, size, t / 2);
+            t = measure(com, nb_repetitions, [&]() {
+                if (!active) return;
+                if (com.rank == 0) {
+                    MPI_Send(snd.data(), int(size), MPI_CHAR, other, 1, mpi_com);
+                    MPI_Recv(rcv.data(), int(size), MPI_CHAR, other, 1, mpi_com, MPI_STATUS_IGNORE);
+                } else {
+                    MPI_Recv(rcv.data(), int(size), MPI_CHAR, other, 1, mpi_com, MPI_STATUS_IGNORE);
+                    MPI_Send(snd.data(), int(size), MPI_CHAR, other, 1, mpi_com);
+                }
+            });
+            if (com.rank == 0) print("pingpong", "MPI", 2, size, t / 2);
+        }
+        if (is_selected("bidirectional")) {
+            double t = measure(com, nb_repetitions, [&]() {
+                if (!active) return;
+                Parallel::Request req = com.irecv(size, rcv.data(), other, 2);
+                com.send(size, snd.data(), other, 2);
+                req.wait();
+            });
+            if (com.rank == 0) print("bidirectional", "Communicator", 2, size, t, 2.);
+            t = measure(com, nb_repetitions, [&]() {
+                if (!active) return;
+                MPI_Request req;
+                MPI_Irecv(rcv.data(), int(size), MPI_CHAR, other, 2, mpi_com, &req);
+                MPI_Send(snd.data(), int(size), MPI_CHAR, other, 2, mpi_com);
+                MPI_Wait(&req, MPI_STATUS_IGNORE);
+            });
+            if (com.rank == 0) print("bidirectional", "MPI", 2, size, t, 2.);
+        }
+        // Message rate : a window of messages from the rank 0, acknowledged by the partner
+        if (is_selected("rate")) {
+            double t = measure(com, nb_repetitions, [&]() {
+                if (!active) return;
+                std::vector<Parallel::Request> requests;
+                for (int m = 0; m < window_size; ++m) {
+                    if (com.rank == 0)
+                        requests.push_back(com.isend(size, snd.data(), other, 3));
+                    else
+                        requests.push_back(com.irecv(size, window.data() + m * size, other, 3));
+                }
+                for (auto &req : requests) req.wait();
+                char ack = 0;
+                if (com.rank == 0)
+                    com.recv(ack, other, 4);
+                else
+                    com.send(ack, other, 4);
+            });
+            if (com.rank == 0) print("rate", "Communicator", 2, size, t / window_size, window_size);
+            t = measure(com, nb_repetitions, [&]() {
+                if (!active) return;
+                std::vector<MPI_Request> requests(window_size);
+                for (int m = 0; m < window_size; ++m) {
+                    if (com.rank == 0)
+                        MPI_Isend(snd.data(), int(size), MPI_CHAR, other, 3, mpi_com, &requests[m]);
+                    else
+                        MPI_Irecv(window.data() + m * size, int(size), MPI_CHAR, other, 3, mpi_com, &requests[m]);
+                }
+                MPI_Waitall(window_size, requests.data(), MPI_STATUSES_IGNORE);
+                char ack = 0;
+                if (com.rank == 0)
+                    MPI_Recv(&ack, 1, MPI_CHAR, other, 4, mpi_com, MPI_STATUS_IGNORE);
+                else
+                    MPI_Send(&ack, 1, MPI_CHAR, other, 4, mpi_com);
+            });
+            if (com.rank == 0) print("rate", "MPI", 2, size, t / window_size, window_size);
+        }
+    }
+
+    // Collective operations on the first nb_procs processes
+    std::vector<int> nb_procs_list;
+    for (int p = 2; p < com.size; p *= 2) nb_procs_list.push_back(p);
+    nb_procs_list.push_back(com.size);
+    for (int nb_procs : nb_procs_list) {
+        Parallel::Communicator group(com, (com.rank < nb_procs ? 0 : 1), com.rank);
+        if (com.rank >= nb_procs) continue;
+        const MPI_Comm &mpi_group = group.externalCommunicator();
+        for (std::size_t size = 8; size <= max_size; size *= 4) {
+            const std::size_t n = size / sizeof(double);
+            std::vector<double> snd(n, double(group.rank)), rcv(n);
+            std::vector<std::pair<std::string, std::function<void()>>> benchmarks{
+                {"bcast", [&]() { group.bcast(n, rcv.data(), rcv.data(), 0); }},
+                {"bcast", [&]() { MPI_Bcast(rcv.data(), int(n), MPI_DOUBLE, 0, mpi_group); }},
+                {"reduce", [&]() { group.reduce(n, snd.data(), rcv.data(), Parallel::sum, 0); }},
+                {"reduce", [&]() { MPI_Reduce(snd.data(), rcv.data(), int(n), MPI_DOUBLE, MPI_SUM, 0, mpi_group); }},
+                {"allreduce", [&]() { group.allreduce(n, snd.data(), rcv.data(), Parallel::sum); }},
+                {"allreduce",
+                 [&]() { MPI_Allreduce(snd.data(), rcv.data(), int(n), MPI_DOUBLE, MPI_SUM, mpi_group); }}};
+            for (std::size_t b = 0; b < benchmarks.size(); ++b) {
+                if (!is_selected(benchmarks[b].first)) continue;
+                double t = measure(group, nb_repetitions, benchmarks[b].second);
+                if (group.rank == 0)
+                    print(benchmarks[b].first, (b % 2 == 0 ? "Communicator" : "MPI"), nb_procs, size, t);
+            }
+            // Alltoall : size bytes sent to each process
+            if (is_selected("alltoall")) {
+                std::vector<double> all_snd(n * nb_procs, 1.), all_rcv(n * nb_procs);
+                double t = measure(group, nb_repetitions, [&]() { group.alltoall(n, all_snd.data(), all_rcv.data()); });
+                if (group.rank == 0) print("alltoall", "Communicator", nb_procs, size, t, nb_procs - 1.);
+                t = measure(group, nb_repetitions, [&]() {
+                    MPI_Alltoall(all_snd.data(), int(n), MPI_DOUBLE, all_rcv.data(), int(n), MPI_DOUBLE, mpi_group);
+                });
+                if (group.rank == 0) print("alltoall", "MPI", nb_procs, size, t, nb_procs - 1.);
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
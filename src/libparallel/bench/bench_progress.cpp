@@ -0,0 +1,75 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmark of the overlap of the communications by the computations, with and without the
+// progress thread : each process posts a large exchange with its neighbours, computes, then waits.
+// The overlap is the part of the communication time hidden by the computation.
+//
+// Usage : bench_progress [max_size_in_bytes] [interval_in_seconds] [core]
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace {
+double compute(double seconds) {
+    double start = MPI_Wtime(), x = 0.;
+    while (MPI_Wtime() - start < seconds)
+        for (int i = 0; i < 1000; ++i) x += std::sqrt(double(i));
+    return x;
+}
+// Maximal time ( over all processes ) of the exchange of size bytes overlapped by a computation
+double exchange(const Parallel::Communicator &com, std::size_t size, double compute_time) {
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+    std::vector<char> snd(size, char(com.rank)), rcv(size);
+    com.barrier();
+    double start              = MPI_Wtime();
+    Parallel::Request rcv_req = com.irecv(size, rcv.data(), prev, 1);
+    Parallel::Request snd_req = com.isend(size, snd.data(), next, 1);
+    if (compute_time > 0.) compute(compute_time);
+    snd_req.wait();
+    rcv_req.wait();
+    double loc_time = MPI_Wtime() - start, time;
+    com.allreduce(loc_time, time, Parallel::max);
+    return time;
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    std::size_t max_size = (nargs > 1 ? std::stoul(argv[1]) : std::size_t(64) << 20);
+    double interval      = (nargs > 2 ? std::stod(argv[2]) : 1.E-4);
+    int core             = (nargs > 3 ? std::stoi(argv[3]) : -1);
+
+    if (com.rank == 0) std::cout << "bytes,progress_thread,comm_time(s),total_time(s),overlap(%)" << std::endl;
+    for (std::size_t size = 1 << 16; size <= max_size; size *= 4) {
+        for (bool with_thread : {false, true}) {
+            if (with_thread) context.startProgressThread(interval, core);
+            double comm_time  = exchange(com, size, 0.);
+            double total_time = exchange(com, size, comm_time);
+            context.stopProgressThread();
+            // Without overlap, total = 2 * comm_time ; with a full overlap, total = comm_time
+            double overlap = std::max(0., std::min(1., 2. - total_time / comm_time));
+            if (com.rank == 0)
+                std::cout << size << "," << with_thread << "," << comm_time << "," << total_time << ","
+                          << 100. * overlap << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmark of the distributed task pool against the static block distribution of an imbalanced
+// workload : the cost of the tasks of a process grows with its rank ( as leaves of a kd-tree with
+// very different numbers of degrees of freedom ).
+//
+// Usage : bench_task_pool [nb_tasks_per_process] [task_cost_in_microseconds] [nb_repetitions]
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/task_pool.hpp"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mpi.h>
+#include <string>
+
+namespace {
+struct Task {
+    double duration; // In seconds
+};
+// Busy wait, as a computation
+void execute(const Task &task) {
+    double start = MPI_Wtime();
+    while (MPI_Wtime() - start < task.duration) {
+    }
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+
+    int nb_tasks       = (nargs > 1 ? std::stoi(argv[1]) : 1000);
+    double cost        = (nargs > 2 ? std::stod(argv[2]) : 50.) * 1.E-6;
+    int nb_repetitions = (nargs > 3 ? std::stoi(argv[3]) : 3);
+
+    // The tasks of the rank r cost ( r + 1 )^2 times the base cost
+    const double duration = cost * (com.rank + 1) * (com.rank + 1);
+    double busy           = 0.;
+    Parallel::TaskPool<Task> pool(com, [&](const Task &task, Parallel::TaskPool<Task> &) {
+        execute(task);
+        busy += task.duration;
+    });
+    std::vector<std::pair<std::string, std::function<void()>>> strategies{
+        {"static",
+         [&]() {
+             for (int i = 0; i < nb_tasks; ++i) {
+                 execute(Task{duration});
+                 busy += duration;
+             }
+         }},
+        {"task_pool", [&]() {
+             for (int i = 0; i < nb_tasks; ++i) pool.push(Task{duration});
+             pool.run();
+         }}};
+    if (com.rank == 0) {
+        std::cout << "# Imbalanced workload on " << com.size << " processes, " << nb_tasks
+                  << " tasks per process" << std::endl;
+        std::cout << "strategy,time(s),efficiency" << std::endl;
+    }
+    for (const auto &strategy : strategies) {
+        double time = 0., total_busy = 0.;
+        for (int rep = 0; rep < nb_repetitions; ++rep) {
+            busy = 0.;
+            com.barrier();
+            double start = MPI_Wtime();
+            strategy.second();
+            com.barrier();
+            double loc_time = MPI_Wtime() - start, rep_time, rep_busy;
+            com.allreduce(loc_time, rep_time, Parallel::max);
+            com.allreduce(busy, rep_busy, Parallel::sum);
+            time += rep_time;
+            total_busy += rep_busy;
+        }
+        // Efficiency : part of the time the processes spent in the tasks
+        if (com.rank == 0)
+            std::cout << strategy.first << "," << std::scientific << std::setprecision(4) << time / nb_repetitions
+                      << "," << std::fixed << std::setprecision(3) << total_busy / (time * com.size) << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
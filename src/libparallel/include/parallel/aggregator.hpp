@@ -0,0 +1,192 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Aggregation of small point to point messages
+#ifndef _PARALLEL_AGGREGATOR_HPP_
+#define _PARALLEL_AGGREGATOR_HPP_
+#include "parallel/communicator"
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Channel aggregating the small messages sent to each process.
+ *
+ *             The items sent to a process are buffered and sent in one message when the buffer is
+ *             full, when the oldest buffered item is older than the maximal delay ( checked by
+ *             poll ) or when the buffers are flushed. The received items are given one by one to
+ *             the handler, which can send new items. The channel uses its own duplicate of the
+ *             communicator, so its messages never match the messages of the application.
+ *
+ *             finish is the end of a communication phase : it returns when all the items sent by
+ *             all the processes ( including the items sent by the handlers ) have been handled.
+ *
+ * @code
+ *             Parallel::Aggregator<Edge> channel(com, [&](int source, const Edge& e) { visit(e); });
+ *             for (const auto& e : edges) channel.send(e, owner(e));
+ *             channel.finish();
+ * @endcode
+ *
+ * @tparam     K     Type of the items ( trivially copyable )
+ */
+template <typename K>
+class Aggregator {
+  public:
+    using Handler = std::function<void(int source, const K &item)>;
+    static const std::size_t default_batch_size = 1024;
+    static constexpr double default_max_delay   = 1.E-3;
+
+    /**
+     * @brief      Create the channel ( collective call )
+     *
+     * @param[in]  com         The processes exchanging items
+     * @param[in]  handler     Function called for each received item
+     * @param[in]  batch_size  Number of items sent in one message
+     * @param[in]  max_delay   Maximal time ( in seconds ) an item is buffered before poll sends it
+     */
+    Aggregator(const Communicator &com, Handler handler, std::size_t batch_size = default_batch_size,
+               double max_delay = default_max_delay)
+        : m_com(com), m_handler(std::move(handler)), m_batch_size(batch_size), m_max_delay(max_delay),
+          m_buffers(com.size), m_oldest(com.size), m_sent(com.size, 0), m_received(com.size, 0) {
+        assert(batch_size > 0);
+        for (auto &buffer : m_buffers) buffer.reserve(m_batch_size);
+    }
+    Aggregator(const Aggregator &) = delete;
+    Aggregator &operator=(const Aggregator &) = delete;
+    /**
+     * @brief      Wait the end of the pending sends ( the buffered items must have been flushed )
+     */
+    ~Aggregator() {
+        for (auto &batch : m_in_flight) batch.request.wait();
+    }
+
+    /**
+     * @brief      Buffer an item for the process dest ( the buffer is sent if it is full )
+     */
+    void send(const K &item, int dest) {
+        assert((dest >= 0) && (dest < m_com.size));
+        std::vector<K> &buffer = m_buffers[dest];
+        if (buffer.empty()) m_oldest[dest] = clock::now();
+        buffer.push_back(item);
+        ++m_nb_items;
+        if (buffer.size() >= m_batch_size) flush(dest);
+    }
+    /**
+     * @brief      Send the items buffered for the process dest
+     */
+    void flush(int dest) {
+        std::vector<K> &buffer = m_buffers[dest];
+        if (buffer.empty()) return;
+        m_in_flight.emplace_back();
+        Batch &batch = m_in_flight.back();
+        batch.items.swap(buffer);
+        buffer.reserve(m_batch_size);
+        batch.request = m_com.isend(batch.items.size(), batch.items.data(), dest, tag);
+        ++m_sent[dest];
+        ++m_nb_messages;
+    }
+    /**
+     * @brief      Send the items buffered for all the processes
+     */
+    void flush() {
+        for (int dest = 0; dest < m_com.size; ++dest) flush(dest);
+    }
+    /**
+     * @brief      Send the buffers older than the maximal delay, and handle the received items
+     *
+     * @return     The number of handled items
+     */
+    std::size_t poll() {
+        clock::time_point now = clock::now();
+        for (int dest = 0; dest < m_com.size; ++dest)
+            if (!m_buffers[dest].empty() &&
+                (std::chrono::duration<double>(now - m_oldest[dest]).count() >= m_max_delay))
+                flush(dest);
+        complete_sends();
+        std::size_t nb_handled = 0;
+        Status status;
+        while (m_com.iprobe(status, any_source, tag)) nb_handled += receive(status);
+        return nb_handled;
+    }
+    /**
+     * @brief      Flush the buffers and handle the items until all the items of all the processes
+     *             are handled ( collective call )
+     */
+    void finish() {
+        std::vector<std::size_t> expected(m_com.size);
+        for (;;) {
+            flush();
+            m_com.alltoall(m_sent.data(), expected.data());
+            std::size_t nb_sent = m_nb_messages;
+            for (int source = 0; source < m_com.size; ++source) {
+                while (m_received[source] < expected[source]) {
+                    Status status = m_com.probe(source, tag);
+                    receive(status);
+                }
+            }
+            // The handlers may have sent new items during this round
+            std::size_t pending = m_nb_messages - nb_sent, total;
+            for (const auto &buffer : m_buffers) pending += buffer.size();
+            m_com.allreduce(pending, total, Parallel::sum);
+            if (total == 0) break;
+        }
+        for (auto &batch : m_in_flight) batch.request.wait();
+        m_in_flight.clear();
+    }
+
+    /**
+     * @brief      Number of items given to send
+     */
+    std::size_t nbItemsSent() const { return m_nb_items; }
+    /**
+     * @brief      Number of messages sent for these items
+     */
+    std::size_t nbMessagesSent() const { return m_nb_messages; }
+
+  private:
+    using clock          = std::chrono::steady_clock;
+    static const int tag = 1;
+    struct Batch {
+        std::vector<K> items;
+        Request request;
+    };
+
+    void complete_sends() {
+        while (!m_in_flight.empty() && m_in_flight.front().request.test()) m_in_flight.pop_front();
+    }
+    // Receive the message described by status and handle its items
+    std::size_t receive(const Status &status) {
+        int source = status.source();
+        std::vector<K> items(std::size_t(status.count<char>()) / sizeof(K));
+        m_com.recv(items.size(), items.data(), source, tag);
+        ++m_received[source];
+        for (const K &item : items) m_handler(source, item);
+        return items.size();
+    }
+
+    Communicator m_com;
+    Handler m_handler;
+    std::size_t m_batch_size;
+    double m_max_delay;
+    std::vector<std::vector<K>> m_buffers;
+    std::vector<clock::time_point> m_oldest;
+    std::vector<std::size_t> m_sent, m_received; // Messages sent to and received from each process
+    std::list<Batch> m_in_flight;
+    std::size_t m_nb_items = 0, m_nb_messages = 0;
+};
+}
+#endif
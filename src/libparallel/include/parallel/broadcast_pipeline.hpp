@@ -0,0 +1,118 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Broadcasts of the next steps of a loop overlapped with the computation of the current step
+#ifndef _PARALLEL_BROADCAST_PIPELINE_HPP_
+#define _PARALLEL_BROADCAST_PIPELINE_HPP_
+#include "parallel/communicator"
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Loop whose steps compute with buffers broadcast at each step ( as the SUMMA matrix
+ *             product, broadcasting a block of A in the rows and a block of B in the columns ).
+ *
+ *             Each channel broadcasts one buffer per step on its communicator. The broadcasts of
+ *             the next depth-1 steps are started before the computation of the current step, in
+ *             rotating buffers ( depth copies of the buffer of each channel ), so the messages are
+ *             transferred during the computation. Without progress thread ( see
+ *             Context::startProgressThread ), some MPI libraries only progress the large messages
+ *             inside their calls.
+ *
+ *             Buffer is a contiguous container ( data(), size() and value_type ) : std::vector,
+ *             or any class deriving from it.
+ *
+ * @code
+ *             Parallel::BroadcastPipeline<BlockMatrix<double>> pipeline;
+ *             pipeline.add(rowCom, A, [](int k) { return k; }, [&](int) -> const BlockMatrix<double> & { return A; });
+ *             pipeline.add(colCom, B, [](int k) { return k; }, [&](int) -> const BlockMatrix<double> & { return B; });
+ *             pipeline.run(p, [&](int k, const std::vector<const BlockMatrix<double> *> &blocks) {
+ *                 prodMatrixMatrixBloc(*blocks[0], *blocks[1], C);
+ *             });
+ * @endcode
+ */
+template <typename Buffer>
+class BroadcastPipeline {
+  public:
+    using Root    = std::function<int(int step)>;
+    using Source  = std::function<const Buffer &(int step)>;
+    using Compute = std::function<void(int step, const std::vector<const Buffer *> &buffers)>;
+
+    /**
+     * @brief      Pipeline broadcasting depth-1 steps ahead ( 2 : double buffering )
+     */
+    explicit BroadcastPipeline(int depth = 2) : m_depth(depth) {
+        if (depth < 2) throw std::invalid_argument("The depth of the pipeline must be at least 2");
+    }
+    BroadcastPipeline(const BroadcastPipeline &) = delete;
+    BroadcastPipeline &operator=(const BroadcastPipeline &) = delete;
+
+    int depth() const { return m_depth; }
+    /**
+     * @brief      Add a channel broadcasting on com, at each step, the buffer given by source on the
+     *             process root(step) ( only called on this process ).
+     *
+     * @param      com    The communicator of the broadcasts ( living as long as the pipeline )
+     * @param      shape  A buffer of the size of the broadcast buffers, copied in the rotating buffers
+     */
+    void add(const Communicator &com, const Buffer &shape, Root root, Source source) {
+        m_channels.push_back(Channel{&com, std::move(root), std::move(source), std::vector<Buffer>(m_depth, shape)});
+    }
+    /**
+     * @brief      Run nbSteps steps : compute receives the step and the buffers of the channels at
+     *             this step ( in the order of the channels ). Collective call on the communicators.
+     */
+    void run(int nbSteps, const Compute &compute) {
+        std::vector<std::vector<Request>> requests(m_depth);
+        std::vector<const Buffer *> buffers(m_channels.size());
+        for (int step = 0; (step < m_depth - 1) && (step < nbSteps); ++step) start(step, requests[step % m_depth]);
+        for (int step = 0; step < nbSteps; ++step) {
+            // The slot of the step depth-1 ahead was used by the previous step, which is computed
+            if (step + m_depth - 1 < nbSteps)
+                start(step + m_depth - 1, requests[(step + m_depth - 1) % m_depth]);
+            for (auto &req : requests[step % m_depth]) req.wait();
+            for (std::size_t c = 0; c < m_channels.size(); ++c) buffers[c] = &m_channels[c].slots[step % m_depth];
+            compute(step, buffers);
+        }
+    }
+
+  private:
+    struct Channel {
+        const Communicator *com;
+        Root root;
+        Source source;
+        std::vector<Buffer> slots;
+    };
+    void start(int step, std::vector<Request> &requests) {
+        requests.clear();
+        for (auto &channel : m_channels) {
+            const int root = channel.root(step);
+            Buffer &slot   = channel.slots[step % m_depth];
+            const typename Buffer::value_type *snd = nullptr;
+            if (channel.com->rank == root) {
+                const Buffer &data = channel.source(step);
+                if (data.size() != slot.size())
+                    throw std::invalid_argument("The size of the buffer differs from the size of the channel");
+                snd = data.data();
+            }
+            requests.push_back(channel.com->ibcast(slot.size(), snd, slot.data(), root));
+        }
+    }
+
+    int m_depth;
+    std::vector<Channel> m_channels;
+};
+}
+#endif
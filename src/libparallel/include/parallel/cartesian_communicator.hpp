@@ -0,0 +1,219 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ *    \file    cartesian_communicator.hpp
+ *    \brief   Declaration file for the communicators with a cartesian
+ *             topology and for the exchange of the ghost layers of
+ *             distributed N-D arrays.
+ */
+#ifndef _PARALLEL_CARTESIAN_COMMUNICATOR_HPP_
+#define _PARALLEL_CARTESIAN_COMMUNICATOR_HPP_
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "parallel/communicator.hpp"
+namespace Parallel {
+/*!   \class CartesianCommunicator
+ *    \brief Communicator whose processes are arranged on a N-D grid,
+ *           periodic or not in each direction.
+ *
+ *    The ordering of the neighbors used by the neighbor collective
+ *    operations is the one of MPI : for each direction d, the neighbor
+ *    in the negative direction then the neighbor in the positive
+ *    direction. A missing neighbor ( on the border of a non periodic
+ *    direction ) is the constant proc_null and the data exchanged with
+ *    it are ignored.
+ */
+class CartesianCommunicator : public Communicator {
+ public:
+  /*!
+   *   \brief Build a cartesian grid with the processes of com
+   *
+   *   \param com     The communicator containing the processes of the grid
+   *   \param dims    Number of processes in each direction. A null value
+   *                  lets the library choose a balanced number of processes
+   *                  for this direction. The product of the dimensions must
+   *                  be equal to the size of com.
+   *   \param periods Periodicity of each direction
+   *   \param reorder If true, the processes can be renumbered to fit the
+   *                  physical topology of the machine.
+   */
+  CartesianCommunicator(const Communicator& com, const std::vector<int>& dims,
+                        const std::vector<bool>& periods, bool reorder = true);
+  /*!
+   *  \brief Convert a cartesian communicator coming from external library
+   *         in Parallel communicator ( the communicator is duplicated )
+   */
+  explicit CartesianCommunicator(const Ext_Communicator& com);
+  /*!
+   *   \brief Duplicate a cartesian communicator ( with its topology )
+   */
+  CartesianCommunicator(const CartesianCommunicator& com);
+
+  CartesianCommunicator(CartesianCommunicator&& com) = delete;
+  CartesianCommunicator& operator=(const CartesianCommunicator& com) = delete;
+  CartesianCommunicator& operator=(CartesianCommunicator&& com) = delete;
+
+  /*!
+   *   \brief Return a balanced distribution of nbProcs processes in
+   *          dims.size() directions. The non null values of dims are kept.
+   */
+  static std::vector<int> balancedDimensions(int nbProcs,
+                                             const std::vector<int>& dims);
+
+  /*!  \brief Number of directions of the grid */
+  int ndims() const { return int(m_dims.size()); }
+  /*!  \brief Number of processes in each direction */
+  const std::vector<int>& dimensions() const { return m_dims; }
+  /*!  \brief Periodicity of each direction */
+  const std::vector<bool>& periods() const { return m_periods; }
+  /*!  \brief Coordinates of the current process in the grid */
+  const std::vector<int>& coordinates() const { return m_coords; }
+  /*!  \brief Coordinates of the process of rank rk in the grid */
+  std::vector<int> coordinates(int rk) const;
+  /*!
+   *   \brief Rank of the process at the coordinates coords. The periodic
+   *          directions are wrapped, and proc_null is returned outside
+   *          of a non periodic direction.
+   */
+  int rankOf(const std::vector<int>& coords) const;
+  /*!
+   *   \brief Ranks of the source and destination processes for a shift
+   *          of displacement in the direction
+   *
+   *   \return The pair ( source, destination ), proc_null if the process
+   *           doesn't exist.
+   */
+  std::pair<int, int> shift(int direction, int displacement = 1) const;
+  /*!
+   *   \brief Rank of the neighbor at offset from the current process
+   *          ( offset may have several non null components to reach
+   *          the edge and corner neighbors )
+   */
+  int neighbor(const std::vector<int>& offset) const;
+  // ===============================================================================================
+  //                               Neighbor collective operations
+  /*!
+   *    \brief Send nbObjs objects to each neighbor and receive nbObjs
+   *           objects from each neighbor
+   *
+   *    \param nbObjs Number of objects exchanged with each neighbor
+   *    \param b_snd  Buffer of 2*ndims()*nbObjs objects to send
+   *    \param b_rcv  Buffer of 2*ndims()*nbObjs objects received
+   */
+  template <typename K>
+  void neighbor_alltoall(std::size_t nbObjs, const K* b_snd, K* b_rcv) const;
+  /*!
+   *    \brief Exchange a variable number of objects with each neighbor
+   *
+   *    \param snd_counts Number of objects sent to each neighbor
+   *    \param b_snd      Objects to send, stored neighbor after neighbor
+   *    \param rcv_counts Number of objects received from each neighbor
+   *    \param b_rcv      Objects received, stored neighbor after neighbor
+   */
+  template <typename K>
+  void neighbor_alltoallv(const std::vector<std::size_t>& snd_counts,
+                          const K* b_snd,
+                          const std::vector<std::size_t>& rcv_counts,
+                          K* b_rcv) const;
+  /*!
+   *    \brief Send the same nbObjs objects to each neighbor and receive
+   *           nbObjs objects from each neighbor
+   *
+   *    \param b_rcv Buffer of 2*ndims()*nbObjs objects received
+   */
+  template <typename K>
+  void neighbor_allgather(std::size_t nbObjs, const K* b_snd, K* b_rcv) const;
+
+ private:
+  CartesianCommunicator(Ext_Communicator com, bool free_input);
+  static Ext_Communicator create(const Communicator& com,
+                                 const std::vector<int>& dims,
+                                 const std::vector<bool>& periods,
+                                 bool reorder);
+
+  std::vector<int> m_dims;
+  std::vector<bool> m_periods;
+  std::vector<int> m_coords;
+};
+// ===================================================================================================
+/*!
+ *   \brief Neighbors with which the ghost layers are exchanged
+ */
+enum class HaloStencil {
+  faces, /*!< Only the neighbors sharing a face ( 2*N neighbors ) */
+  full   /*!< The neighbors sharing a face, an edge or a corner ( 3^N-1 neighbors ) */
+};
+/*!   \class HaloExchange
+ *    \brief Exchange of the ghost layers of a local N-D array distributed
+ *           on a cartesian communicator
+ *
+ *    The local array contains ghost layers of width ghosts[d] on both
+ *    sides of the direction d. The layers are sent and received directly
+ *    from the array with derived datatypes ( no copy in intermediate
+ *    buffers ), and the datatypes are built once at construction.
+ *
+ *    Example for a 2D array with one ghost layer and corners :
+ *    \code
+ *    Parallel::CartesianCommunicator grid(com, {0, 0}, {true, true});
+ *    std::vector<double> u((nx + 2) * (ny + 2));
+ *    Parallel::HaloExchange<double> halo(grid, {nx + 2, ny + 2}, {1, 1});
+ *    halo.start(u.data());
+ *    // ... compute on the interior not depending on the ghost layers
+ *    halo.finish();
+ *    \endcode
+ */
+template <typename K>
+class HaloExchange {
+ public:
+  /*!
+   *   \brief Prepare the exchanges
+   *
+   *   \param com        The cartesian communicator ( duplicated for the exchanges )
+   *   \param dimensions Local dimensions of the array, ghost layers included
+   *   \param ghosts     Width of the ghost layers in each direction
+   *   \param stencil    Exchange the faces only, or the faces, edges and corners
+   *   \param strides    Strides ( in number of objects ) of each direction. By
+   *                     default, the array is contiguous and row-major ( the last
+   *                     direction is contiguous in memory ).
+   */
+  HaloExchange(const CartesianCommunicator& com,
+               const std::vector<std::size_t>& dimensions,
+               const std::vector<std::size_t>& ghosts,
+               HaloStencil stencil = HaloStencil::full,
+               const std::vector<std::size_t>& strides = {});
+  HaloExchange(const HaloExchange&) = delete;
+  HaloExchange& operator=(const HaloExchange&) = delete;
+  ~HaloExchange();
+
+  /*!  \brief Start the non blocking exchanges of the ghost layers of data */
+  void start(K* data);
+  /*!  \brief Wait the end of the exchanges started by start */
+  void finish();
+  /*!  \brief Blocking exchange of the ghost layers of data */
+  void exchange(K* data) {
+    start(data);
+    finish();
+  }
+  /*!  \brief Number of neighbors with which data are exchanged */
+  std::size_t nbNeighbors() const { return m_neighbors.size(); }
+
+ private:
+  struct Neighbor;
+  CartesianCommunicator m_com;
+  std::vector<Neighbor> m_neighbors;
+  std::vector<Request> m_requests;
+};
+}
+#endif
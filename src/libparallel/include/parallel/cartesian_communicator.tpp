@@ -0,0 +1,180 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Templates for the CartesianCommunicator and HaloExchange classes
+#include "parallel/communicator"
+#if !defined(USE_MPI)
+#error "The cartesian communicators are only implemented with MPI"
+#endif
+#include <numeric>
+
+namespace Parallel {
+template <typename K>
+void CartesianCommunicator::neighbor_alltoall(std::size_t nbObjs, const K *b_snd, K *b_rcv) const {
+    MPI_Neighbor_alltoall(b_snd, buffer_count<K>(nbObjs), buffer_type<K>(), b_rcv, buffer_count<K>(nbObjs),
+                          buffer_type<K>(), externalCommunicator());
+}
+// .................................................................................................
+template <typename K>
+void CartesianCommunicator::neighbor_alltoallv(const std::vector<std::size_t> &snd_counts, const K *b_snd,
+                                               const std::vector<std::size_t> &rcv_counts, K *b_rcv) const {
+    assert(snd_counts.size() == 2 * m_dims.size());
+    assert(rcv_counts.size() == 2 * m_dims.size());
+    std::vector<VCount> scounts, rcounts;
+    std::vector<VDispl> sdispls, rdispls;
+    counts_and_displacements<K>(snd_counts, scounts, sdispls);
+    counts_and_displacements<K>(rcv_counts, rcounts, rdispls);
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    MPI_Neighbor_alltoallv_c(b_snd, scounts.data(), sdispls.data(), buffer_type<K>(), b_rcv, rcounts.data(),
+                             rdispls.data(), buffer_type<K>(), externalCommunicator());
+#else
+    MPI_Neighbor_alltoallv(b_snd, scounts.data(), sdispls.data(), buffer_type<K>(), b_rcv, rcounts.data(),
+                           rdispls.data(), buffer_type<K>(), externalCommunicator());
+#endif
+}
+// .................................................................................................
+template <typename K>
+void CartesianCommunicator::neighbor_allgather(std::size_t nbObjs, const K *b_snd, K *b_rcv) const {
+    MPI_Neighbor_allgather(b_snd, buffer_count<K>(nbObjs), buffer_type<K>(), b_rcv, buffer_count<K>(nbObjs),
+                           buffer_type<K>(), externalCommunicator());
+}
+// #################################################################################################
+// A neighbor of the halo exchange : the region of the interior sent to it and the ghost region
+// received from it, both described by a derived datatype and an offset in the array.
+template <typename K>
+struct HaloExchange<K>::Neighbor {
+    int rank;
+    int send_tag, recv_tag;
+    std::size_t send_offset, recv_offset;
+    MPI_Datatype type; // Same shape for the sent and received regions
+};
+// .................................................................................................
+namespace {
+// Datatype of the box [start, start+count) of a strided array of K ( the offset of start must be
+// added to the address of the array ). The directions are nested from the smallest stride.
+template <typename K>
+MPI_Datatype box_type(const std::vector<std::size_t> &counts, const std::vector<std::size_t> &strides) {
+    std::vector<std::size_t> order(counts.size());
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::sort(order.begin(), order.end(), [&](std::size_t i, std::size_t j) { return strides[i] < strides[j]; });
+    MPI_Datatype tp;
+    MPI_Type_contiguous(buffer_count<K>(1), buffer_type<K>(), &tp);
+    for (std::size_t d : order) {
+        MPI_Datatype nested;
+        MPI_Type_create_hvector(int(counts[d]), 1, MPI_Aint(strides[d] * sizeof(K)), tp, &nested);
+        MPI_Type_free(&tp);
+        tp = nested;
+    }
+    MPI_Type_commit(&tp);
+    return tp;
+}
+}
+// .................................................................................................
+template <typename K>
+HaloExchange<K>::HaloExchange(const CartesianCommunicator &com, const std::vector<std::size_t> &dimensions,
+                              const std::vector<std::size_t> &ghosts, HaloStencil stencil,
+                              const std::vector<std::size_t> &strides)
+    : m_com(com) {
+    const std::size_t ndims = dimensions.size();
+    assert(int(ndims) == com.ndims());
+    assert(ghosts.size() == ndims);
+    std::vector<std::size_t> stride(strides);
+    if (stride.empty()) { // Row-major contiguous array
+        stride.resize(ndims);
+        std::size_t s = 1;
+        for (std::size_t d = ndims; d > 0; --d) {
+            stride[d - 1] = s;
+            s *= dimensions[d - 1];
+        }
+    }
+    assert(stride.size() == ndims);
+    for (std::size_t d = 0; d < ndims; ++d) assert(dimensions[d] >= 3 * ghosts[d]);
+
+    // Browse the 3^N offsets ( -1, 0 or 1 in each direction ), the code of an offset is its index
+    // in base 3 and is used as tag, so several exchanges with the same process can't be mixed.
+    std::size_t nb_offsets = 1;
+    for (std::size_t d = 0; d < ndims; ++d) nb_offsets *= 3;
+    std::vector<int> offset(ndims);
+    std::vector<std::size_t> counts(ndims);
+    for (std::size_t code = 0; code < nb_offsets; ++code) {
+        std::size_t c    = code;
+        int nb_non_zeros = 0;
+        bool empty       = false;
+        for (std::size_t d = 0; d < ndims; ++d, c /= 3) {
+            offset[d] = int(c % 3) - 1;
+            if (offset[d] != 0) {
+                ++nb_non_zeros;
+                empty = empty || (ghosts[d] == 0);
+            }
+        }
+        if ((nb_non_zeros == 0) || empty) continue;
+        if ((stencil == HaloStencil::faces) && (nb_non_zeros > 1)) continue;
+        Neighbor ngb;
+        ngb.rank = com.neighbor(offset);
+        if (ngb.rank == proc_null) continue;
+        ngb.send_tag    = int(code);
+        ngb.recv_tag    = int(nb_offsets - 1 - code); // Code of the opposite offset
+        ngb.send_offset = 0;
+        ngb.recv_offset = 0;
+        for (std::size_t d = 0; d < ndims; ++d) {
+            const std::size_t n = dimensions[d], g = ghosts[d];
+            std::size_t snd_start, rcv_start;
+            if (offset[d] < 0) {
+                snd_start = g;
+                rcv_start = 0;
+                counts[d] = g;
+            } else if (offset[d] > 0) {
+                snd_start = n - 2 * g;
+                rcv_start = n - g;
+                counts[d] = g;
+            } else {
+                snd_start = rcv_start = g;
+                counts[d]             = n - 2 * g;
+            }
+            ngb.send_offset += snd_start * stride[d];
+            ngb.recv_offset += rcv_start * stride[d];
+        }
+        ngb.type = box_type<K>(counts, stride);
+        m_neighbors.push_back(ngb);
+    }
+    m_requests.reserve(2 * m_neighbors.size());
+}
+// .................................................................................................
+template <typename K>
+HaloExchange<K>::~HaloExchange() {
+    finish();
+    for (auto &ngb : m_neighbors) MPI_Type_free(&ngb.type);
+}
+// .................................................................................................
+template <typename K>
+void HaloExchange<K>::start(K *data) {
+    assert(m_requests.empty());
+    const MPI_Comm &com = m_com.externalCommunicator();
+    for (const auto &ngb : m_neighbors) {
+        MPI_Request req;
+        MPI_Irecv(data + ngb.recv_offset, 1, ngb.type, ngb.rank, ngb.recv_tag, com, &req);
+        m_requests.emplace_back(req);
+    }
+    for (const auto &ngb : m_neighbors) {
+        MPI_Request req;
+        MPI_Isend(data + ngb.send_offset, 1, ngb.type, ngb.rank, ngb.send_tag, com, &req);
+        m_requests.emplace_back(req);
+    }
+}
+// .................................................................................................
+template <typename K>
+void HaloExchange<K>::finish() {
+    for (auto &req : m_requests) req.wait();
+    m_requests.clear();
+}
+}
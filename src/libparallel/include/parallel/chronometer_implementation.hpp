@@ -1,12 +1,56 @@
 #ifndef _PARALLEL_CHRONOMETER_IMPLEMENTATION_HPP_
 #define _PARALLEL_CHRONOMETER_IMPLEMENTATION_HPP_
 #include "core/std_cpp_chronometer.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 namespace Parallel {
     struct Communicator::Chronometer::Implementation {
+        // Times of the communications of one kind
+        struct Record {
+            unsigned long nb_calls   = 0UL;
+            double        total_time = 0.;
+        };
+        // Measure of one communication : the time is taken locally and added to the records under
+        // a lock when the measure stops, so the threads of a process can communicate concurrently.
+        class Measure {
+        public:
+            Measure( Communicator::Chronometer *pt_chrono, const char *label )
+                : m_pt_impl( ( pt_chrono != nullptr ) && pt_chrono->m_pt_impl->is_activated ? pt_chrono->m_pt_impl.get( )
+                                                                                           : nullptr ),
+                  m_label( label ) {
+                if ( m_pt_impl != nullptr ) m_start = std::chrono::steady_clock::now( );
+            }
+            Measure( const Measure & ) = delete;
+            Measure &operator=( const Measure & ) = delete;
+            ~Measure( ) { stop( ); }
+            void stop( ) {
+                if ( m_pt_impl == nullptr ) return;
+                m_pt_impl->record( m_label, std::chrono::duration<double>( std::chrono::steady_clock::now( ) - m_start ).count( ) );
+                m_pt_impl = nullptr;
+            }
+
+        private:
+            Implementation *                      m_pt_impl;
+            const char *                          m_label;
+            std::chrono::steady_clock::time_point m_start;
+        };
+        void record( const std::string &label, double time ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            Record &rec = m_records[label];
+            rec.nb_calls += 1;
+            rec.total_time += time;
+        }
+
         std::map<std::string, std::unique_ptr<Core::StdChronometer>> m_chronos;
         mutable Core::StdChronometer *pt_current_chronometer;
-        bool                          is_activated;
+        std::atomic<bool>             is_activated;
+        std::mutex                    m_mutex;
+        std::map<std::string, Record> m_records;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,480 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Collective operations built on the point to point messages, with a choice of algorithms
+#ifndef _PARALLEL_COLLECTIVE_ALGORITHMS_HPP_
+#define _PARALLEL_COLLECTIVE_ALGORITHMS_HPP_
+#include "parallel/communicator"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Algorithms of the collective operations
+ */
+enum class CollectiveAlgorithm {
+    automatic,          /*!< Chosen by the size of the message ( see CollectiveAlgorithms::select ) */
+    library,            /*!< The operation of the Communicator ( the MPI library ) */
+    binomial,           /*!< Broadcast along a binomial tree : log(p) steps of the whole message */
+    chain,              /*!< Broadcast of segments along a chain : the segments are pipelined */
+    ring,               /*!< Reduce-scatter then allgather ( allreduce ) or allgather along a ring */
+    recursive_doubling, /*!< Exchanges with the process at distance 1, 2, 4, ... of the whole data */
+    recursive_halving,  /*!< Reduce-scatter by recursive halving, then allgather by recursive doubling */
+    bruck               /*!< Allgather in log(p) steps for any number of processes */
+};
+/**
+ * @brief      Collective operations implemented with the point to point messages of a private
+ *             duplicate of a communicator, so they run on every implementation of the library.
+ *
+ *             Each operation takes the algorithm to use, or chooses it by the size of the message
+ *             and the number of processes. The choice comes from a table filled by autotune (
+ *             which measures all the algorithms on the current machine ) or by setAlgorithm, and
+ *             from defaults suited to most networks otherwise. The same choices must be done on
+ *             all the processes.
+ *
+ *             The ring and the recursive halving algorithms combine the values in an order
+ *             depending on the process, so they need a commutative operation ; the other ones
+ *             keep the order of the ranks.
+ *
+ * @code
+ *             Parallel::CollectiveAlgorithms coll(com);
+ *             coll.autotune();
+ *             coll.allreduce(n, x.data(), y.data(), Parallel::sum);
+ *             coll.bcast(n, x.data(), 0, Parallel::CollectiveAlgorithm::chain);
+ * @endcode
+ */
+class CollectiveAlgorithms {
+  public:
+    enum class Collective { bcast, allreduce, allgather };
+
+    explicit CollectiveAlgorithms(const Communicator &com) : m_com(com) {}
+    CollectiveAlgorithms(const CollectiveAlgorithms &) = delete;
+    CollectiveAlgorithms &operator=(const CollectiveAlgorithms &) = delete;
+
+    const Communicator &communicator() const { return m_com; }
+    /**
+     * @brief      Size in bytes of the segments of the chain broadcast
+     */
+    void setSegmentSize(std::size_t bytes) { m_segment_size = std::max(bytes, std::size_t(1)); }
+    /**
+     * @brief      Use the algorithm for the messages of at least bytes bytes ( until the next
+     *             greater size given for this collective operation )
+     */
+    void setAlgorithm(Collective coll, std::size_t bytes, CollectiveAlgorithm algorithm) {
+        auto &table = m_table[int(coll)];
+        auto it     = std::find_if(table.begin(), table.end(), [bytes](const Entry &e) { return e.first >= bytes; });
+        if ((it != table.end()) && (it->first == bytes))
+            it->second = algorithm;
+        else
+            table.insert(it, Entry(bytes, algorithm));
+    }
+    /**
+     * @brief      Algorithm used for a message of bytes bytes ( by process for allgather ) : the
+     *             entry of the table of the greatest size less or equal to bytes, the default
+     *             algorithm below the first entry
+     */
+    CollectiveAlgorithm select(Collective coll, std::size_t bytes, bool commutative = true) const {
+        CollectiveAlgorithm algorithm = default_algorithm(coll, bytes);
+        const auto &table             = m_table[int(coll)];
+        for (const auto &e : table)
+            if (e.first <= bytes) algorithm = e.second;
+        if (!commutative && ((algorithm == CollectiveAlgorithm::ring) ||
+                             (algorithm == CollectiveAlgorithm::recursive_halving)))
+            algorithm = CollectiveAlgorithm::recursive_doubling;
+        return algorithm;
+    }
+    /**
+     * @brief      Measure all the algorithms of each collective operation on messages from 8 to
+     *             max_bytes bytes, and keep the fastest one for each size ( collective call ). The
+     *             fastest one on 8 bytes is also used by the smaller messages.
+     */
+    void autotune(std::size_t max_bytes = std::size_t(1) << 22, int nb_repetitions = 5) {
+        const std::array<std::vector<CollectiveAlgorithm>, 3> candidates{
+            {{CollectiveAlgorithm::library, CollectiveAlgorithm::binomial, CollectiveAlgorithm::chain},
+             {CollectiveAlgorithm::library, CollectiveAlgorithm::recursive_doubling,
+              CollectiveAlgorithm::recursive_halving, CollectiveAlgorithm::ring},
+             {CollectiveAlgorithm::library, CollectiveAlgorithm::recursive_doubling, CollectiveAlgorithm::bruck,
+              CollectiveAlgorithm::ring}}};
+        for (int c = 0; c < 3; ++c) {
+            std::vector<Entry> table;
+            for (std::size_t bytes = 8; bytes <= max_bytes; bytes *= 4) {
+                const std::size_t n = bytes / sizeof(double);
+                std::vector<double> snd(n, 1.), rcv(c == 2 ? n * m_com.size : n);
+                CollectiveAlgorithm best = CollectiveAlgorithm::library;
+                double best_time         = std::numeric_limits<double>::max();
+                for (CollectiveAlgorithm algorithm : candidates[c]) {
+                    double t = measure(nb_repetitions, [&]() {
+                        if (c == 0)
+                            bcast(n, rcv.data(), 0, algorithm);
+                        else if (c == 1)
+                            allreduce(n, snd.data(), rcv.data(), Parallel::sum, algorithm);
+                        else
+                            allgather(n, snd.data(), rcv.data(), algorithm);
+                    });
+                    if (t < best_time) {
+                        best      = algorithm;
+                        best_time = t;
+                    }
+                }
+                if (table.empty())
+                    table.push_back(Entry(0, best));
+                else if (table.back().second != best)
+                    table.push_back(Entry(bytes, best));
+            }
+            m_table[c] = table;
+        }
+    }
+    // =============================================================================================
+    /**
+     * @brief      Broadcast of the nbItems objects of buffer from the process root
+     */
+    template <typename K>
+    void bcast(std::size_t nbItems, K *buffer, int root = 0,
+               CollectiveAlgorithm algorithm = CollectiveAlgorithm::automatic) const {
+        if (algorithm == CollectiveAlgorithm::automatic) algorithm = select(Collective::bcast, nbItems * sizeof(K));
+        if ((nbItems == 0) || (m_com.size == 1)) return;
+        switch (algorithm) {
+        case CollectiveAlgorithm::library:
+            m_com.bcast(nbItems, buffer, buffer, root);
+            break;
+        case CollectiveAlgorithm::binomial:
+            binomial_bcast(nbItems, buffer, root);
+            break;
+        case CollectiveAlgorithm::chain:
+            chain_bcast(nbItems, buffer, root);
+            break;
+        default:
+            throw std::invalid_argument("Algorithm not available for the broadcast");
+        }
+    }
+    /**
+     * @brief      Reduction of nbItems objects with a predefined operation, the result being on all
+     *             the processes ( snd and rcv may be the same buffer ). The operations other than
+     *             sum, prod, max and min use the operation of the Communicator.
+     */
+    template <typename K>
+    void allreduce(std::size_t nbItems, const K *snd, K *rcv, Operation op,
+                   CollectiveAlgorithm algorithm = CollectiveAlgorithm::automatic) const {
+        if (algorithm == CollectiveAlgorithm::automatic)
+            algorithm = select(Collective::allreduce, nbItems * sizeof(K));
+        if (op == Parallel::sum)
+            allreduce(nbItems, snd, rcv, [](const K &a, const K &b) { return K(a + b); }, true, algorithm);
+        else if (op == Parallel::prod)
+            allreduce(nbItems, snd, rcv, [](const K &a, const K &b) { return K(a * b); }, true, algorithm);
+        else if (op == Parallel::max)
+            allreduce(nbItems, snd, rcv, [](const K &a, const K &b) { return std::max(a, b); }, true, algorithm);
+        else if (op == Parallel::min)
+            allreduce(nbItems, snd, rcv, [](const K &a, const K &b) { return std::min(a, b); }, true, algorithm);
+        else
+            m_com.allreduce(nbItems, snd, rcv, op);
+    }
+    /**
+     * @brief      Reduction of nbItems objects with the associative operation op ( a functor
+     *             K(const K&, const K&) ), the result being on all the processes.
+     */
+    template <typename K, typename Func>
+    void allreduce(std::size_t nbItems, const K *snd, K *rcv, const Func &op, bool commutative,
+                   CollectiveAlgorithm algorithm = CollectiveAlgorithm::automatic) const {
+        if (algorithm == CollectiveAlgorithm::automatic)
+            algorithm = select(Collective::allreduce, nbItems * sizeof(K), commutative);
+        if (!commutative &&
+            ((algorithm == CollectiveAlgorithm::ring) || (algorithm == CollectiveAlgorithm::recursive_halving)))
+            throw std::invalid_argument("This algorithm needs a commutative operation");
+        if (algorithm == CollectiveAlgorithm::library) {
+            m_com.allreduce(nbItems, snd, rcv, op, commutative);
+            return;
+        }
+        if (rcv != snd) std::copy(snd, snd + nbItems, rcv);
+        if ((nbItems == 0) || (m_com.size == 1)) return;
+        switch (algorithm) {
+        case CollectiveAlgorithm::recursive_doubling:
+            recursive_doubling_allreduce(nbItems, rcv, op);
+            break;
+        case CollectiveAlgorithm::recursive_halving:
+            recursive_halving_allreduce(nbItems, rcv, op);
+            break;
+        case CollectiveAlgorithm::ring:
+            ring_allreduce(nbItems, rcv, op);
+            break;
+        default:
+            throw std::invalid_argument("Algorithm not available for the reduction");
+        }
+    }
+    /**
+     * @brief      Each process gives nbItems objects, and receives the objects of all the
+     *             processes by rank order in rcv ( nbItems x size objects )
+     */
+    template <typename K>
+    void allgather(std::size_t nbItems, const K *snd, K *rcv,
+                   CollectiveAlgorithm algorithm = CollectiveAlgorithm::automatic) const {
+        if (algorithm == CollectiveAlgorithm::automatic)
+            algorithm = select(Collective::allgather, nbItems * sizeof(K));
+        if (algorithm == CollectiveAlgorithm::library) {
+            m_com.allgather(nbItems, snd, rcv);
+            return;
+        }
+        const int p = m_com.size;
+        // The recursive doubling needs a power of two processes
+        if ((algorithm == CollectiveAlgorithm::recursive_doubling) && ((p & (p - 1)) != 0))
+            algorithm = CollectiveAlgorithm::bruck;
+        if (nbItems == 0) return;
+        switch (algorithm) {
+        case CollectiveAlgorithm::ring:
+            std::copy(snd, snd + nbItems, rcv + m_com.rank * nbItems);
+            ring_allgather(nbItems, rcv);
+            break;
+        case CollectiveAlgorithm::recursive_doubling:
+            std::copy(snd, snd + nbItems, rcv + m_com.rank * nbItems);
+            recursive_doubling_allgather(nbItems, rcv);
+            break;
+        case CollectiveAlgorithm::bruck:
+            bruck_allgather(nbItems, snd, rcv);
+            break;
+        default:
+            throw std::invalid_argument("Algorithm not available for the allgather");
+        }
+    }
+
+  private:
+    using Entry = std::pair<std::size_t, CollectiveAlgorithm>;
+    enum tags { tag_bcast = 1, tag_fold, tag_reduce, tag_gather };
+
+    static CollectiveAlgorithm default_algorithm(Collective coll, std::size_t bytes) {
+        switch (coll) {
+        case Collective::bcast:
+            return (bytes < (std::size_t(1) << 17) ? CollectiveAlgorithm::binomial : CollectiveAlgorithm::chain);
+        case Collective::allreduce:
+            if (bytes < (std::size_t(1) << 14)) return CollectiveAlgorithm::recursive_doubling;
+            return (bytes < (std::size_t(1) << 20) ? CollectiveAlgorithm::recursive_halving : CollectiveAlgorithm::ring);
+        default:
+            return (bytes < (std::size_t(1) << 12) ? CollectiveAlgorithm::bruck : CollectiveAlgorithm::ring);
+        }
+    }
+    // Maximal time over the processes of one call of fct
+    double measure(int nb_repetitions, const std::function<void()> &fct) const {
+        fct();
+        m_com.barrier();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nb_repetitions; ++i) fct();
+        double loc_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), time;
+        m_com.allreduce(loc_time, time, Parallel::max);
+        return time;
+    }
+    // Exchange with a partner : the receive is posted before the send
+    template <typename K>
+    void exchange(std::size_t nb_snd, const K *snd, std::size_t nb_rcv, K *rcv, int partner, int tag) const {
+        Request req = m_com.irecv(nb_rcv, rcv, partner, tag);
+        m_com.send(nb_snd, snd, partner, tag);
+        req.wait();
+    }
+    // ---------------------------------------------------------------------------------------------
+    template <typename K>
+    void binomial_bcast(std::size_t nbItems, K *buffer, int root) const {
+        const int p = m_com.size, vr = (m_com.rank - root + p) % p;
+        int mask    = 1;
+        while (mask < p) {
+            if (vr & mask) {
+                m_com.recv(nbItems, buffer, (vr - mask + root) % p, tag_bcast);
+                break;
+            }
+            mask <<= 1;
+        }
+        std::vector<Request> sends;
+        for (mask >>= 1; mask > 0; mask >>= 1)
+            if (vr + mask < p) sends.push_back(m_com.isend(nbItems, buffer, (vr + mask + root) % p, tag_bcast));
+        for (auto &req : sends) req.wait();
+    }
+    // The receives of all the segments are posted first, then each segment is forwarded when received
+    template <typename K>
+    void chain_bcast(std::size_t nbItems, K *buffer, int root) const {
+        const int p = m_com.size, vr = (m_com.rank - root + p) % p;
+        const std::size_t segment = std::max(m_segment_size / sizeof(K), std::size_t(1));
+        const std::size_t nb_segs = (nbItems + segment - 1) / segment;
+        std::vector<Request> rcvs, sends;
+        if (vr > 0)
+            for (std::size_t s = 0; s < nb_segs; ++s)
+                rcvs.push_back(m_com.irecv(std::min(segment, nbItems - s * segment), buffer + s * segment,
+                                           (vr - 1 + root) % p, tag_bcast));
+        for (std::size_t s = 0; s < nb_segs; ++s) {
+            if (vr > 0) rcvs[s].wait();
+            if (vr + 1 < p)
+                sends.push_back(m_com.isend(std::min(segment, nbItems - s * segment), buffer + s * segment,
+                                            (vr + 1 + root) % p, tag_bcast));
+        }
+        for (auto &req : sends) req.wait();
+    }
+    // ---------------------------------------------------------------------------------------------
+    // The 2*rem first processes are folded by pairs, so a power of two processes pof2 takes part in
+    // the algorithm. Return the rank among them ( -1 for the processes left aside ).
+    template <typename K, typename Func>
+    int fold(std::size_t nbItems, K *values, const Func &op, int pof2) const {
+        const int rank = m_com.rank, rem = m_com.size - pof2;
+        if (rank >= 2 * rem) return rank - rem;
+        if (rank % 2 == 0) {
+            m_com.send(nbItems, values, rank + 1, tag_fold);
+            return -1;
+        }
+        std::vector<K> tmp(nbItems);
+        m_com.recv(nbItems, tmp.data(), rank - 1, tag_fold);
+        for (std::size_t i = 0; i < nbItems; ++i) values[i] = op(tmp[i], values[i]);
+        return rank / 2;
+    }
+    template <typename K>
+    void unfold(std::size_t nbItems, K *values, int pof2) const {
+        const int rank = m_com.rank, rem = m_com.size - pof2;
+        if (rank >= 2 * rem) return;
+        if (rank % 2 == 0)
+            m_com.recv(nbItems, values, rank + 1, tag_fold);
+        else
+            m_com.send(nbItems, values, rank - 1, tag_fold);
+    }
+    int largest_power_of_two() const {
+        int pof2 = 1;
+        while (2 * pof2 <= m_com.size) pof2 *= 2;
+        return pof2;
+    }
+    // Rank of the process of rank newrank among the pof2 processes
+    int real_rank(int newrank, int pof2) const {
+        const int rem = m_com.size - pof2;
+        return (newrank < rem ? 2 * newrank + 1 : newrank + rem);
+    }
+    template <typename K, typename Func>
+    void recursive_doubling_allreduce(std::size_t nbItems, K *values, const Func &op) const {
+        const int pof2    = largest_power_of_two();
+        const int newrank = fold(nbItems, values, op, pof2);
+        if (newrank >= 0) {
+            std::vector<K> tmp(nbItems);
+            for (int mask = 1; mask < pof2; mask <<= 1) {
+                const int partner = real_rank(newrank ^ mask, pof2);
+                exchange(nbItems, values, nbItems, tmp.data(), partner, tag_reduce);
+                // The values of the lower ranks come first
+                if (partner < m_com.rank)
+                    for (std::size_t i = 0; i < nbItems; ++i) values[i] = op(tmp[i], values[i]);
+                else
+                    for (std::size_t i = 0; i < nbItems; ++i) values[i] = op(values[i], tmp[i]);
+            }
+        }
+        unfold(nbItems, values, pof2);
+    }
+    // Rabenseifner : the block b of the nb_blocks blocks begins at b * nbItems / nb_blocks
+    template <typename K, typename Func>
+    void recursive_halving_allreduce(std::size_t nbItems, K *values, const Func &op) const {
+        const int pof2    = largest_power_of_two();
+        const int newrank = fold(nbItems, values, op, pof2);
+        if (newrank >= 0) {
+            auto offset = [nbItems, pof2](int b) { return std::size_t(b) * nbItems / std::size_t(pof2); };
+            std::vector<K> tmp(offset(pof2 / 2 + 1));
+            // Reduce-scatter : the process keeps the half of its blocks containing the block newrank
+            int lo = 0, hi = pof2;
+            for (int mask = pof2 / 2; mask > 0; mask >>= 1) {
+                const int partner = real_rank(newrank ^ mask, pof2), mid = lo + (hi - lo) / 2;
+                const int keep_lo = ((newrank & mask) == 0 ? lo : mid), keep_hi = ((newrank & mask) == 0 ? mid : hi);
+                const int send_lo = ((newrank & mask) == 0 ? mid : lo), send_hi = ((newrank & mask) == 0 ? hi : mid);
+                const std::size_t nb_keep = offset(keep_hi) - offset(keep_lo);
+                tmp.resize(nb_keep);
+                exchange(offset(send_hi) - offset(send_lo), values + offset(send_lo), nb_keep, tmp.data(), partner,
+                         tag_reduce);
+                K *kept = values + offset(keep_lo);
+                for (std::size_t i = 0; i < nb_keep; ++i) kept[i] = op(tmp[i], kept[i]);
+                lo = keep_lo;
+                hi = keep_hi;
+            }
+            // Allgather by recursive doubling of the reduced blocks
+            for (int mask = 1; mask < pof2; mask <<= 1) {
+                const int partner = real_rank(newrank ^ mask, pof2);
+                const int plo = ((newrank & mask) == 0 ? hi : lo - mask), phi = plo + mask;
+                exchange(offset(hi) - offset(lo), values + offset(lo), offset(phi) - offset(plo), values + offset(plo),
+                         partner, tag_gather);
+                lo = std::min(lo, plo);
+                hi = std::max(hi, phi);
+            }
+        }
+        unfold(nbItems, values, pof2);
+    }
+    // Reduce-scatter along the ring, then allgather of the reduced blocks along the ring
+    template <typename K, typename Func>
+    void ring_allreduce(std::size_t nbItems, K *values, const Func &op) const {
+        const int p = m_com.size, rank = m_com.rank;
+        const int left = (rank - 1 + p) % p, right = (rank + 1) % p;
+        auto offset = [nbItems, p](int b) { return std::size_t(b) * nbItems / std::size_t(p); };
+        std::vector<K> tmp(offset(1) + 1);
+        for (int s = 0; s < p - 1; ++s) {
+            const int snd_block = (rank - s + p) % p, rcv_block = (rank - s - 1 + p) % p;
+            const std::size_t nb_rcv = offset(rcv_block + 1) - offset(rcv_block);
+            tmp.resize(nb_rcv);
+            Request req = m_com.irecv(nb_rcv, tmp.data(), left, tag_reduce);
+            m_com.send(offset(snd_block + 1) - offset(snd_block), values + offset(snd_block), right, tag_reduce);
+            req.wait();
+            K *block = values + offset(rcv_block);
+            for (std::size_t i = 0; i < nb_rcv; ++i) block[i] = op(tmp[i], block[i]);
+        }
+        for (int s = 0; s < p - 1; ++s) {
+            const int snd_block = (rank - s + 1 + p) % p, rcv_block = (rank - s + p) % p;
+            Request req = m_com.irecv(offset(rcv_block + 1) - offset(rcv_block), values + offset(rcv_block), left,
+                                      tag_gather);
+            m_com.send(offset(snd_block + 1) - offset(snd_block), values + offset(snd_block), right, tag_gather);
+            req.wait();
+        }
+    }
+    // ---------------------------------------------------------------------------------------------
+    template <typename K>
+    void ring_allgather(std::size_t nbItems, K *rcv) const {
+        const int p = m_com.size, rank = m_com.rank;
+        const int left = (rank - 1 + p) % p, right = (rank + 1) % p;
+        for (int s = 0; s < p - 1; ++s) {
+            const int snd_block = (rank - s + p) % p, rcv_block = (rank - s - 1 + p) % p;
+            Request req = m_com.irecv(nbItems, rcv + rcv_block * nbItems, left, tag_gather);
+            m_com.send(nbItems, rcv + snd_block * nbItems, right, tag_gather);
+            req.wait();
+        }
+    }
+    // The processes exchange the blocks gathered so far with the process at distance 1, 2, 4, ...
+    template <typename K>
+    void recursive_doubling_allgather(std::size_t nbItems, K *rcv) const {
+        const int rank = m_com.rank;
+        for (int mask = 1; mask < m_com.size; mask <<= 1) {
+            const int partner = rank ^ mask;
+            const int first = rank & ~(mask - 1), partner_first = partner & ~(mask - 1);
+            exchange(mask * nbItems, rcv + first * nbItems, mask * nbItems, rcv + partner_first * nbItems, partner,
+                     tag_gather);
+        }
+    }
+    // The block j of the temporary buffer holds the data of the process rank + j
+    template <typename K>
+    void bruck_allgather(std::size_t nbItems, const K *snd, K *rcv) const {
+        const int p = m_com.size, rank = m_com.rank;
+        std::vector<K> tmp(nbItems * p);
+        std::copy(snd, snd + nbItems, tmp.begin());
+        for (int dist = 1; dist < p; dist <<= 1) {
+            const std::size_t nb_blocks = std::size_t(std::min(dist, p - dist));
+            Request req = m_com.irecv(nb_blocks * nbItems, tmp.data() + dist * nbItems, (rank + dist) % p, tag_gather);
+            m_com.send(nb_blocks * nbItems, tmp.data(), (rank - dist + p) % p, tag_gather);
+            req.wait();
+        }
+        for (int j = 0; j < p; ++j)
+            std::copy(tmp.begin() + j * nbItems, tmp.begin() + (j + 1) * nbItems, rcv + ((rank + j) % p) * nbItems);
+    }
+
+    Communicator m_com;
+    std::size_t m_segment_size = Communicator::default_segment_size;
+    std::array<std::vector<Entry>, 3> m_table;
+};
+}
+#endif
@@ -24,7 +24,9 @@
 #define _PARALLEL_COMMUNICATOR_HPP_
 #include <cstdlib>
 #include <functional>
+#include <map>
 #include <memory>
+#include <type_traits>
 #include <vector>
 #include "core/chronometer.hpp"
 #include "core/multitimer.hpp"
@@ -141,6 +143,17 @@ class Communicator {
   Communicator& operator=(const Communicator& com) = delete;
   Communicator& operator=(Communicator&& com) = delete;
 
+  /*!
+   *   \brief Tree along which the segments of a pipelined broadcast are forwarded
+   */
+  enum class BroadcastTree {
+    chain, /*!< Each process forwards the segments to the next rank */
+    binary /*!< Each process forwards the segments to two children */
+  };
+  static constexpr std::size_t default_segment_size =
+      65536; /*!< Default size ( in bytes ) of the segments of a pipelined broadcast */
+  static constexpr std::size_t default_max_count =
+      2147483647; /*!< Default largest number of elements given to one MPI call */
   // ===============================================================================================
   //                               Context of the communicator
   int rank; /*!< Rank of the current process inside the communicator instance */
@@ -176,6 +189,33 @@ class Communicator {
    */
   std::vector<int> translateRanks(const Communicator& othercom,
                                   const std::vector<int>& ranksToTranslate);
+
+  /**
+   * @brief      Translate the rank rk in the world communicator ( the
+   *             translation table is computed at the first call )
+   *
+   * @param[in]  rk    The rank to translate
+   *
+   * @return     The rank in the world communicator
+   */
+  int worldRank(int rk) const;
+
+  /**
+   * @brief      Return the communicator of the library used for the
+   *             implementation ( MPI_Comm for MPI )
+   *
+   * @return     The external communicator
+   */
+  const Ext_Communicator& externalCommunicator() const;
+
+  /**
+   * @brief      Split the communicator in groups of processes which can share
+   *             memory ( the processes running on the same node ). The ranks
+   *             keep the order of the current communicator.
+   *
+   * @return     The communicator of the node containing the current process
+   */
+  std::unique_ptr<Communicator> split_shared() const;
   // ===============================================================================================
   //                               Point to point communication
   /*!
@@ -364,6 +404,188 @@ class Communicator {
    */
   template <typename K>
   void bcast(std::size_t nbObjs, K* b_rcv, int root = 0) const;
+  /*!
+   *    \brief Start a broadcast from a process to other processes.
+   *
+   *    Non blocking version of \ref bcast : b_rcv must not be used before the
+   *    completion of the returned request. All the processes must start their
+   *    non blocking broadcasts on the communicator in the same order.
+   *
+   *    \param nbObjs Number of items to broadcast.
+   *    \param b_snd  The buffer of objects to broadcast ( significant only on
+   *                  the root process, copied in b_rcv by the call )
+   *    \param b_rcv  The buffer of objects where receive broadcasted objects
+   *    \param root   The rank of the root process
+   *
+   *    \return The request of the broadcast
+   */
+  template <typename K>
+  Request ibcast(std::size_t nbObjs, const K* b_snd, K* b_rcv,
+                 int root = 0) const;
+  /*!
+   *    \brief Perform a segmented broadcast for large buffers.
+   *
+   *    The buffer is splitted in segments of segment_size bytes which are
+   *    pipelined down a chain or a binary tree rooted on the root process :
+   *    each process forwards a segment to its children with non blocking
+   *    sends as soon as it has received it, so the links of the tree work
+   *    simultaneously on different segments.
+   *
+   *    \param nbObjs       Number of items to broadcast.
+   *    \param b_snd        The buffer of objects to broadcast ( significant
+   *                        only on the root process )
+   *    \param b_rcv        The buffer of objects where receive broadcasted
+   *                        objects ( must be allocated before the call )
+   *    \param root         The rank of the root process
+   *    \param segment_size The size in bytes of the segments
+   *    \param tree         The tree used to forward the segments
+   */
+  template <typename K>
+  void pipelined_bcast(std::size_t nbObjs, const K* b_snd, K* b_rcv,
+                       int root = 0,
+                       std::size_t segment_size = default_segment_size,
+                       BroadcastTree tree = BroadcastTree::binary) const;
+  /*!
+   *    \brief Select the pipelined broadcast for large buffers.
+   *
+   *    After this call, the broadcasts of buffers whose size is greater or
+   *    equal to threshold bytes use \ref pipelined_bcast. The same values
+   *    must be set on all processes of the communicator.
+   *
+   *    \param threshold    Size in bytes from which the pipelined broadcast is
+   *                        used
+   *    \param segment_size The size in bytes of the segments
+   *    \param tree         The tree used to forward the segments
+   */
+  void setPipelinedBroadcast(std::size_t threshold,
+                             std::size_t segment_size = default_segment_size,
+                             BroadcastTree tree = BroadcastTree::binary);
+  /*!
+   *    \brief Broadcast in two levels : from the root to the leaders ( the
+   *    first process ) of the nodes, then from each leader to the processes
+   *    of its node.
+   *
+   *    The nodes are the shared memory nodes, or the groups given by
+   *    \ref setHierarchicalCollectives. The node and leader communicators are
+   *    built by the first two level operation of the communicator, so the
+   *    slow network links are used once per node.
+   */
+  template <typename K>
+  void hierarchical_bcast(std::size_t nbObjs, const K* b_snd, K* b_rcv,
+                          int root = 0) const;
+  /*!
+   *    \brief Reduction in two levels : reduction in each node, then between
+   *    the leaders of the nodes ( see \ref hierarchical_bcast ).
+   */
+  template <typename K>
+  void hierarchical_reduce(std::size_t nbItems, const K* obj, K* res,
+                           Operation op, int root = 0) const;
+  /*!
+   *    \brief Reduction in two levels : reduction in each node, then between
+   *    the leaders of the nodes, then broadcast in each node.
+   */
+  template <typename K>
+  void hierarchical_allreduce(std::size_t nbItems, const K* obj, K* res,
+                              Operation op) const;
+  /*!
+   *    \brief Select the two level collective operations.
+   *
+   *    After this call, the broadcasts and the reductions with a predefined
+   *    operation of buffers whose size is greater or equal to threshold bytes
+   *    use \ref hierarchical_bcast, \ref hierarchical_reduce and
+   *    \ref hierarchical_allreduce when the communicator spans several nodes
+   *    holding several processes. The same values must be set on all
+   *    processes of the communicator.
+   *
+   *    \param threshold      Size in bytes from which the two level operations
+   *                          are used ( the maximal size_t disables them )
+   *    \param ranks_per_node 0 for the shared memory nodes, or number of
+   *                          consecutive ranks gathered in a node ( sockets,
+   *                          or emulation of several nodes )
+   */
+  void setHierarchicalCollectives(std::size_t threshold, int ranks_per_node = 0);
+  /*!
+   *    \brief Compress the broadcasts of large float or double buffers.
+   *
+   *    After this call, the broadcasts of float or double buffers whose size
+   *    is greater or equal to threshold bytes are compressed without loss
+   *    ( see Compression ). The same value must be set on all processes of
+   *    the communicator. The compression pays for smooth values sent on a
+   *    network slower than the compression.
+   *
+   *    \param threshold    Size in bytes from which the buffers are compressed
+   *                        ( the maximal size_t disables the compression )
+   */
+  void setCompression(std::size_t threshold);
+  std::size_t compressionThreshold() const;
+  /*!
+   *    \brief Set the largest number of elements given to one MPI call.
+   *
+   *    The counts of the MPI functions are int : the send, receive, broadcast
+   *    and reduction of larger buffers are done in blocks of at most count
+   *    elements ( one element of a derived datatype made of the blocks for the
+   *    messages and the broadcasts, successive calls for the reductions ).
+   *    With MPI 4, the large count functions ( MPI_Send_c, ... ) are called
+   *    instead. The value is shared by all the communicators of the process
+   *    and must be the same on all processes.
+   *
+   *    \param count  Largest number of elements ( at most default_max_count )
+   */
+  static void setMaxCount(std::size_t count);
+  static std::size_t maxCount();
+  /*!
+   *    \brief Send a compressed buffer of float or double.
+   *
+   *    The message must be received by \ref recvCompressed.
+   */
+  template <typename K>
+  void sendCompressed(std::size_t nbObjs, const K* buff, int dest,
+                      int tag = 0) const;
+  /*!
+   *    \brief Receive and decompress a buffer sent by \ref sendCompressed.
+   *
+   *    \param nbObjs Number of values sent ( std::runtime_error is thrown
+   *                  if the message holds another number of values )
+   *
+   *    \return The status of the compressed message
+   */
+  template <typename K>
+  Status recvCompressed(std::size_t nbObjs, K* buff, int sender = any_source,
+                        int tag = any_tag) const;
+  /*!
+   *    \brief Broadcast a compressed buffer of float or double, whatever
+   *    its size.
+   *
+   *    \param b_snd The buffer to broadcast ( significant only on root )
+   *    \param b_rcv The buffer receiving the values ( allocated before the call )
+   */
+  template <typename K>
+  void bcastCompressed(std::size_t nbObjs, const K* b_snd, K* b_rcv,
+                       int root = 0) const;
+  /*!
+   *    \brief Send a serialized object ( see Serialization ).
+   *
+   *    send, recv and bcast call the serialized versions for the objects
+   *    which aren't trivially copyable ( std::map, std::vector<std::string>,
+   *    objects with a serialize member, ... ). The large contiguous blocks of
+   *    the object aren't copied : the parts of the stream are sent as one
+   *    message.
+   */
+  template <typename K>
+  void sendSerialized(const K& obj, int dest, int tag = 0) const;
+  /*!
+   *    \brief Receive an object sent by \ref sendSerialized
+   *
+   *    std::runtime_error is thrown if the message doesn't match the object.
+   */
+  template <typename K>
+  Status recvSerialized(K& obj, int sender = any_source,
+                        int tag = any_tag) const;
+  /*!
+   *    \brief Broadcast a serialized object ( obj is the object sent on root )
+   */
+  template <typename K>
+  void bcastSerialized(K& obj, int root = 0) const;
   // :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
   /*!
    *    \brief Blocks until all processor inside the communicator have reached
@@ -589,6 +811,218 @@ class Communicator {
   template <typename K, typename Func>
   void allreduce(std::size_t nbObjs, const K* b_objs, K* b_res, const Func& op,
                  bool is_commutable = false) const;
+  // ===============================================================================================
+  //                            Gather, scatter and all to all families
+  /*!
+   *    \brief Gather one object per process on the root process.
+   *
+   *    The object of the process of rank i is stored in b_rcv[i].
+   *
+   *    \param obj   The object to send to the root process
+   *    \param b_rcv The buffer where store the gathered objects ( must be
+   *                 allocated with size objects before the call, significant
+   *                 only on the root process )
+   *    \param root  The rank of the root process
+   */
+  template <typename K>
+  void gather(const K& obj, K* b_rcv, int root = 0) const;
+  /*!
+   *    \brief Gather the same number of objects per process on the root process.
+   *
+   *    \param nbObjs Number of objects sended by each process
+   *    \param b_snd  The buffer of objects to send to the root process
+   *    \param b_rcv  The buffer where store the gathered objects ( must be
+   *                  allocated with nbObjs x size objects, significant only
+   *                  on the root process )
+   *    \param root   The rank of the root process
+   */
+  template <typename K>
+  void gather(std::size_t nbObjs, const K* b_snd, K* b_rcv, int root = 0) const;
+  /*!
+   *    \brief Gather a variable number of objects per process on the root process.
+   *
+   *    The displacements inside b_rcv are computed from the counts ( the data
+   *    coming from each process are stored contiguously by rank order ).
+   *
+   *    \param nbObjs Number of objects sended by the current process
+   *    \param b_snd  The buffer of objects to send to the root process
+   *    \param counts The number of objects sended by each process ( significant
+   *                  only on the root process )
+   *    \param b_rcv  The buffer where store the gathered objects ( significant
+   *                  only on the root process )
+   *    \param root   The rank of the root process
+   */
+  template <typename K>
+  void gatherv(std::size_t nbObjs, const K* b_snd,
+               const std::vector<std::size_t>& counts, K* b_rcv,
+               int root = 0) const;
+  /*!
+   *    \brief Gather the content of containers on the root process.
+   *
+   *    The sizes of the containers are gathered first, so the root process
+   *    resizes rcv and the counts/displacements are computed automatically.
+   *
+   *    \param snd   The container to send
+   *    \param rcv   The container where the gathered values are concatenated
+   *                 by rank order ( significant only on the root process )
+   *    \param root  The rank of the root process
+   *    \return      The number of values sended by each process ( significant
+   *                 only on the root process )
+   */
+  template <typename K>
+  std::vector<std::size_t> gatherv(const K& snd, K& rcv, int root = 0) const;
+  // :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+  /*!
+   *    \brief Scatter one object per process from the root process.
+   *
+   *    \param b_snd The buffer of size objects to scatter ( significant only
+   *                 on the root process )
+   *    \param obj   The object where receive the value b_snd[rank]
+   *    \param root  The rank of the root process
+   */
+  template <typename K>
+  void scatter(const K* b_snd, K& obj, int root = 0) const;
+  /*!
+   *    \brief Scatter the same number of objects per process from the root process.
+   *
+   *    \param nbObjs Number of objects received by each process
+   *    \param b_snd  The buffer of nbObjs x size objects to scatter (
+   *                  significant only on the root process )
+   *    \param b_rcv  The buffer where receive the objects
+   *    \param root   The rank of the root process
+   */
+  template <typename K>
+  void scatter(std::size_t nbObjs, const K* b_snd, K* b_rcv, int root = 0) const;
+  /*!
+   *    \brief Scatter a variable number of objects per process from the root process.
+   *
+   *    \param counts The number of objects to send to each process ( significant
+   *                  only on the root process )
+   *    \param b_snd  The buffer of objects to scatter, stored by rank order (
+   *                  significant only on the root process )
+   *    \param nbObjs Number of objects received by the current process
+   *    \param b_rcv  The buffer where receive the objects
+   *    \param root   The rank of the root process
+   */
+  template <typename K>
+  void scatterv(const std::vector<std::size_t>& counts, const K* b_snd,
+                std::size_t nbObjs, K* b_rcv, int root = 0) const;
+  /*!
+   *    \brief Scatter the content of a container from the root process.
+   *
+   *    The counts are scattered first, so each process resizes rcv
+   *    automatically.
+   *
+   *    \param snd    The container to scatter ( significant only on the root
+   *                  process )
+   *    \param counts The number of values to send to each process ( significant
+   *                  only on the root process )
+   *    \param rcv    The container where receive the values
+   *    \param root   The rank of the root process
+   */
+  template <typename K>
+  void scatterv(const K& snd, const std::vector<std::size_t>& counts, K& rcv,
+                int root = 0) const;
+  // :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+  /*!
+   *    \brief Gather one object per process on all processes.
+   *
+   *    \param obj   The object to send
+   *    \param b_rcv The buffer of size objects where store the gathered objects
+   */
+  template <typename K>
+  void allgather(const K& obj, K* b_rcv) const;
+  /*!
+   *    \brief Gather the same number of objects per process on all processes.
+   *
+   *    \param nbObjs Number of objects sended by each process
+   *    \param b_snd  The buffer of objects to send
+   *    \param b_rcv  The buffer of nbObjs x size objects where store the
+   *                  gathered objects
+   */
+  template <typename K>
+  void allgather(std::size_t nbObjs, const K* b_snd, K* b_rcv) const;
+  /*!
+   *    \brief Gather a variable number of objects per process on all processes.
+   *
+   *    \param nbObjs Number of objects sended by the current process
+   *    \param b_snd  The buffer of objects to send
+   *    \param counts The number of objects sended by each process
+   *    \param b_rcv  The buffer where store the gathered objects by rank order
+   */
+  template <typename K>
+  void allgatherv(std::size_t nbObjs, const K* b_snd,
+                  const std::vector<std::size_t>& counts, K* b_rcv) const;
+  /*!
+   *    \brief Gather the content of containers on all processes.
+   *
+   *    \param snd The container to send
+   *    \param rcv The container where the values are concatenated by rank order
+   *    \return    The number of values sended by each process
+   */
+  template <typename K>
+  std::vector<std::size_t> allgatherv(const K& snd, K& rcv) const;
+  // :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+  /*!
+   *    \brief Each process sends one distinct object to each process.
+   *
+   *    \param b_snd The buffer of size objects to send ( b_snd[i] is sended
+   *                 to the process i )
+   *    \param b_rcv The buffer of size objects where receive ( b_rcv[i] comes
+   *                 from the process i )
+   */
+  template <typename K>
+  void alltoall(const K* b_snd, K* b_rcv) const;
+  /*!
+   *    \brief Each process sends nbObjs distinct objects to each process.
+   *
+   *    \param nbObjs Number of objects exchanged between each pair of processes
+   *    \param b_snd  The buffer of nbObjs x size objects to send
+   *    \param b_rcv  The buffer of nbObjs x size objects where receive
+   */
+  template <typename K>
+  void alltoall(std::size_t nbObjs, const K* b_snd, K* b_rcv) const;
+  /*!
+   *    \brief Each process sends a variable number of objects to each process.
+   *
+   *    \param snd_counts The number of objects to send to each process
+   *    \param b_snd      The buffer of objects to send, stored by rank order
+   *    \param rcv_counts The number of objects to receive from each process
+   *    \param b_rcv      The buffer where receive objects by rank order
+   */
+  template <typename K>
+  void alltoallv(const std::vector<std::size_t>& snd_counts, const K* b_snd,
+                 const std::vector<std::size_t>& rcv_counts, K* b_rcv) const;
+  /*!
+   *    \brief Each process sends a part of a container to each process.
+   *
+   *    The counts are exchanged first, so rcv is resized automatically.
+   *
+   *    \param snd_counts The number of values to send to each process
+   *    \param snd        The container to send, stored by rank order
+   *    \param rcv        The container where receive the values by rank order
+   *    \return           The number of values received from each process
+   */
+  template <typename K>
+  std::vector<std::size_t> alltoallv(const std::vector<std::size_t>& snd_counts,
+                                     const K& snd, K& rcv) const;
+  /*!
+   *    \brief Sparse exchange of messages when each process knows the
+   *           processes it sends to, but not the processes it receives from.
+   *
+   *    Non blocking consensus ( NBX ) : the messages are sent with synchronous
+   *    sends, the incoming messages are probed until all the sends are
+   *    matched, then a non blocking barrier detects when all the processes
+   *    have received all their messages. No count is exchanged, so the cost
+   *    depends on the number of messages and not on the number of processes.
+   *    Must be called by all the processes of the communicator.
+   *
+   *    \param messages The messages to send, by destination rank
+   *    \return         The received messages, by source rank
+   */
+  template <typename K>
+  std::map<int, std::vector<K>> sparse_exchange(
+      const std::map<int, std::vector<K>>& messages) const;
   // ===================================================================
   Status probe(int source = any_source, int tag = any_tag);
   // Return status with  if none message with specified source and tag is
@@ -599,8 +1033,22 @@ class Communicator {
   friend Communicator::Chronometer;
 
  private:
-  void set_pt_chrono(Communicator::Chronometer* pt_chrono);
   struct Implementation;
+  explicit Communicator(Implementation* impl);
+  // Objects sent as they are ( false_type ) or serialized ( true_type )
+  template <typename K>
+  void send_object(const K& obj, int dest, int tag, std::false_type) const;
+  template <typename K>
+  void send_object(const K& obj, int dest, int tag, std::true_type) const;
+  template <typename K>
+  Status recv_object(K& obj, int sender, int tag, std::false_type) const;
+  template <typename K>
+  Status recv_object(K& obj, int sender, int tag, std::true_type) const;
+  template <typename K>
+  void bcast_object(const K* o_snd, K& o_rcv, int root, std::false_type) const;
+  template <typename K>
+  void bcast_object(const K* o_snd, K& o_rcv, int root, std::true_type) const;
+  void set_pt_chrono(Communicator::Chronometer* pt_chrono);
   Implementation* m_impl;
 };
 }
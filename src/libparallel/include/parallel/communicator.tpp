@@ -13,138 +13,439 @@
 // limitations under the License.
 // template for Communicator class
 #include "core/multitimer"
+#include "parallel/compression.hpp"
+#include "parallel/serialization.hpp"
+#include "parallel/tracer.hpp"
 #if defined( USE_MPI )
 #include "parallel/communicator_mpi.tpp"
 #elif defined( USE_PVM )
 #include "parallel/communicator_pvm.tpp"
 #else
-#include "parallel/communicator_stub.tpp"
+#include "parallel/communicator_threads.tpp"
 #endif
 
 namespace Parallel {
+    namespace {
+        // Size in bytes of an object, or of the values of a container
+        template <typename K>
+        std::size_t message_bytes( const K&, std::false_type ) {
+            return sizeof( K );
+        }
+        template <typename K>
+        std::size_t message_bytes( const K& cont, std::true_type ) {
+            return cont.size( ) * sizeof( typename K::value_type );
+        }
+        template <typename K>
+        std::size_t message_bytes( const K& obj ) {
+            return message_bytes( obj, std::integral_constant<bool, is_container<K>::value>( ) );
+        }
+        // Compressed broadcast of the large buffers of float or double ( see setCompression )
+        template <typename K>
+        bool compressed_bcast( const Communicator&, std::size_t, const K*, K*, int, std::false_type ) {
+            return false;
+        }
+        template <typename K>
+        bool compressed_bcast( const Communicator& com, std::size_t nbObjs, const K* b_snd, K* b_rcv, int root,
+                               std::true_type ) {
+            if ( nbObjs * sizeof( K ) < com.compressionThreshold( ) ) return false;
+            com.bcastCompressed( nbObjs, b_snd, b_rcv, root );
+            return true;
+        }
+    }
     template <typename K>
     void Communicator::send( const K& obj, int dest, int tag ) const {
+        send_object( obj, dest, tag, Serialization::needs_serialization<K>( ) );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::send_object( const K& obj, int dest, int tag, std::false_type ) const {
+        Tracer::Scope trace( *this, Tracer::send, dest, tag, message_bytes( obj ) );
         m_impl->send( obj, dest, tag );
     }
     // .................................................................
     template <typename K>
+    void Communicator::send_object( const K& obj, int dest, int tag, std::true_type ) const {
+        sendSerialized( obj, dest, tag );
+    }
+    // .................................................................
+    template <typename K>
     void Communicator::send( std::size_t nbObjs, const K* buff, int dest, int tag ) const {
+        Tracer::Scope trace( *this, Tracer::send, dest, tag, nbObjs * sizeof( K ) );
         m_impl->send( nbObjs, buff, dest, tag );
     }
     // .................................................................
     template <typename K>
     Request Communicator::isend( const K& obj, int dest, int tag ) const {
+        static_assert( !Serialization::needs_serialization<K>::value,
+                       "The serialized objects are only sent by send and bcast" );
+        Tracer::Scope trace( *this, Tracer::isend, dest, tag, message_bytes( obj ) );
         return m_impl->isend( obj, dest, tag );
     }
     // .................................................................
     template <typename K>
     Request Communicator::isend( std::size_t nbItems, const K* obj, int dest, int tag ) const {
+        Tracer::Scope trace( *this, Tracer::isend, dest, tag, nbItems * sizeof( K ) );
         return m_impl->isend( nbItems, obj, dest, tag );
     }
     // .................................................................
     template <typename K>
     Status Communicator::recv( K& obj, int sender, int tag ) const {
-        return m_impl->recv( obj, sender, tag );
+        return recv_object( obj, sender, tag, Serialization::needs_serialization<K>( ) );
+    }
+    // .................................................................
+    template <typename K>
+    Status Communicator::recv_object( K& obj, int sender, int tag, std::false_type ) const {
+        Tracer::Scope trace( *this, Tracer::recv, sender, tag, 0 );
+        Status        status = m_impl->recv( obj, sender, tag );
+        trace.received( status );
+        return status;
+    }
+    // .................................................................
+    template <typename K>
+    Status Communicator::recv_object( K& obj, int sender, int tag, std::true_type ) const {
+        return recvSerialized( obj, sender, tag );
     }
     // .................................................................
     template <typename K>
     Status Communicator::recv( std::size_t nbObjs, K* buff, int sender, int tag ) const {
-        return m_impl->recv( nbObjs, buff, sender, tag );
+        Tracer::Scope trace( *this, Tracer::recv, sender, tag, 0 );
+        Status        status = m_impl->recv( nbObjs, buff, sender, tag );
+        trace.received( status );
+        return status;
     }
     // .................................................................
     template <typename K>
     Request Communicator::irecv( K& obj, int sender, int tag ) const {
+        static_assert( !Serialization::needs_serialization<K>::value,
+                       "The serialized objects are only received by recv and bcast" );
+        Tracer::Scope trace( *this, Tracer::irecv, sender, tag, message_bytes( obj ) );
         return m_impl->irecv( obj, sender, tag );
     }
     // .................................................................
     template <typename K>
     Request Communicator::irecv( std::size_t nbObjs, K* buff, int sender, int tag ) const {
+        Tracer::Scope trace( *this, Tracer::irecv, sender, tag, nbObjs * sizeof( K ) );
         return m_impl->irecv( nbObjs, buff, sender, tag );
     }
     // =================================================================
     // Opérations collectives :
     template <typename K>
     void Communicator::bcast( const K& objsnd, K& objrcv, int root ) const {
-        m_impl->broadcast( &objsnd, objrcv, root );
+        bcast_object( &objsnd, objrcv, root, Serialization::needs_serialization<K>( ) );
     }
     // .................................................................
     template <typename K>
     void Communicator::bcast( K& objrcv, int root ) const {
-        m_impl->broadcast( static_cast<K*>( nullptr ), objrcv, root );
+        bcast_object( static_cast<const K*>( nullptr ), objrcv, root, Serialization::needs_serialization<K>( ) );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::bcast_object( const K* objsnd, K& objrcv, int root, std::false_type ) const {
+        Tracer::Scope trace( *this, Tracer::bcast, root, 0, 0 );
+        m_impl->broadcast( objsnd, objrcv, root );
+        trace.setBytes( message_bytes( objrcv ) );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::bcast_object( const K* objsnd, K& objrcv, int root, std::true_type ) const {
+        if ( ( rank == root ) && ( objsnd != nullptr ) && ( objsnd != &objrcv ) ) objrcv = *objsnd;
+        bcastSerialized( objrcv, root );
     }
     // .................................................................
     template <typename K>
     void Communicator::bcast( std::size_t nbObjs, const K* b_snd, K* b_rcv, int root ) const {
+        if ( compressed_bcast( *this, nbObjs, b_snd, b_rcv, root, Compression::is_compressible<K>( ) ) ) return;
+        Tracer::Scope trace( *this, Tracer::bcast, root, 0, nbObjs * sizeof( K ) );
         m_impl->broadcast( nbObjs, b_snd, b_rcv, root );
     }
     // .................................................................
     template <typename K>
     void Communicator::bcast( std::size_t nbObjs, K* b_rcv, int root ) const {
+        if ( compressed_bcast( *this, nbObjs, (const K*)nullptr, b_rcv, root, Compression::is_compressible<K>( ) ) )
+            return;
+        Tracer::Scope trace( *this, Tracer::bcast, root, 0, nbObjs * sizeof( K ) );
         m_impl->broadcast( nbObjs, (const K*)nullptr, b_rcv, root );
     }
+    // .................................................................
+    template <typename K>
+    Request Communicator::ibcast( std::size_t nbObjs, const K* b_snd, K* b_rcv, int root ) const {
+        Tracer::Scope trace( *this, Tracer::bcast, root, 0, nbObjs * sizeof( K ) );
+        return m_impl->ibroadcast( nbObjs, b_snd, b_rcv, root );
+    }
+    // .................................................................
+    // The compressed messages are sent as buffers of bytes ( traced with their compressed size )
+    template <typename K>
+    void Communicator::sendCompressed( std::size_t nbObjs, const K* buff, int dest, int tag ) const {
+        static_assert( Compression::is_compressible<K>::value, "Only the buffers of float or double are compressed" );
+        std::vector<unsigned char> stream = Compression::compress( nbObjs, buff );
+        send( stream.size( ), stream.data( ), dest, tag );
+    }
+    // .................................................................
+    template <typename K>
+    Status Communicator::recvCompressed( std::size_t nbObjs, K* buff, int sender, int tag ) const {
+        static_assert( Compression::is_compressible<K>::value, "Only the buffers of float or double are compressed" );
+        std::vector<unsigned char> stream;
+        Status                     status = recv( stream, sender, tag );
+        Compression::decompress( stream.size( ), stream.data( ), nbObjs, buff );
+        return status;
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::bcastCompressed( std::size_t nbObjs, const K* b_snd, K* b_rcv, int root ) const {
+        static_assert( Compression::is_compressible<K>::value, "Only the buffers of float or double are compressed" );
+        std::vector<unsigned char> stream;
+        if ( rank == root ) {
+            stream = Compression::compress( nbObjs, b_snd );
+            if ( b_rcv != b_snd ) std::copy_n( b_snd, nbObjs, b_rcv );
+        }
+        std::size_t nbBytes = stream.size( );
+        bcast( 1, &nbBytes, &nbBytes, root );
+        stream.resize( nbBytes );
+        bcast( nbBytes, stream.data( ), stream.data( ), root );
+        if ( rank != root ) Compression::decompress( nbBytes, stream.data( ), nbObjs, b_rcv );
+    }
+    // .................................................................
+    // The stream is sent in parts ( the large blocks of the object aren't copied ) and received in
+    // a buffer of bytes
+    template <typename K>
+    void Communicator::sendSerialized( const K& obj, int dest, int tag ) const {
+        Serialization::OutputArchive archive( obj );
+        Tracer::Scope                trace( *this, Tracer::send, dest, tag, archive.size( ) );
+        m_impl->send_parts( archive, dest, tag );
+    }
+    // .................................................................
+    template <typename K>
+    Status Communicator::recvSerialized( K& obj, int sender, int tag ) const {
+        std::vector<char> stream;
+        Status            status = recv( stream, sender, tag );
+        Serialization::deserialize( stream.data( ), stream.size( ), obj );
+        return status;
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::bcastSerialized( K& obj, int root ) const {
+        std::vector<char> stream;
+        if ( rank == root ) stream = Serialization::OutputArchive( obj ).contiguous( );
+        std::size_t nbBytes = stream.size( );
+        bcast( 1, &nbBytes, &nbBytes, root );
+        stream.resize( nbBytes );
+        bcast( nbBytes, stream.data( ), stream.data( ), root );
+        if ( rank != root ) Serialization::deserialize( stream.data( ), stream.size( ), obj );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::pipelined_bcast( std::size_t nbObjs, const K* b_snd, K* b_rcv, int root,
+                                        std::size_t segment_size, BroadcastTree tree ) const {
+        Tracer::Scope trace( *this, Tracer::bcast, root, 0, nbObjs * sizeof( K ) );
+        m_impl->pipelined_broadcast( nbObjs, b_snd, b_rcv, root, segment_size, tree );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::hierarchical_bcast( std::size_t nbObjs, const K* b_snd, K* b_rcv, int root ) const {
+        Tracer::Scope trace( *this, Tracer::bcast, root, 0, nbObjs * sizeof( K ) );
+        m_impl->hierarchical_broadcast( nbObjs, b_snd, b_rcv, root );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::hierarchical_reduce( std::size_t nbItems, const K* obj, K* res, Operation op,
+                                            int root ) const {
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, nbItems * sizeof( K ) );
+        m_impl->hierarchical_reduce( nbItems, obj, res, op, root );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::hierarchical_allreduce( std::size_t nbItems, const K* obj, K* res, Operation op ) const {
+        Tracer::Scope trace( *this, Tracer::allreduce, Tracer::all, 0, nbItems * sizeof( K ) );
+        m_impl->hierarchical_allreduce( nbItems, obj, res, op );
+    }
     // =================================================================
     template <typename K>
     void Communicator::reduce( const K& obj, K& res, const Operation& op, int root ) const {
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, message_bytes( obj ) );
         m_impl->reduce( obj, &res, op, root );
     }
     // .................................................................
     template <typename K>
     void Communicator::reduce( const K& obj, const Operation& op, int root ) const {
         assert( root != rank );
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, sizeof( K ) );
         m_impl->reduce( 1, &obj, nullptr, op, root );
     }
     // _________________________________________________________________
     template <typename K, typename Func>
     void Communicator::reduce( const K& obj, K& res, const Func& op, bool commute, int root ) const {
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, message_bytes( obj ) );
         m_impl->reduce( obj, &res, op, commute, root );
     }
     // .................................................................
     template <typename K, typename Func>
     void Communicator::reduce( const K& obj, const Func& op, bool commute, int root ) const {
         assert( root != rank );
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, message_bytes( obj ) );
         m_impl->reduce( obj, nullptr, op, commute, root );
     }
     // _________________________________________________________________
     template <typename K>
     void Communicator::reduce( std::size_t nbItems, const K* obj, K* res, Operation op, int root ) const {
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, nbItems * sizeof( K ) );
         m_impl->reduce( nbItems, obj, res, op, root );
     }
     // .................................................................
     template <typename K>
     void Communicator::reduce( std::size_t nbItems, const K* obj, Operation op, int root ) const {
         assert( rank != root );
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, nbItems * sizeof( K ) );
         m_impl->reduce( nbItems, obj, nullptr, op, root );
     }
     // _________________________________________________________________
     template <typename K, typename Func>
     void Communicator::reduce( std::size_t nbItems, const K* obj, K* res, const Func& op, bool commute,
                                int root ) const {
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, nbItems * sizeof( K ) );
         m_impl->reduce( nbItems, obj, res, op, commute, root );
     }
     // .................................................................
     template <typename K, typename Func>
     void Communicator::reduce( std::size_t nbItems, const K* obj, const Func& op, bool commute, int root ) const {
         assert( rank != root );
+        Tracer::Scope trace( *this, Tracer::reduce, root, 0, nbItems * sizeof( K ) );
         m_impl->reduce( nbItems, obj, nullptr, op, commute, root );
     }
     // =================================================================
     template <typename K>
     void Communicator::allreduce( const K& obj, K& res, const Operation& op ) const {
+        Tracer::Scope trace( *this, Tracer::allreduce, Tracer::all, 0, message_bytes( obj ) );
         m_impl->allreduce( obj, &res, op );
     }
     // _________________________________________________________________
     template <typename K, typename Func>
     void Communicator::allreduce( const K& obj, K& res, const Func& op, bool commute ) const {
+        Tracer::Scope trace( *this, Tracer::allreduce, Tracer::all, 0, message_bytes( obj ) );
         m_impl->allreduce( obj, &res, op, commute );
     }
     // _________________________________________________________________
     template <typename K>
     void Communicator::allreduce( std::size_t nbItems, const K* obj, K* res, Operation op ) const {
+        Tracer::Scope trace( *this, Tracer::allreduce, Tracer::all, 0, nbItems * sizeof( K ) );
         m_impl->allreduce( nbItems, obj, res, op );
     }
     // _________________________________________________________________
     template <typename K, typename Func>
     void Communicator::allreduce( std::size_t nbItems, const K* obj, K* res, const Func& op, bool commute ) const {
+        Tracer::Scope trace( *this, Tracer::allreduce, Tracer::all, 0, nbItems * sizeof( K ) );
         m_impl->allreduce( nbItems, obj, res, op, commute );
     }
+    // =================================================================
+    template <typename K>
+    void Communicator::gather( const K& obj, K* b_rcv, int root ) const {
+        Tracer::Scope trace( *this, Tracer::gather, root, 0, sizeof( K ) );
+        m_impl->gather( 1, &obj, b_rcv, root );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::gather( std::size_t nbObjs, const K* b_snd, K* b_rcv, int root ) const {
+        Tracer::Scope trace( *this, Tracer::gather, root, 0, nbObjs * sizeof( K ) );
+        m_impl->gather( nbObjs, b_snd, b_rcv, root );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::gatherv( std::size_t nbObjs, const K* b_snd, const std::vector<std::size_t>& counts, K* b_rcv,
+                                int root ) const {
+        Tracer::Scope trace( *this, Tracer::gather, root, 0, nbObjs * sizeof( K ) );
+        m_impl->gatherv( nbObjs, b_snd, counts, b_rcv, root );
+    }
+    // .................................................................
+    template <typename K>
+    std::vector<std::size_t> Communicator::gatherv( const K& snd, K& rcv, int root ) const {
+        Tracer::Scope trace( *this, Tracer::gather, root, 0, message_bytes( snd ) );
+        return m_impl->gatherv( snd, rcv, root );
+    }
+    // _________________________________________________________________
+    template <typename K>
+    void Communicator::scatter( const K* b_snd, K& obj, int root ) const {
+        Tracer::Scope trace( *this, Tracer::scatter, root, 0, sizeof( K ) );
+        m_impl->scatter( 1, b_snd, &obj, root );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::scatter( std::size_t nbObjs, const K* b_snd, K* b_rcv, int root ) const {
+        Tracer::Scope trace( *this, Tracer::scatter, root, 0, nbObjs * sizeof( K ) );
+        m_impl->scatter( nbObjs, b_snd, b_rcv, root );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::scatterv( const std::vector<std::size_t>& counts, const K* b_snd, std::size_t nbObjs, K* b_rcv,
+                                 int root ) const {
+        Tracer::Scope trace( *this, Tracer::scatter, root, counts, sizeof( K ) );
+        if ( rank != root ) trace.setBytes( nbObjs * sizeof( K ) );
+        m_impl->scatterv( counts, b_snd, nbObjs, b_rcv, root );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::scatterv( const K& snd, const std::vector<std::size_t>& counts, K& rcv, int root ) const {
+        Tracer::Scope trace( *this, Tracer::scatter, root, counts, sizeof( typename K::value_type ) );
+        m_impl->scatterv( snd, counts, rcv, root );
+        if ( rank != root ) trace.setBytes( message_bytes( rcv ) );
+    }
+    // _________________________________________________________________
+    template <typename K>
+    void Communicator::allgather( const K& obj, K* b_rcv ) const {
+        Tracer::Scope trace( *this, Tracer::allgather, Tracer::all, 0, sizeof( K ) );
+        m_impl->allgather( 1, &obj, b_rcv );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::allgather( std::size_t nbObjs, const K* b_snd, K* b_rcv ) const {
+        Tracer::Scope trace( *this, Tracer::allgather, Tracer::all, 0, nbObjs * sizeof( K ) );
+        m_impl->allgather( nbObjs, b_snd, b_rcv );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::allgatherv( std::size_t nbObjs, const K* b_snd, const std::vector<std::size_t>& counts,
+                                   K* b_rcv ) const {
+        Tracer::Scope trace( *this, Tracer::allgather, Tracer::all, 0, nbObjs * sizeof( K ) );
+        m_impl->allgatherv( nbObjs, b_snd, counts, b_rcv );
+    }
+    // .................................................................
+    template <typename K>
+    std::vector<std::size_t> Communicator::allgatherv( const K& snd, K& rcv ) const {
+        Tracer::Scope trace( *this, Tracer::allgather, Tracer::all, 0, message_bytes( snd ) );
+        return m_impl->allgatherv( snd, rcv );
+    }
+    // _________________________________________________________________
+    template <typename K>
+    void Communicator::alltoall( const K* b_snd, K* b_rcv ) const {
+        Tracer::Scope trace( *this, Tracer::alltoall, Tracer::all, 0, sizeof( K ) );
+        m_impl->alltoall( 1, b_snd, b_rcv );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::alltoall( std::size_t nbObjs, const K* b_snd, K* b_rcv ) const {
+        Tracer::Scope trace( *this, Tracer::alltoall, Tracer::all, 0, nbObjs * sizeof( K ) );
+        m_impl->alltoall( nbObjs, b_snd, b_rcv );
+    }
+    // .................................................................
+    template <typename K>
+    void Communicator::alltoallv( const std::vector<std::size_t>& snd_counts, const K* b_snd,
+                                  const std::vector<std::size_t>& rcv_counts, K* b_rcv ) const {
+        Tracer::Scope trace( *this, Tracer::alltoall, Tracer::all, snd_counts, sizeof( K ) );
+        m_impl->alltoallv( snd_counts, b_snd, rcv_counts, b_rcv );
+    }
+    // .................................................................
+    template <typename K>
+    std::vector<std::size_t> Communicator::alltoallv( const std::vector<std::size_t>& snd_counts, const K& snd,
+                                                      K& rcv ) const {
+        Tracer::Scope trace( *this, Tracer::alltoall, Tracer::all, snd_counts, sizeof( typename K::value_type ) );
+        return m_impl->alltoallv( snd_counts, snd, rcv );
+    }
+    // _________________________________________________________________
+    template <typename K>
+    std::map<int, std::vector<K>> Communicator::sparse_exchange( const std::map<int, std::vector<K>>& messages ) const {
+        static_assert( !Serialization::needs_serialization<K>::value,
+                       "The serialized objects are only sent by send and bcast" );
+        std::size_t bytes = 0;
+        for ( const auto& msg : messages ) bytes += msg.second.size( ) * sizeof( K );
+        Tracer::Scope trace( *this, Tracer::exchange, Tracer::all, 0, bytes );
+        return m_impl->sparse_exchange( messages );
+    }
 }
@@ -20,37 +20,339 @@
 #include "parallel/chronometer_implementation.hpp"
 #include "parallel/constantes.hpp"
 #include "parallel/context.hpp"
+#include "parallel/serialization.hpp"
 #include "parallel/status.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <mpi.h>
+#include <mutex>
+#include <stdexcept>
 
-#define BEGIN_PROFILE_COMMUNICATION                                                               \
-    if (m_pt_active_chrono != nullptr) {                                                          \
-        if (m_pt_active_chrono->m_pt_impl->is_activated) (*m_pt_active_chrono)[__func__].start(); \
-    }
+// The communications are measured by each thread, then added to the records of the chronometer
+#define BEGIN_PROFILE_COMMUNICATION \
+    Communicator::Chronometer::Implementation::Measure profile_measure(m_pt_active_chrono.load(), __func__);
 
-#define END_PROFILE_COMMUNICATION                                                                \
-    if (m_pt_active_chrono != nullptr) {                                                         \
-        if (m_pt_active_chrono->m_pt_impl->is_activated) (*m_pt_active_chrono)[__func__].stop(); \
-    }
+#define END_PROFILE_COMMUNICATION profile_measure.stop();
 
 namespace Parallel {
 namespace {
+// Free the MPI handles cached by the library when MPI_Finalize is called : the attributes of
+// MPI_COMM_SELF are deleted at the beginning of MPI_Finalize.
+inline int free_cached_op(MPI_Comm, int, void *op, void *) { return MPI_Op_free(static_cast<MPI_Op *>(op)); }
+inline int free_cached_type(MPI_Comm, int, void *tp, void *) { return MPI_Type_free(static_cast<MPI_Datatype *>(tp)); }
+template <typename Handle>
+void free_at_finalize(Handle *handle, MPI_Comm_delete_attr_function *free_function) {
+    int keyval;
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, free_function, &keyval, nullptr);
+    MPI_Comm_set_attr(MPI_COMM_SELF, keyval, handle);
+    MPI_Comm_free_keyval(&keyval);
+}
+// Datatype used by the reduction operations : the objects which must be packed are reduced as a
+// contiguous block of bytes, created once per type.
+template <typename K>
+MPI_Datatype reduce_type() {
+    if (!Type_MPI<K>::must_be_packed()) return Type_MPI<K>::mpi_type();
+    static MPI_Datatype packed_type = []() {
+        MPI_Datatype tp;
+        MPI_Type_contiguous(int(sizeof(K)), MPI_BYTE, &tp);
+        MPI_Type_commit(&tp);
+        return tp;
+    }();
+    static bool registered = (free_at_finalize(&packed_type, free_cached_type), true);
+    (void)registered;
+    return packed_type;
+}
+// User defined reduction operation for the type K and the functor type Func. The MPI operation is
+// created once per ( type, functor, commutativity ) and the combine loop calls the functor inline
+// on the whole buffer, so the compiler can vectorize it. The functor used is the one given by the
+// calling thread.
+template <typename K, typename Func>
+struct UserOperation {
+    static thread_local const Func *functor;
+    // ay <= op(ax, ay)
+    static void combine(void *x, void *y, int *length, MPI_Datatype *) {
+        const K *__restrict ax = static_cast<const K *>(x);
+        K *__restrict ay       = static_cast<K *>(y);
+        const Func &fct        = *functor;
+        const int nbItems      = *length;
+        for (int i = 0; i < nbItems; ++i) ay[i] = fct(ax[i], ay[i]);
+    }
+    static MPI_Op get(const Func &fct, bool commute) {
+        static MPI_Op ops[2] = {create(false), create(true)};
+        static bool registered =
+            (free_at_finalize(&ops[0], free_cached_op), free_at_finalize(&ops[1], free_cached_op), true);
+        (void)registered;
+        functor = &fct;
+        return ops[commute ? 1 : 0];
+    }
+
+  private:
+    static MPI_Op create(bool commute) {
+        MPI_Op op;
+        MPI_Op_create(combine, (commute ? 1 : 0), &op);
+        return op;
+    }
+};
+template <typename K, typename Func>
+thread_local const Func *UserOperation<K, Func>::functor = nullptr;
+// Datatype and number of elements used to transfer a buffer of objects ( objects which must
+// be packed are transfered as bytes )
 template <typename K>
-std::function<K(const K &, const K &)> reduce_functor;
-// ay <= accumulator
+inline MPI_Datatype buffer_type() {
+    return (Type_MPI<K>::must_be_packed() ? MPI_BYTE : Type_MPI<K>::mpi_type());
+}
+template <typename K>
+inline int buffer_count(std::size_t nbItems) {
+    return int(Type_MPI<K>::must_be_packed() ? nbItems * sizeof(K) : nbItems);
+}
 template <typename K>
-void reduce_user_function(void *x, void *y, int *length, MPI_Datatype *tp) {
-    K val;
-    K *ax = (K *)x;
-    K *ay = (K *)y;
-    for (int i = 0; i < *length; ++i) {
-        val   = reduce_functor<K>(ax[i], ay[i]);
-        ay[i] = val;
+inline std::size_t buffer_items(std::size_t nbItems) {
+    return (Type_MPI<K>::must_be_packed() ? nbItems * sizeof(K) : nbItems);
+}
+// Buffers of more than Communicator::maxCount() elements ( the counts of MPI are int ). With MPI 4,
+// the large count functions ( MPI_Send_c, ... ) are called. Otherwise, the buffer is described by
+// one element of a derived datatype made of blocks of maxCount() elements followed by the remaining
+// elements, and the reductions ( whose operations don't accept the derived datatypes ) are done by
+// successive calls on maxCount() elements.
+#if MPI_VERSION >= 4
+#define PARALLEL_LARGE_COUNT_FUNCTIONS
+#endif
+class LargeBuffer {
+  public:
+    LargeBuffer(std::size_t nbItems, MPI_Datatype base) : m_count(int(nbItems)), m_type(base) {
+        const std::size_t max_count = Communicator::maxCount();
+        if (nbItems <= max_count) return;
+        const std::size_t nb_blocks = nbItems / max_count, remainder = nbItems % max_count;
+        MPI_Datatype block, blocks;
+        MPI_Type_contiguous(int(max_count), base, &block);
+        MPI_Type_contiguous(int(nb_blocks), block, &blocks);
+        if (remainder == 0)
+            m_type = blocks;
+        else {
+            MPI_Aint lb, extent;
+            MPI_Type_get_extent(base, &lb, &extent);
+            MPI_Datatype rest;
+            MPI_Type_contiguous(int(remainder), base, &rest);
+            int lengths[2]         = {1, 1};
+            MPI_Aint displs[2]     = {0, MPI_Aint(nb_blocks * max_count) * extent};
+            MPI_Datatype types[2]  = {blocks, rest};
+            MPI_Type_create_struct(2, lengths, displs, types, &m_type);
+            MPI_Type_free(&blocks);
+            MPI_Type_free(&rest);
+        }
+        MPI_Type_free(&block);
+        MPI_Type_commit(&m_type);
+        m_count = 1;
+        m_owned = true;
+    }
+    LargeBuffer(const LargeBuffer &) = delete;
+    LargeBuffer &operator=(const LargeBuffer &) = delete;
+    // The pending communications using the datatype complete normally after MPI_Type_free
+    ~LargeBuffer() {
+        if (m_owned) MPI_Type_free(&m_type);
+    }
+    int count() const { return m_count; }
+    MPI_Datatype type() const { return m_type; }
+
+  private:
+    int m_count;
+    MPI_Datatype m_type;
+    bool m_owned = false;
+};
+inline bool is_large(std::size_t nbItems) { return nbItems > Communicator::maxCount(); }
+// .................................................................................................
+inline void large_send(const void *buf, std::size_t nbItems, MPI_Datatype tp, int dest, int tag, MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Send_c(buf, MPI_Count(nbItems), tp, dest, tag, com);
+        return;
+    }
+#endif
+    LargeBuffer large(nbItems, tp);
+    MPI_Send(buf, large.count(), large.type(), dest, tag, com);
+}
+inline void large_isend(const void *buf, std::size_t nbItems, MPI_Datatype tp, int dest, int tag, MPI_Comm com,
+                        MPI_Request *req) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Isend_c(buf, MPI_Count(nbItems), tp, dest, tag, com, req);
+        return;
+    }
+#endif
+    LargeBuffer large(nbItems, tp);
+    MPI_Isend(buf, large.count(), large.type(), dest, tag, com, req);
+}
+inline void large_issend(const void *buf, std::size_t nbItems, MPI_Datatype tp, int dest, int tag, MPI_Comm com,
+                         MPI_Request *req) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Issend_c(buf, MPI_Count(nbItems), tp, dest, tag, com, req);
+        return;
+    }
+#endif
+    LargeBuffer large(nbItems, tp);
+    MPI_Issend(buf, large.count(), large.type(), dest, tag, com, req);
+}
+inline void large_recv(void *buf, std::size_t nbItems, MPI_Datatype tp, int sender, int tag, MPI_Comm com,
+                       MPI_Status *status) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Recv_c(buf, MPI_Count(nbItems), tp, sender, tag, com, status);
+        return;
+    }
+#endif
+    LargeBuffer large(nbItems, tp);
+    MPI_Recv(buf, large.count(), large.type(), sender, tag, com, status);
+}
+inline void large_irecv(void *buf, std::size_t nbItems, MPI_Datatype tp, int sender, int tag, MPI_Comm com,
+                        MPI_Request *req) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Irecv_c(buf, MPI_Count(nbItems), tp, sender, tag, com, req);
+        return;
     }
+#endif
+    LargeBuffer large(nbItems, tp);
+    MPI_Irecv(buf, large.count(), large.type(), sender, tag, com, req);
+}
+inline void large_bcast(void *buf, std::size_t nbItems, MPI_Datatype tp, int root, MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Bcast_c(buf, MPI_Count(nbItems), tp, root, com);
+        return;
+    }
+#endif
+    LargeBuffer large(nbItems, tp);
+    MPI_Bcast(buf, large.count(), large.type(), root, com);
+}
+inline void large_ibcast(void *buf, std::size_t nbItems, MPI_Datatype tp, int root, MPI_Comm com, MPI_Request *req) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Ibcast_c(buf, MPI_Count(nbItems), tp, root, com, req);
+        return;
+    }
+#endif
+    LargeBuffer large(nbItems, tp);
+    MPI_Ibcast(buf, large.count(), large.type(), root, com, req);
+}
+// Address of the chunk beginning at offset bytes ( MPI_IN_PLACE and the null buffers are kept )
+inline const void *chunk(const void *buf, std::size_t offset) {
+    return ((buf == MPI_IN_PLACE) || (buf == nullptr) ? buf : static_cast<const char *>(buf) + offset);
+}
+inline void *chunk(void *buf, std::size_t offset) {
+    return ((buf == MPI_IN_PLACE) || (buf == nullptr) ? buf : static_cast<char *>(buf) + offset);
+}
+inline void large_reduce(const void *snd, void *rcv, std::size_t nbItems, MPI_Datatype tp, MPI_Op op, int root,
+                         MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Reduce_c(snd, rcv, MPI_Count(nbItems), tp, op, root, com);
+        return;
+    }
+#endif
+    const std::size_t max_count = Communicator::maxCount();
+    MPI_Aint lb, extent;
+    MPI_Type_get_extent(tp, &lb, &extent);
+    std::size_t beg = 0;
+    do {
+        std::size_t nb = std::min(max_count, nbItems - beg), offset = beg * std::size_t(extent);
+        MPI_Reduce(chunk(snd, offset), chunk(rcv, offset), int(nb), tp, op, root, com);
+        beg += nb;
+    } while (beg < nbItems);
+}
+inline void large_allreduce(const void *snd, void *rcv, std::size_t nbItems, MPI_Datatype tp, MPI_Op op,
+                            MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (is_large(nbItems)) {
+        MPI_Allreduce_c(snd, rcv, MPI_Count(nbItems), tp, op, com);
+        return;
+    }
+#endif
+    const std::size_t max_count = Communicator::maxCount();
+    MPI_Aint lb, extent;
+    MPI_Type_get_extent(tp, &lb, &extent);
+    std::size_t beg = 0;
+    do {
+        std::size_t nb = std::min(max_count, nbItems - beg), offset = beg * std::size_t(extent);
+        MPI_Allreduce(chunk(snd, offset), chunk(rcv, offset), int(nb), tp, op, com);
+        beg += nb;
+    } while (beg < nbItems);
+}
+// Number of elements of type tp in the message described by status
+inline std::size_t received_count(const MPI_Status &status, MPI_Datatype tp) {
+    MPI_Count count;
+    MPI_Get_elements_x(&status, tp, &count);
+    return std::size_t(count);
+}
+// Counts and displacements of the v-collective operations : MPI_Count and MPI_Aint with the large
+// count functions. Otherwise they are int, and a count or a displacement over maxCount() elements
+// throws std::overflow_error ( on the processes which know it ).
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+using VCount = MPI_Count;
+using VDispl = MPI_Aint;
+#else
+using VCount = int;
+using VDispl = int;
+#endif
+inline VCount v_count(std::size_t count) {
+#if !defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    if (count > Communicator::maxCount())
+        throw std::overflow_error("Too many elements for a v-collective operation without the large count functions");
+#endif
+    return VCount(count);
+}
+// Convert a number of objects per process in counts and displacements for the v-collective operations
+template <typename K>
+void counts_and_displacements(const std::vector<std::size_t> &counts, std::vector<VCount> &mpi_counts,
+                              std::vector<VDispl> &displs) {
+    mpi_counts.resize(counts.size());
+    displs.resize(counts.size());
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        const std::size_t count = buffer_items<K>(counts[i]);
+        mpi_counts[i]           = v_count(count);
+        displs[i]               = VDispl(v_count(offset));
+        offset += count;
+    }
+}
+inline void large_gatherv(const void *snd, std::size_t nbItems, void *rcv, const std::vector<VCount> &counts,
+                          const std::vector<VDispl> &displs, MPI_Datatype tp, int root, MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    MPI_Gatherv_c(snd, v_count(nbItems), tp, rcv, counts.data(), displs.data(), tp, root, com);
+#else
+    MPI_Gatherv(snd, v_count(nbItems), tp, rcv, counts.data(), displs.data(), tp, root, com);
+#endif
+}
+inline void large_scatterv(const void *snd, const std::vector<VCount> &counts, const std::vector<VDispl> &displs,
+                           void *rcv, std::size_t nbItems, MPI_Datatype tp, int root, MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    MPI_Scatterv_c(snd, counts.data(), displs.data(), tp, rcv, v_count(nbItems), tp, root, com);
+#else
+    MPI_Scatterv(snd, counts.data(), displs.data(), tp, rcv, v_count(nbItems), tp, root, com);
+#endif
+}
+inline void large_allgatherv(const void *snd, std::size_t nbItems, void *rcv, const std::vector<VCount> &counts,
+                             const std::vector<VDispl> &displs, MPI_Datatype tp, MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    MPI_Allgatherv_c(snd, v_count(nbItems), tp, rcv, counts.data(), displs.data(), tp, com);
+#else
+    MPI_Allgatherv(snd, v_count(nbItems), tp, rcv, counts.data(), displs.data(), tp, com);
+#endif
+}
+inline void large_alltoallv(const void *snd, const std::vector<VCount> &snd_counts,
+                            const std::vector<VDispl> &snd_displs, void *rcv, const std::vector<VCount> &rcv_counts,
+                            const std::vector<VDispl> &rcv_displs, MPI_Datatype tp, MPI_Comm com) {
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    MPI_Alltoallv_c(snd, snd_counts.data(), snd_displs.data(), tp, rcv, rcv_counts.data(), rcv_displs.data(), tp,
+                    com);
+#else
+    MPI_Alltoallv(snd, snd_counts.data(), snd_displs.data(), tp, rcv, rcv_counts.data(), rcv_displs.data(), tp, com);
+#endif
 }
 }
 // #################################################################################################
@@ -61,6 +363,11 @@ struct Communicator::Implementation {
         MPI_Comm_split(impl.m_communicator, color, key, &m_communicator);
     }
     // ...............................................................................................
+    // Split by type of processes ( MPI_COMM_TYPE_SHARED : processes of the same node )
+    Implementation(const Implementation &impl, int split_type) : m_pt_active_chrono(nullptr) {
+        MPI_Comm_split_type(impl.m_communicator, split_type, impl.getRank(), MPI_INFO_NULL, &m_communicator);
+    }
+    // ...............................................................................................
     Implementation(const Implementation &impl) : m_pt_active_chrono(nullptr) {
         MPI_Comm_dup(impl.m_communicator, &m_communicator);
     }
@@ -69,7 +376,11 @@ struct Communicator::Implementation {
         MPI_Comm_dup(excom, &m_communicator);
     }
     // ...............................................................................................
-    ~Implementation() { MPI_Comm_free(&m_communicator); }
+    ~Implementation() {
+        if (m_collective_communicator != MPI_COMM_NULL) MPI_Comm_free(&m_collective_communicator);
+        if (m_sparse_communicator != MPI_COMM_NULL) MPI_Comm_free(&m_sparse_communicator);
+        MPI_Comm_free(&m_communicator);
+    }
     // -----------------------------------------------------------------------------------------------
     int getRank() const {
         int rank;
@@ -84,6 +395,22 @@ struct Communicator::Implementation {
         MPI_Group_translate_ranks(group1, nbRanks, ranks, group2, tr_ranks);
     }
     // ...............................................................................................
+    int world_rank(int rk) const {
+        std::call_once(m_world_ranks_flag, [this]() {
+            const int size = getSize();
+            std::vector<int> ranks(size);
+            for (int i = 0; i < size; ++i) ranks[i] = i;
+            m_world_ranks.resize(size);
+            MPI_Group group, world;
+            MPI_Comm_group(m_communicator, &group);
+            MPI_Comm_group(MPI_COMM_WORLD, &world);
+            MPI_Group_translate_ranks(group, size, ranks.data(), world, m_world_ranks.data());
+            MPI_Group_free(&group);
+            MPI_Group_free(&world);
+        });
+        return m_world_ranks[rk];
+    }
+    // ...............................................................................................
     int getSize() const {
         int size;
         MPI_Comm_size(m_communicator, &size);
@@ -92,6 +419,82 @@ struct Communicator::Implementation {
     // ...............................................................................................
     const Ext_Communicator &get_ext_comm() const { return m_communicator; }
     // ...............................................................................................
+    Implementation *split_shared() const { return new Implementation(*this, MPI_COMM_TYPE_SHARED); }
+    // ...............................................................................................
+    // Communicator used for the point to point messages of the collective algorithms, so they can't
+    // match the messages of the user. Must be called collectively the first time.
+    const MPI_Comm &collective_communicator() const {
+        if (m_collective_communicator == MPI_COMM_NULL) MPI_Comm_dup(m_communicator, &m_collective_communicator);
+        return m_collective_communicator;
+    }
+    // Communicator of the sparse exchanges, which probe any source
+    const MPI_Comm &sparse_communicator() const {
+        if (m_sparse_communicator == MPI_COMM_NULL) MPI_Comm_dup(m_communicator, &m_sparse_communicator);
+        return m_sparse_communicator;
+    }
+    // ...............................................................................................
+    void set_pipelined_broadcast(std::size_t threshold, std::size_t segment_size, Communicator::BroadcastTree tree) {
+        m_pipeline_threshold = threshold;
+        m_pipeline_segment   = segment_size;
+        m_pipeline_tree      = tree;
+    }
+    void set_compression(std::size_t threshold) { m_compression_threshold = threshold; }
+    std::size_t compression_threshold() const { return m_compression_threshold; }
+    // ...............................................................................................
+    // Two level collectives : the processes of a node, and the leaders ( rank 0 in the node ) of the
+    // nodes. The nodes are the shared memory nodes, or groups of ranks_per_node consecutive ranks.
+    struct Hierarchy {
+        MPI_Comm node = MPI_COMM_NULL, leaders = MPI_COMM_NULL;
+        int node_rank, nb_nodes;
+        std::vector<int> leader_of, node_rank_of; // Rank of the leader of the node and rank in the node
+        Hierarchy(const MPI_Comm &com, int ranks_per_node) {
+            int rank, size;
+            MPI_Comm_rank(com, &rank);
+            MPI_Comm_size(com, &size);
+            if (ranks_per_node > 0)
+                MPI_Comm_split(com, rank / ranks_per_node, rank, &node);
+            else
+                MPI_Comm_split_type(com, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+            MPI_Comm_rank(node, &node_rank);
+            MPI_Comm_split(com, (node_rank == 0 ? 0 : MPI_UNDEFINED), rank, &leaders);
+            int leader = -1;
+            if (leaders != MPI_COMM_NULL) MPI_Comm_rank(leaders, &leader);
+            MPI_Bcast(&leader, 1, MPI_INT, 0, node);
+            int loc[2] = {leader, node_rank};
+            std::vector<int> all(2 * size);
+            MPI_Allgather(loc, 2, MPI_INT, all.data(), 2, MPI_INT, com);
+            leader_of.resize(size);
+            node_rank_of.resize(size);
+            for (int r = 0; r < size; ++r) {
+                leader_of[r]    = all[2 * r];
+                node_rank_of[r] = all[2 * r + 1];
+            }
+            nb_nodes = *std::max_element(leader_of.begin(), leader_of.end()) + 1;
+        }
+        Hierarchy(const Hierarchy &) = delete;
+        Hierarchy &operator=(const Hierarchy &) = delete;
+        ~Hierarchy() {
+            if (leaders != MPI_COMM_NULL) MPI_Comm_free(&leaders);
+            MPI_Comm_free(&node);
+        }
+    };
+    void set_hierarchical_collectives(std::size_t threshold, int ranks_per_node) {
+        m_hierarchy_threshold = threshold;
+        if (ranks_per_node != m_ranks_per_node) m_hierarchy.reset();
+        m_ranks_per_node = ranks_per_node;
+    }
+    // Built by the first two level collective operation
+    const Hierarchy &hierarchy() const {
+        if (!m_hierarchy) m_hierarchy.reset(new Hierarchy(m_communicator, m_ranks_per_node));
+        return *m_hierarchy;
+    }
+    // The two level algorithms pay when there are several nodes holding several processes
+    bool use_hierarchy(std::size_t nbBytes) const {
+        if (nbBytes < m_hierarchy_threshold) return false;
+        const Hierarchy &h = hierarchy();
+        return (h.nb_nodes > 1) && (h.nb_nodes < getSize());
+    }
+    // ...............................................................................................
     Status probe(int src, int tag) const {
         BEGIN_PROFILE_COMMUNICATION
         Status status;
@@ -216,9 +619,9 @@ struct Communicator::Implementation {
     void send(std::size_t nbItems, const K *sndbuff, int dest, int tag) const {
         BEGIN_PROFILE_COMMUNICATION
         if (Type_MPI<K>::must_be_packed()) {
-            MPI_Send(sndbuff, nbItems * sizeof(K), MPI_BYTE, dest, tag, m_communicator);
+            large_send(sndbuff, nbItems * sizeof(K), MPI_BYTE, dest, tag, m_communicator);
         } else {
-            MPI_Send(sndbuff, nbItems, Type_MPI<K>::mpi_type(), dest, tag, m_communicator);
+            large_send(sndbuff, nbItems, Type_MPI<K>::mpi_type(), dest, tag, m_communicator);
 #if defined(PARALLEL_TRACE)
             Core::Logger log;
             log << LogTrace << "Send a message using buffer at " << (void *)sndbuff << " for " << dest << " with tag "
@@ -234,15 +637,40 @@ struct Communicator::Implementation {
         Communication<K, is_container<K>::value>::send(m_communicator, snd, dest, tag);
         END_PROFILE_COMMUNICATION
     }
+    // ...........................................................................................
+    // Stream of a serialized object : a lone part is sent from its own buffer, several parts as one
+    // message without copy ( a derived datatype of their absolute addresses ), or copied in one
+    // buffer for a too large message
+    void send_parts(const Serialization::OutputArchive &archive, int dest, int tag) const {
+        const auto &parts = archive.parts();
+        if (parts.size() == 1) return send(parts[0].size, parts[0].data, dest, tag);
+        if ((parts.size() < 2) || (archive.size() > Communicator::maxCount())) {
+            std::vector<char> stream = archive.contiguous();
+            return send(stream.size(), stream.data(), dest, tag);
+        }
+        BEGIN_PROFILE_COMMUNICATION
+        std::vector<int> lengths(parts.size());
+        std::vector<MPI_Aint> displacements(parts.size());
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            lengths[i] = int(parts[i].size);
+            MPI_Get_address(parts[i].data, &displacements[i]);
+        }
+        MPI_Datatype type;
+        MPI_Type_create_hindexed(int(parts.size()), lengths.data(), displacements.data(), buffer_type<char>(), &type);
+        MPI_Type_commit(&type);
+        MPI_Send(MPI_BOTTOM, 1, type, dest, tag, m_communicator);
+        MPI_Type_free(&type);
+        END_PROFILE_COMMUNICATION
+    }
     // -------------------------------------------------------------------------------------------
     template <typename K>
     Request isend(std::size_t nbItems, const K *sndbuff, int dest, int tag) const {
         BEGIN_PROFILE_COMMUNICATION
         MPI_Request m_req;
         if (Type_MPI<K>::must_be_packed()) {
-            MPI_Isend(sndbuff, nbItems * sizeof(K), MPI_BYTE, dest, tag, m_communicator, &m_req);
+            large_isend(sndbuff, nbItems * sizeof(K), MPI_BYTE, dest, tag, m_communicator, &m_req);
         } else {
-            MPI_Isend(sndbuff, nbItems, Type_MPI<K>::mpi_type(), dest, tag, m_communicator, &m_req);
+            large_isend(sndbuff, nbItems, Type_MPI<K>::mpi_type(), dest, tag, m_communicator, &m_req);
 #if defined(PARALLEL_TRACE)
             Core::Logger log;
             log << LogTrace << Core::Logger::Blue << "Sended a buffer at adress " << (void *)sndbuff << " for " << dest
@@ -268,7 +696,7 @@ struct Communicator::Implementation {
         BEGIN_PROFILE_COMMUNICATION
         Status status;
         if (Type_MPI<K>::must_be_packed()) {
-            MPI_Recv(rcvbuff, nbItems * sizeof(K), MPI_BYTE, sender, tag, m_communicator, &status.status);
+            large_recv(rcvbuff, nbItems * sizeof(K), MPI_BYTE, sender, tag, m_communicator, &status.status);
         } else {
 #if defined(PARALLEL_TRACE)
             Core::Logger log;
@@ -276,7 +704,7 @@ struct Communicator::Implementation {
                 << " coming from " << sender << " with tag " << tag << " containing " << nbItems << " items."
                 << Core::Logger::DefaultColor << std::endl;
 #endif
-            MPI_Recv(rcvbuff, nbItems, Type_MPI<K>::mpi_type(), sender, tag, m_communicator, &status.status);
+            large_recv(rcvbuff, nbItems, Type_MPI<K>::mpi_type(), sender, tag, m_communicator, &status.status);
 #if defined(PARALLEL_TRACE)
             log << LogTrace << "Receive ok !" << std::endl;
 #endif
@@ -298,7 +726,7 @@ struct Communicator::Implementation {
         BEGIN_PROFILE_COMMUNICATION
         MPI_Request req;
         if (Type_MPI<K>::must_be_packed()) {
-            MPI_Irecv(rcvbuff, nbItems * sizeof(K), MPI_BYTE, sender, tag, m_communicator, &req);
+            large_irecv(rcvbuff, nbItems * sizeof(K), MPI_BYTE, sender, tag, m_communicator, &req);
         } else {
 #if defined(PARALLEL_TRACE)
             Core::Logger log;
@@ -306,7 +734,7 @@ struct Communicator::Implementation {
                 << " with non blocking message coming from " << sender << " with tag " << tag << " containing "
                 << nbItems << " items." << std::endl;
 #endif
-            MPI_Irecv(rcvbuff, nbItems, Type_MPI<K>::mpi_type(), sender, tag, m_communicator, &req);
+            large_irecv(rcvbuff, nbItems, Type_MPI<K>::mpi_type(), sender, tag, m_communicator, &req);
         }
         END_PROFILE_COMMUNICATION
         return Request(req);
@@ -329,8 +757,17 @@ struct Communicator::Implementation {
         log << LogTrace << Core::Logger::Cyan << "Broadcast " << nbItems << " objects at adress " << (void *)bufsnd
             << " to adress " << (void *)bufrcv << " with root = " << root << Core::Logger::Normal << std::endl;
 #endif
-        MPI_Barrier(m_communicator);
         assert(bufrcv != nullptr);
+        if (use_hierarchy(nbItems * sizeof(K))) {
+            END_PROFILE_COMMUNICATION
+            hierarchical_broadcast(nbItems, bufsnd, bufrcv, root);
+            return;
+        }
+        if (nbItems * sizeof(K) >= m_pipeline_threshold) {
+            END_PROFILE_COMMUNICATION
+            pipelined_broadcast(nbItems, bufsnd, bufrcv, root, m_pipeline_segment, m_pipeline_tree);
+            return;
+        }
         if (root == getRank()) {
             assert(bufsnd != nullptr);
             if (bufsnd != bufrcv) {
@@ -341,14 +778,98 @@ struct Communicator::Implementation {
             }
         }
         if (Type_MPI<K>::must_be_packed()) {
-            MPI_Bcast(bufrcv, nbItems * sizeof(K), MPI_BYTE, root, m_communicator);
+            large_bcast(bufrcv, nbItems * sizeof(K), MPI_BYTE, root, m_communicator);
         } else {
 #if defined(PARALLEL_TRACE)
             log << "Unpacked buffer to broadcast : " << nbItems << " data with root : " << root << std::endl;
 #endif
-            MPI_Bcast(bufrcv, nbItems, Type_MPI<K>::mpi_type(), root, m_communicator);
+            large_bcast(bufrcv, nbItems, Type_MPI<K>::mpi_type(), root, m_communicator);
+        }
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    // Broadcast splitting the buffer in segments of segment_size bytes. The segments are pipelined
+    // down a chain or a binary tree rooted on root : each process forwards a segment to its children
+    // with non blocking sends as soon as it has received it from its parent. All the segments have the
+    // same tag : the messages between two processes on the private communicator aren't overtaken, so
+    // the segments are received in order ( and their number isn't bounded by MPI_TAG_UB ).
+    template <typename K>
+    void pipelined_broadcast(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root, std::size_t segment_size,
+                             Communicator::BroadcastTree tree) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Pipelined broadcast of " << nbItems << " objects with root = " << root
+            << " and segments of " << segment_size << " bytes" << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufrcv != nullptr);
+        const int rank = getRank(), size = getSize();
+        if (root == rank) {
+            assert(bufsnd != nullptr);
+            if (bufsnd != bufrcv) std::copy_n(bufsnd, nbItems, bufrcv);
+        }
+        if (size > 1) {
+            // Ranks relative to the root of the tree :
+            const int rel_rank = (rank - root + size) % size;
+            int parent         = -1;
+            std::vector<int> children;
+            if (tree == Communicator::BroadcastTree::chain) {
+                if (rel_rank > 0) parent = rel_rank - 1;
+                if (rel_rank + 1 < size) children.push_back(rel_rank + 1);
+            } else {
+                if (rel_rank > 0) parent = (rel_rank - 1) / 2;
+                for (int child = 2 * rel_rank + 1; child <= std::min(2 * rel_rank + 2, size - 1); ++child)
+                    children.push_back(child);
+            }
+            if (parent >= 0) parent = (parent + root) % size;
+            for (auto &child : children) child = (child + root) % size;
+
+            const std::size_t items_per_segment = std::max(std::size_t(1), segment_size / sizeof(K));
+            const std::size_t nb_segments       = (nbItems + items_per_segment - 1) / items_per_segment;
+            const MPI_Comm &com                 = collective_communicator();
+            std::vector<MPI_Request> rcv_reqs(parent >= 0 ? nb_segments : 0);
+            std::vector<MPI_Request> snd_reqs;
+            snd_reqs.reserve(nb_segments * children.size());
+            for (std::size_t iseg = 0; iseg < rcv_reqs.size(); ++iseg) {
+                std::size_t beg = iseg * items_per_segment;
+                std::size_t nb  = std::min(items_per_segment, nbItems - beg);
+                MPI_Irecv(bufrcv + beg, buffer_count<K>(nb), buffer_type<K>(), parent, 0, com, &rcv_reqs[iseg]);
+            }
+            for (std::size_t iseg = 0; iseg < nb_segments; ++iseg) {
+                std::size_t beg = iseg * items_per_segment;
+                std::size_t nb  = std::min(items_per_segment, nbItems - beg);
+                if (parent >= 0) MPI_Wait(&rcv_reqs[iseg], MPI_STATUS_IGNORE);
+                for (int child : children) {
+                    snd_reqs.emplace_back();
+                    MPI_Isend(bufrcv + beg, buffer_count<K>(nb), buffer_type<K>(), child, 0, com, &snd_reqs.back());
+                }
+            }
+            MPI_Waitall(int(snd_reqs.size()), snd_reqs.data(), MPI_STATUSES_IGNORE);
         }
-        MPI_Barrier(m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void hierarchical_broadcast(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufrcv != nullptr);
+        const int rank = getRank();
+        if (root == rank) {
+            assert(bufsnd != nullptr);
+            if (bufsnd != bufrcv) std::copy_n(bufsnd, nbItems, bufrcv);
+        }
+        const Hierarchy &h      = hierarchy();
+        const std::size_t count = (Type_MPI<K>::must_be_packed() ? nbItems * sizeof(K) : nbItems);
+        // The root gives the buffer to the leader of its node, which broadcasts it to the other leaders,
+        // then each leader broadcasts it in its node
+        if (h.node_rank_of[root] != 0) {
+            if (rank == root)
+                large_send(bufrcv, count, buffer_type<K>(), 0, 0, h.node);
+            else if ((h.node_rank == 0) && (h.leader_of[rank] == h.leader_of[root]))
+                large_recv(bufrcv, count, buffer_type<K>(), h.node_rank_of[root], 0, h.node, MPI_STATUS_IGNORE);
+        }
+        if (h.leaders != MPI_COMM_NULL) large_bcast(bufrcv, count, buffer_type<K>(), h.leader_of[root], h.leaders);
+        large_bcast(bufrcv, count, buffer_type<K>(), 0, h.node);
         END_PROFILE_COMMUNICATION
     }
     // .........................................................................................
@@ -367,10 +888,11 @@ struct Communicator::Implementation {
             assert(bufsnd != nullptr);
             if (bufsnd != bufrcv) std::copy_n(bufsnd, nbItems, bufrcv);
         }
-        Request req;
-        MPI_Ibcast(bufrcv, nbItems, Type_MPI<K>::mpi_type(), root, m_communicator, &req);
+        MPI_Request req;
+        large_ibcast(bufrcv, (Type_MPI<K>::must_be_packed() ? nbItems * sizeof(K) : nbItems), buffer_type<K>(), root,
+                     m_communicator, &req);
         END_PROFILE_COMMUNICATION
-        return req;
+        return Request(req);
     }
     // -----------------------------------------------------------------------------------------
     void barrier() const {
@@ -402,16 +924,52 @@ struct Communicator::Implementation {
         log << LogTrace << Core::Logger::Cyan << " Reduce operation for " << nbItems << " items with root " << root
             << std::endl;
 #endif
+        if (use_hierarchy(nbItems * sizeof(K))) {
+            hierarchical_reduce(nbItems, objs, res, op, root);
+            return;
+        }
         BEGIN_PROFILE_COMMUNICATION
         assert(objs != nullptr);
         if (root == getRank()) {
             assert(res != nullptr);
             if (objs == res) {
-                MPI_Reduce(MPI_IN_PLACE, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
+                large_reduce(MPI_IN_PLACE, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
             } else {
-                MPI_Reduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
+                large_reduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
             }
+        } else
+            large_reduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    // Reduction in each node, then between the leaders of the nodes
+    template <typename K>
+    void hierarchical_reduce(std::size_t nbItems, const K *objs, K *res, Operation op, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(objs != nullptr);
+        const int rank     = getRank();
+        const Hierarchy &h = hierarchy();
+        const MPI_Datatype tp = Type_MPI<K>::mpi_type();
+        std::vector<K> partial(h.node_rank == 0 ? nbItems : 0);
+        large_reduce(objs, partial.data(), nbItems, tp, op, 0, h.node);
+        if (h.leaders != MPI_COMM_NULL) {
+            int leader_rank;
+            MPI_Comm_rank(h.leaders, &leader_rank);
+            if (leader_rank == h.leader_of[root])
+                large_reduce(MPI_IN_PLACE, partial.data(), nbItems, tp, op, leader_rank, h.leaders);
+            else
+                large_reduce(partial.data(), nullptr, nbItems, tp, op, h.leader_of[root], h.leaders);
         }
+        if (h.node_rank_of[root] == 0) {
+            if (rank == root) {
+                assert(res != nullptr);
+                std::copy(partial.begin(), partial.end(), res);
+            }
+        } else if (rank == root) {
+            assert(res != nullptr);
+            large_recv(res, nbItems, tp, 0, 0, h.node, MPI_STATUS_IGNORE);
+        } else if ((h.node_rank == 0) && (h.leader_of[rank] == h.leader_of[root]))
+            large_send(partial.data(), nbItems, tp, h.node_rank_of[root], 0, h.node);
         END_PROFILE_COMMUNICATION
     }
     // .........................................................................................
@@ -431,34 +989,34 @@ struct Communicator::Implementation {
 #endif
         BEGIN_PROFILE_COMMUNICATION
         assert(objs != nullptr);
-        reduce_functor<K> = std::function<K(const K &, const K &)>(fct);
-
-        MPI_Op op;
-        MPI_Op_create(reduce_user_function<K>, (commute ? 1 : 0), &op);
-
+        MPI_Op op = UserOperation<K, F>::get(fct, commute);
         if (root == getRank()) {
             assert(res != nullptr);
             if (objs == res) {
-                MPI_Reduce(MPI_IN_PLACE, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
+                large_reduce(MPI_IN_PLACE, res, nbItems, reduce_type<K>(), op, root, m_communicator);
             } else {
-                MPI_Reduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
+                large_reduce(objs, res, nbItems, reduce_type<K>(), op, root, m_communicator);
             }
         } else
-            MPI_Reduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, root, m_communicator);
-        MPI_Op_free(&op);
+            large_reduce(objs, res, nbItems, reduce_type<K>(), op, root, m_communicator);
         END_PROFILE_COMMUNICATION
     }
     // .........................................................................................
+    // For a container, the functor reduces the values of the container one by one
     template <typename K, typename F>
-    void reduce(const K &loc, K *glob, const F &fct, bool is_commuting, int root) const {
-        reduce_functor<K> = std::function<K(const K &, const K &)>(fct);
-
-        MPI_Op op;
-        MPI_Op_create(reduce_user_function<K>, (is_commuting ? 1 : 0), &op);
-
-        Communication<K, is_container<K>::value>::reduce(m_communicator, loc, glob, op, root);
-
-        MPI_Op_free(&op);
+    void reduce(const K &loc, K *glob, const F &fct, bool is_commuting, int root) {
+        reduce(loc, glob, fct, is_commuting, root, std::integral_constant<bool, is_container<K>::value>());
+    }
+    template <typename K, typename F>
+    void reduce(const K &loc, K *glob, const F &fct, bool is_commuting, int root, std::false_type) {
+        reduce(1, &loc, glob, fct, is_commuting, root);
+    }
+    template <typename K, typename F>
+    void reduce(const K &loc, K *glob, const F &fct, bool is_commuting, int root, std::true_type) const {
+        BEGIN_PROFILE_COMMUNICATION
+        MPI_Op op = UserOperation<typename K::value_type, F>::get(fct, is_commuting);
+        Communication<K, true>::reduce(m_communicator, loc, glob, op, root);
+        END_PROFILE_COMMUNICATION
     }
     // ====================================================================================================
     template <typename K>
@@ -468,16 +1026,37 @@ struct Communicator::Implementation {
         log << LogTrace << Core::Logger::Cyan << "AllReduce operation on " << nbItems << " objects, stored at adress "
             << (void *)objs << Core::Logger::Normal << std::endl;
 #endif
+        if (use_hierarchy(nbItems * sizeof(K))) {
+            hierarchical_allreduce(nbItems, objs, res, op);
+            return;
+        }
         BEGIN_PROFILE_COMMUNICATION
         assert(objs != nullptr);
         if (objs == res) {
-            MPI_Allreduce(MPI_IN_PLACE, res, nbItems, Type_MPI<K>::mpi_type(), op, m_communicator);
+            large_allreduce(MPI_IN_PLACE, res, nbItems, Type_MPI<K>::mpi_type(), op, m_communicator);
         } else {
-            MPI_Allreduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, m_communicator);
+            large_allreduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, m_communicator);
         }
         END_PROFILE_COMMUNICATION
     }
     // .........................................................................................
+    // Reduction in each node, then between the leaders of the nodes, then broadcast in each node
+    template <typename K>
+    void hierarchical_allreduce(std::size_t nbItems, const K *objs, K *res, Operation op) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(objs != nullptr);
+        assert(res != nullptr);
+        const Hierarchy &h    = hierarchy();
+        const MPI_Datatype tp = Type_MPI<K>::mpi_type();
+        if (h.node_rank == 0) {
+            large_reduce((objs == res ? MPI_IN_PLACE : objs), res, nbItems, tp, op, 0, h.node);
+            large_allreduce(MPI_IN_PLACE, res, nbItems, tp, op, h.leaders);
+        } else
+            large_reduce(objs, nullptr, nbItems, tp, op, 0, h.node);
+        large_bcast(res, nbItems, tp, 0, h.node);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
     template <typename K>
     void allreduce(const K &loc, K *glob, const Operation &op) const {
         BEGIN_PROFILE_COMMUNICATION
@@ -494,38 +1073,272 @@ struct Communicator::Implementation {
 #endif
         BEGIN_PROFILE_COMMUNICATION
         assert(objs != nullptr);
-        reduce_functor<K> = std::function<K(const K &, const K &)>(fct);
-
-        MPI_Op op;
-        MPI_Op_create(reduce_user_function<K>, (commute ? 1 : 0), &op);
-
         assert(res != nullptr);
+        MPI_Op op = UserOperation<K, F>::get(fct, commute);
         if (objs == res) {
-            MPI_Allreduce(MPI_IN_PLACE, res, nbItems, Type_MPI<K>::mpi_type(), op, m_communicator);
+            large_allreduce(MPI_IN_PLACE, res, nbItems, reduce_type<K>(), op, m_communicator);
         } else {
-            MPI_Allreduce(objs, res, nbItems, Type_MPI<K>::mpi_type(), op, m_communicator);
+            large_allreduce(objs, res, nbItems, reduce_type<K>(), op, m_communicator);
         }
-        MPI_Op_free(&op);
         END_PROFILE_COMMUNICATION
     }
     // .........................................................................................
     template <typename K, typename F>
-    void allreduce(const K &loc, K *glob, const F &fct, bool is_commuting) const {
-        reduce_functor<K> = std::function<K(const K &, const K &)>(fct);
-
-        MPI_Op op;
-        MPI_Op_create(reduce_user_function<K>, (is_commuting ? 1 : 0), &op);
-
-        Communication<K, is_container<K>::value>::allreduce(m_communicator, loc, glob, op);
-
-        MPI_Op_free(&op);
+    void allreduce(const K &loc, K *glob, const F &fct, bool is_commuting) {
+        allreduce(loc, glob, fct, is_commuting, std::integral_constant<bool, is_container<K>::value>());
+    }
+    template <typename K, typename F>
+    void allreduce(const K &loc, K *glob, const F &fct, bool is_commuting, std::false_type) {
+        allreduce(1, &loc, glob, fct, is_commuting);
+    }
+    template <typename K, typename F>
+    void allreduce(const K &loc, K *glob, const F &fct, bool is_commuting, std::true_type) const {
+        BEGIN_PROFILE_COMMUNICATION
+        MPI_Op op = UserOperation<typename K::value_type, F>::get(fct, is_commuting);
+        Communication<K, true>::allreduce(m_communicator, loc, glob, op);
+        END_PROFILE_COMMUNICATION
+    }
+    // ====================================================================================================
+    // Gather, scatter and all to all families :
+    template <typename K>
+    void gather(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Gather " << nbItems << " objects per process with root = " << root
+            << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufsnd != nullptr);
+        assert((root != getRank()) || (bufrcv != nullptr));
+        MPI_Gather(bufsnd, buffer_count<K>(nbItems), buffer_type<K>(), bufrcv, buffer_count<K>(nbItems),
+                   buffer_type<K>(), root, m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void gatherv(std::size_t nbItems, const K *bufsnd, const std::vector<std::size_t> &counts, K *bufrcv,
+                 int root) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Gatherv " << nbItems << " objects with root = " << root
+            << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        std::vector<VCount> mpi_counts;
+        std::vector<VDispl> displs;
+        if (root == getRank()) {
+            assert(int(counts.size()) == getSize());
+            assert(counts[root] == nbItems);
+            counts_and_displacements<K>(counts, mpi_counts, displs);
+        }
+        large_gatherv(bufsnd, buffer_items<K>(nbItems), bufrcv, mpi_counts, displs, buffer_type<K>(), root,
+                      m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    std::vector<std::size_t> gatherv(const K &snd, K &rcv, int root) const {
+        static_assert(is_container<K>::value, "gatherv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        auto counts = Communication<K, true>::gatherv(m_communicator, snd, rcv, root);
+        END_PROFILE_COMMUNICATION
+        return counts;
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K>
+    void scatter(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Scatter " << nbItems << " objects per process with root = " << root
+            << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufrcv != nullptr);
+        assert((root != getRank()) || (bufsnd != nullptr));
+        MPI_Scatter(bufsnd, buffer_count<K>(nbItems), buffer_type<K>(), bufrcv, buffer_count<K>(nbItems),
+                    buffer_type<K>(), root, m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void scatterv(const std::vector<std::size_t> &counts, const K *bufsnd, std::size_t nbItems, K *bufrcv,
+                  int root) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Scatterv " << nbItems << " objects with root = " << root
+            << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        std::vector<VCount> mpi_counts;
+        std::vector<VDispl> displs;
+        if (root == getRank()) {
+            assert(int(counts.size()) == getSize());
+            assert(counts[root] == nbItems);
+            counts_and_displacements<K>(counts, mpi_counts, displs);
+        }
+        large_scatterv(bufsnd, mpi_counts, displs, bufrcv, buffer_items<K>(nbItems), buffer_type<K>(), root,
+                       m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void scatterv(const K &snd, const std::vector<std::size_t> &counts, K &rcv, int root) const {
+        static_assert(is_container<K>::value, "scatterv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        Communication<K, true>::scatterv(m_communicator, snd, counts, rcv, root);
+        END_PROFILE_COMMUNICATION
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K>
+    void allgather(std::size_t nbItems, const K *bufsnd, K *bufrcv) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Allgather " << nbItems << " objects per process"
+            << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufsnd != nullptr);
+        assert(bufrcv != nullptr);
+        MPI_Allgather(bufsnd, buffer_count<K>(nbItems), buffer_type<K>(), bufrcv, buffer_count<K>(nbItems),
+                      buffer_type<K>(), m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void allgatherv(std::size_t nbItems, const K *bufsnd, const std::vector<std::size_t> &counts, K *bufrcv) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Allgatherv " << nbItems << " objects" << Core::Logger::Normal
+            << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        assert(int(counts.size()) == getSize());
+        assert(counts[getRank()] == nbItems);
+        std::vector<VCount> mpi_counts;
+        std::vector<VDispl> displs;
+        counts_and_displacements<K>(counts, mpi_counts, displs);
+        large_allgatherv(bufsnd, buffer_items<K>(nbItems), bufrcv, mpi_counts, displs, buffer_type<K>(),
+                         m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    std::vector<std::size_t> allgatherv(const K &snd, K &rcv) const {
+        static_assert(is_container<K>::value, "allgatherv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        auto counts = Communication<K, true>::allgatherv(m_communicator, snd, rcv);
+        END_PROFILE_COMMUNICATION
+        return counts;
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K>
+    void alltoall(std::size_t nbItems, const K *bufsnd, K *bufrcv) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Alltoall " << nbItems << " objects per pair of processes"
+            << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufsnd != nullptr);
+        assert(bufrcv != nullptr);
+        MPI_Alltoall(bufsnd, buffer_count<K>(nbItems), buffer_type<K>(), bufrcv, buffer_count<K>(nbItems),
+                     buffer_type<K>(), m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void alltoallv(const std::vector<std::size_t> &snd_counts, const K *bufsnd,
+                   const std::vector<std::size_t> &rcv_counts, K *bufrcv) const {
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << Core::Logger::Cyan << "Alltoallv" << Core::Logger::Normal << std::endl;
+#endif
+        BEGIN_PROFILE_COMMUNICATION
+        assert(int(snd_counts.size()) == getSize());
+        assert(int(rcv_counts.size()) == getSize());
+        std::vector<VCount> mpi_snd_counts, mpi_rcv_counts;
+        std::vector<VDispl> snd_displs, rcv_displs;
+        counts_and_displacements<K>(snd_counts, mpi_snd_counts, snd_displs);
+        counts_and_displacements<K>(rcv_counts, mpi_rcv_counts, rcv_displs);
+        large_alltoallv(bufsnd, mpi_snd_counts, snd_displs, bufrcv, mpi_rcv_counts, rcv_displs, buffer_type<K>(),
+                        m_communicator);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    std::vector<std::size_t> alltoallv(const std::vector<std::size_t> &snd_counts, const K &snd, K &rcv) const {
+        static_assert(is_container<K>::value, "alltoallv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        auto counts = Communication<K, true>::alltoallv(m_communicator, snd_counts, snd, rcv);
+        END_PROFILE_COMMUNICATION
+        return counts;
+    }
+    // .........................................................................................
+    // NBX algorithm ( Hoefler, Siebert and Lumsdaine ) : a synchronous send completes when it is
+    // matched, so once all its sends are complete a process enters a non blocking barrier and
+    // continues to receive until the barrier completes. The tag alternates between two consecutive
+    // exchanges, since a process may begin the next exchange while another one is still probing.
+    template <typename K>
+    std::map<int, std::vector<K>> sparse_exchange(const std::map<int, std::vector<K>> &messages) const {
+        BEGIN_PROFILE_COMMUNICATION
+        const MPI_Comm &com = sparse_communicator();
+        const int tag       = int(m_sparse_round++ % 2);
+        const int rank      = getRank();
+        std::map<int, std::vector<K>> received;
+        std::vector<MPI_Request> requests;
+        requests.reserve(messages.size());
+        for (const auto &msg : messages) {
+            assert((msg.first >= 0) && (msg.first < getSize()));
+            if (msg.first == rank) {
+                received[rank] = msg.second;
+                continue;
+            }
+            requests.push_back(MPI_REQUEST_NULL);
+            large_issend(msg.second.data(), buffer_items<K>(msg.second.size()), buffer_type<K>(), msg.first, tag,
+                         com, &requests.back());
+        }
+        MPI_Request barrier = MPI_REQUEST_NULL;
+        for (int done = 0; !done;) {
+            int flag;
+            MPI_Status status;
+            MPI_Iprobe(MPI_ANY_SOURCE, tag, com, &flag, &status);
+            if (flag) {
+                std::size_t nbItems = received_count(status, buffer_type<K>());
+                if (Type_MPI<K>::must_be_packed()) nbItems /= sizeof(K);
+                std::vector<K> &rcv = received[status.MPI_SOURCE];
+                rcv.resize(nbItems);
+                large_recv(rcv.data(), buffer_items<K>(nbItems), buffer_type<K>(), status.MPI_SOURCE, tag, com,
+                           MPI_STATUS_IGNORE);
+            }
+            if (barrier != MPI_REQUEST_NULL)
+                MPI_Test(&barrier, &done, MPI_STATUS_IGNORE);
+            else {
+                int sent;
+                MPI_Testall(int(requests.size()), requests.data(), &sent, MPI_STATUSES_IGNORE);
+                if (sent) MPI_Ibarrier(com, &barrier);
+            }
+        }
+        END_PROFILE_COMMUNICATION
+        return received;
     }
     // ===============================================================================================
-    Communicator::Chronometer *m_pt_active_chrono;
+    std::atomic<Communicator::Chronometer *> m_pt_active_chrono;
     bool m_is_active_chrono;
 
   private:
     MPI_Comm m_communicator;
+    mutable MPI_Comm m_collective_communicator = MPI_COMM_NULL;
+    mutable MPI_Comm m_sparse_communicator     = MPI_COMM_NULL;
+    mutable unsigned m_sparse_round            = 0;
+    mutable std::once_flag m_world_ranks_flag;
+    mutable std::vector<int> m_world_ranks;
+    std::size_t m_pipeline_threshold           = std::numeric_limits<std::size_t>::max();
+    std::size_t m_pipeline_segment             = Communicator::default_segment_size;
+    Communicator::BroadcastTree m_pipeline_tree = Communicator::BroadcastTree::binary;
+    std::size_t m_compression_threshold         = std::numeric_limits<std::size_t>::max();
+    std::size_t m_hierarchy_threshold           = std::numeric_limits<std::size_t>::max();
+    int m_ranks_per_node                        = 0;
+    mutable std::unique_ptr<Hierarchy> m_hierarchy;
 };
 // ###############################################################################################
 // # Specialization of communication functions for containers :
@@ -548,9 +1361,9 @@ struct Communicator::Implementation::Communication<K, true> {
         }
 
         if (Type_MPI<typename K::value_type>::must_be_packed()) {
-            MPI_Send(snd->data(), snd->size() * sizeof(typename K::value_type), MPI_BYTE, dest, tag, com);
+            large_send(snd->data(), snd->size() * sizeof(typename K::value_type), MPI_BYTE, dest, tag, com);
         } else {
-            MPI_Send(snd->data(), snd->size(), Type_MPI<typename K::value_type>::mpi_type(), dest, tag, com);
+            large_send(snd->data(), snd->size(), Type_MPI<typename K::value_type>::mpi_type(), dest, tag, com);
         }
 #if defined(PARALLEL_TRACE)
         log << "Send a container with " << snd->size() << " elements to " << dest << " with tag " << tag << std::endl;
@@ -581,9 +1394,9 @@ struct Communicator::Implementation::Communication<K, true> {
 
         MPI_Request m_req;
         if (Type_MPI<typename K::value_type>::must_be_packed()) {
-            MPI_Isend(snd->data(), snd->size() * sizeof(typename K::value_type), MPI_BYTE, dest, tag, com, &m_req);
+            large_isend(snd->data(), snd->size() * sizeof(typename K::value_type), MPI_BYTE, dest, tag, com, &m_req);
         } else {
-            MPI_Isend(snd->data(), snd->size(), Type_MPI<typename K::value_type>::mpi_type(), dest, tag, com, &m_req);
+            large_isend(snd->data(), snd->size(), Type_MPI<typename K::value_type>::mpi_type(), dest, tag, com, &m_req);
         }
 #if defined(PARALLEL_TRACE)
         log << "Asynchrone send for a container with " << snd_obj.size() << " elements  to " << dest << " with tag "
@@ -606,8 +1419,9 @@ struct Communicator::Implementation::Communication<K, true> {
 #endif
         MPI_Status status;
         MPI_Probe(sender, tag, com, &status);
-        int szMsg;
-        MPI_Get_count(&status, Type_MPI<typename K::value_type>::mpi_type(), &szMsg);
+        // Number of objects in the message ( the objects which must be packed are sent as bytes )
+        std::size_t szMsg = received_count(status, buffer_type<typename K::value_type>());
+        if (Type_MPI<typename K::value_type>::must_be_packed()) szMsg /= sizeof(typename K::value_type);
         std::vector<typename K::value_type, typename K::allocator_type> *rcv;
         if (std::is_base_of<std::vector<typename K::value_type, typename K::allocator_type>, K>::value) {
             rcv = (std::vector<typename K::value_type, typename K::allocator_type> *)&rcvobj;
@@ -628,9 +1442,9 @@ struct Communicator::Implementation::Communication<K, true> {
             << std::endl;
 #endif
         if (Type_MPI<typename K::value_type>::must_be_packed()) {
-            MPI_Recv(rcv->data(), rcv->size() * sizeof(typename K::value_type), MPI_BYTE, sender, tag, com, &status);
+            large_recv(rcv->data(), rcv->size() * sizeof(typename K::value_type), MPI_BYTE, sender, tag, com, &status);
         } else {
-            MPI_Recv(rcv->data(), rcv->size(), Type_MPI<typename K::value_type>::mpi_type(), sender, tag, com, &status);
+            large_recv(rcv->data(), rcv->size(), Type_MPI<typename K::value_type>::mpi_type(), sender, tag, com, &status);
         }
 #if defined(PARALLEL_TRACE)
         log << "OK, receive done !" << std::endl;
@@ -666,9 +1480,9 @@ struct Communicator::Implementation::Communication<K, true> {
 
         MPI_Request req;
         if (Type_MPI<typename K::value_type>::must_be_packed()) {
-            MPI_Irecv(rcv->data(), rcv->size() * sizeof(typename K::value_type), MPI_BYTE, sender, tag, com, &req);
+            large_irecv(rcv->data(), rcv->size() * sizeof(typename K::value_type), MPI_BYTE, sender, tag, com, &req);
         } else {
-            MPI_Irecv(rcv->data(), rcv->size(), Type_MPI<typename K::value_type>::mpi_type(), sender, tag, com, &req);
+            large_irecv(rcv->data(), rcv->size(), Type_MPI<typename K::value_type>::mpi_type(), sender, tag, com, &req);
         }
 
         if (!std::is_base_of<std::vector<typename K::value_type, typename K::allocator_type>, K>::value) {
@@ -716,9 +1530,9 @@ struct Communicator::Implementation::Communication<K, true> {
             std::copy(obj_snd->begin(), obj_snd->end(), obj_rcv.begin());
         }
         if (Type_MPI<typename K::value_type>::must_be_packed()) {
-            MPI_Bcast(rcv->data(), rcv->size() * sizeof(typename K::value_type), MPI_BYTE, root, com);
+            large_bcast(rcv->data(), rcv->size() * sizeof(typename K::value_type), MPI_BYTE, root, com);
         } else {
-            MPI_Bcast(rcv->data(), rcv->size(), Type_MPI<typename K::value_type>::mpi_type(), root, com);
+            large_bcast(rcv->data(), rcv->size(), Type_MPI<typename K::value_type>::mpi_type(), root, com);
         }
 #if defined(PARALLEL_TRACE)
         log << "End of broadcasting" << std::endl;
@@ -772,9 +1586,9 @@ struct Communicator::Implementation::Communication<K, true> {
             std::copy(loc.begin(), loc.end(), lc->begin());
         }
         if (glb != nullptr)
-            MPI_Reduce(lc->data(), glb->data(), szMsg, Type_MPI<typename K::value_type>::mpi_type(), op, root, com);
+            large_reduce(lc->data(), glb->data(), szMsg, reduce_type<typename K::value_type>(), op, root, com);
         else
-            MPI_Reduce(lc->data(), nullptr, szMsg, Type_MPI<typename K::value_type>::mpi_type(), op, root, com);
+            large_reduce(lc->data(), nullptr, szMsg, reduce_type<typename K::value_type>(), op, root, com);
 #if defined(PARALLEL_TRACE)
         log << "End of reduction" << std::endl;
 #endif
@@ -821,7 +1635,7 @@ struct Communicator::Implementation::Communication<K, true> {
             lc  = new std::vector<typename K::value_type, typename K::allocator_type>(szMsg);
             std::copy(loc.begin(), loc.end(), lc->begin());
         }
-        MPI_Allreduce(lc->data(), glb->data(), szMsg, Type_MPI<typename K::value_type>::mpi_type(), op, com);
+        large_allreduce(lc->data(), glb->data(), szMsg, reduce_type<typename K::value_type>(), op, com);
 #if defined(PARALLEL_TRACE)
         log << "End of All reduction" << std::endl;
 #endif
@@ -831,6 +1645,134 @@ struct Communicator::Implementation::Communication<K, true> {
             delete lc;
         }
     }
+    // ----------------------------------------------------------------------------------------------------
+    // Gather, scatter and all to all families for containers. The counts and displacements are computed
+    // from the sizes of the containers, so the v-version of the MPI collective operations are used.
+    using value_type  = typename K::value_type;
+    using vector_type = std::vector<value_type, typename K::allocator_type>;
+    using is_vector   = std::is_base_of<vector_type, K>;
+    // Contiguous data of the container ( copied inside tmp if the container isn't a vector )
+    static const value_type *contiguous(const K &cont, vector_type &, std::true_type) { return cont.data(); }
+    static const value_type *contiguous(const K &cont, vector_type &tmp, std::false_type) {
+        vector_type(cont.begin(), cont.end()).swap(tmp);
+        return tmp.data();
+    }
+    // Resize the container to receive nbItems values and return the contiguous buffer where receive data
+    static value_type *reserve(K &cont, std::size_t nbItems, vector_type &, std::true_type) {
+        if (cont.size() != nbItems) vector_type(nbItems).swap(cont);
+        return cont.data();
+    }
+    static value_type *reserve(K &, std::size_t nbItems, vector_type &tmp, std::false_type) {
+        vector_type(nbItems).swap(tmp);
+        return tmp.data();
+    }
+    // Copy the received data inside the container if the container isn't a vector
+    static void commit(K &, vector_type &, std::true_type) {}
+    static void commit(K &cont, vector_type &tmp, std::false_type) { cont = K(tmp.begin(), tmp.end()); }
+    // .......................................................................................
+    static std::vector<std::size_t> gatherv(const MPI_Comm &com, const K &snd, K &rcv, int root) {
+        int rank, size;
+        MPI_Comm_rank(com, &rank);
+        MPI_Comm_size(com, &size);
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << "Gatherv of a container with " << snd.size() << " elements with root = " << root
+            << std::endl;
+#endif
+        std::size_t nbItems = snd.size();
+        std::vector<std::size_t> counts(rank == root ? size : 0);
+        MPI_Gather(&nbItems, 1, Type_MPI<std::size_t>::mpi_type(), counts.data(), 1,
+                   Type_MPI<std::size_t>::mpi_type(), root, com);
+        std::vector<VCount> mpi_counts;
+        std::vector<VDispl> displs;
+        vector_type tmp_snd, tmp_rcv;
+        value_type *bufrcv = nullptr;
+        if (rank == root) {
+            counts_and_displacements<value_type>(counts, mpi_counts, displs);
+            std::size_t total = 0;
+            for (auto c : counts) total += c;
+            bufrcv = reserve(rcv, total, tmp_rcv, is_vector());
+        }
+        large_gatherv(contiguous(snd, tmp_snd, is_vector()), buffer_items<value_type>(nbItems), bufrcv, mpi_counts,
+                      displs, buffer_type<value_type>(), root, com);
+        if (rank == root) commit(rcv, tmp_rcv, is_vector());
+        return counts;
+    }
+    // .......................................................................................
+    static void scatterv(const MPI_Comm &com, const K &snd, const std::vector<std::size_t> &counts, K &rcv,
+                         int root) {
+        int rank, size;
+        MPI_Comm_rank(com, &rank);
+        MPI_Comm_size(com, &size);
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << "Scatterv of a container with root = " << root << std::endl;
+#endif
+        std::size_t nbItems;
+        MPI_Scatter(counts.data(), 1, Type_MPI<std::size_t>::mpi_type(), &nbItems, 1,
+                    Type_MPI<std::size_t>::mpi_type(), root, com);
+        std::vector<VCount> mpi_counts;
+        std::vector<VDispl> displs;
+        vector_type tmp_snd, tmp_rcv;
+        const value_type *bufsnd = nullptr;
+        if (rank == root) {
+            assert(int(counts.size()) == size);
+            counts_and_displacements<value_type>(counts, mpi_counts, displs);
+            bufsnd = contiguous(snd, tmp_snd, is_vector());
+        }
+        large_scatterv(bufsnd, mpi_counts, displs, reserve(rcv, nbItems, tmp_rcv, is_vector()),
+                       buffer_items<value_type>(nbItems), buffer_type<value_type>(), root, com);
+        commit(rcv, tmp_rcv, is_vector());
+    }
+    // .......................................................................................
+    static std::vector<std::size_t> allgatherv(const MPI_Comm &com, const K &snd, K &rcv) {
+        int size;
+        MPI_Comm_size(com, &size);
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << "Allgatherv of a container with " << snd.size() << " elements" << std::endl;
+#endif
+        std::size_t nbItems = snd.size();
+        std::vector<std::size_t> counts(size);
+        MPI_Allgather(&nbItems, 1, Type_MPI<std::size_t>::mpi_type(), counts.data(), 1,
+                      Type_MPI<std::size_t>::mpi_type(), com);
+        std::vector<VCount> mpi_counts;
+        std::vector<VDispl> displs;
+        counts_and_displacements<value_type>(counts, mpi_counts, displs);
+        std::size_t total = 0;
+        for (auto c : counts) total += c;
+        vector_type tmp_snd, tmp_rcv;
+        large_allgatherv(contiguous(snd, tmp_snd, is_vector()), buffer_items<value_type>(nbItems),
+                         reserve(rcv, total, tmp_rcv, is_vector()), mpi_counts, displs, buffer_type<value_type>(), com);
+        commit(rcv, tmp_rcv, is_vector());
+        return counts;
+    }
+    // .......................................................................................
+    static std::vector<std::size_t> alltoallv(const MPI_Comm &com, const std::vector<std::size_t> &snd_counts,
+                                              const K &snd, K &rcv) {
+        int size;
+        MPI_Comm_size(com, &size);
+        assert(int(snd_counts.size()) == size);
+#if defined(PARALLEL_TRACE)
+        Core::Logger log;
+        log << LogTrace << "Alltoallv of a container with " << snd.size() << " elements" << std::endl;
+#endif
+        std::vector<std::size_t> rcv_counts(size);
+        MPI_Alltoall(snd_counts.data(), 1, Type_MPI<std::size_t>::mpi_type(), rcv_counts.data(), 1,
+                     Type_MPI<std::size_t>::mpi_type(), com);
+        std::vector<VCount> mpi_snd_counts, mpi_rcv_counts;
+        std::vector<VDispl> snd_displs, rcv_displs;
+        counts_and_displacements<value_type>(snd_counts, mpi_snd_counts, snd_displs);
+        counts_and_displacements<value_type>(rcv_counts, mpi_rcv_counts, rcv_displs);
+        std::size_t total = 0;
+        for (auto c : rcv_counts) total += c;
+        vector_type tmp_snd, tmp_rcv;
+        large_alltoallv(contiguous(snd, tmp_snd, is_vector()), mpi_snd_counts, snd_displs,
+                        reserve(rcv, total, tmp_rcv, is_vector()), mpi_rcv_counts, rcv_displs,
+                        buffer_type<value_type>(), com);
+        commit(rcv, tmp_rcv, is_vector());
+        return rcv_counts;
+    }
 };
 }
 #undef BEGIN_PROFILE_COMMUNICATION
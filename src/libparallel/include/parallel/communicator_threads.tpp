@@ -0,0 +1,739 @@
+//========================================================================
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ========================================================================
+// Communicator for the threads implementation : the ranks are threads of the same process ( to
+// work on a standalone computer or to debug without MPI, by example )
+#include "core/detect_container.hpp"
+#include "core/multitimer.hpp"
+#include "parallel/chronometer_implementation.hpp"
+#include "parallel/constantes.hpp"
+#include "parallel/context.hpp"
+#include "parallel/serialization.hpp"
+#include "parallel/status.hpp"
+#include "parallel/thread_runtime.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// The communications are measured by each thread, then added to the records of the chronometer
+#define BEGIN_PROFILE_COMMUNICATION \
+    Communicator::Chronometer::Implementation::Measure profile_measure(m_pt_active_chrono.load(), __func__);
+
+#define END_PROFILE_COMMUNICATION profile_measure.stop();
+
+namespace Parallel {
+namespace {
+// Reduction operations work on bytes : y <= op(x, y) for each object, x coming from the lower ranks.
+template <typename K, typename Func>
+inline void combine_with(const void *x, void *y, std::size_t bytes, const Func &fct) {
+    const K *__restrict ax    = static_cast<const K *>(x);
+    K *__restrict ay          = static_cast<K *>(y);
+    const std::size_t nbItems = bytes / sizeof(K);
+    for (std::size_t i = 0; i < nbItems; ++i) ay[i] = fct(ax[i], ay[i]);
+}
+template <typename K>
+Threads::Group::Combine bitwise_operation(Operation op, std::true_type) {
+    switch (op) {
+    case binary_and:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(a & b); }); };
+    case binary_or:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(a | b); }); };
+    case binary_xor:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(a ^ b); }); };
+    default:
+        return nullptr;
+    }
+}
+template <typename K>
+Threads::Group::Combine bitwise_operation(Operation, std::false_type) {
+    return nullptr;
+}
+template <typename K>
+Threads::Group::Combine arithmetic_operation(Operation op, std::true_type) {
+    switch (op) {
+    case max:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return std::max(a, b); }); };
+    case min:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return std::min(a, b); }); };
+    case sum:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(a + b); }); };
+    case prod:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(a * b); }); };
+    case logical_and:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(a && b); }); };
+    case logical_or:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(a || b); }); };
+    case logical_xor:
+        return [](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, [](K a, K b) { return K(!a != !b); }); };
+    default:
+        return bitwise_operation<K>(op, std::is_integral<K>());
+    }
+}
+template <typename K>
+Threads::Group::Combine arithmetic_operation(Operation, std::false_type) {
+    return nullptr;
+}
+// Predefined operation op for the type K ( only for the arithmetic types, as for MPI )
+template <typename K>
+Threads::Group::Combine predefined_operation(Operation op) {
+    Threads::Group::Combine combine = arithmetic_operation<K>(op, std::is_arithmetic<K>());
+    assert(combine && "Predefined operation not available for this type");
+    return combine;
+}
+// User defined operation : the functor is called inline on the whole buffer
+template <typename K, typename Func>
+Threads::Group::Combine user_operation(const Func &fct) {
+    return [&fct](const void *x, void *y, std::size_t n) { combine_with<K>(x, y, n, fct); };
+}
+// Contiguous view of the objects to communicate : a container is communicated through its values
+// ( copied inside a temporary vector if the container isn't a vector ), another object as one item.
+template <typename K, bool flag = is_container<K>::value>
+struct Items {
+    using value_type  = K;
+    using vector_type = std::vector<K>;
+    static std::size_t size(const K &) { return 1; }
+    static const K *data(const K &obj, vector_type &) { return &obj; }
+    static K *reserve(K &obj, std::size_t, vector_type &) { return &obj; }
+    static void commit(K &, vector_type &) {}
+};
+template <typename K>
+struct Items<K, true> {
+    using value_type  = typename K::value_type;
+    using vector_type = std::vector<value_type, typename K::allocator_type>;
+    using is_vector   = std::is_base_of<vector_type, K>;
+    static std::size_t size(const K &cont) { return cont.size(); }
+    static const value_type *data(const K &cont, vector_type &tmp) { return data(cont, tmp, is_vector()); }
+    // Resize the container to receive nbItems values and return the contiguous buffer where receive data
+    static value_type *reserve(K &cont, std::size_t nbItems, vector_type &tmp) {
+        return reserve(cont, nbItems, tmp, is_vector());
+    }
+    // Copy the received data inside the container if the container isn't a vector
+    static void commit(K &cont, vector_type &tmp) { commit(cont, tmp, is_vector()); }
+
+  private:
+    static const value_type *data(const K &cont, vector_type &, std::true_type) { return cont.data(); }
+    static const value_type *data(const K &cont, vector_type &tmp, std::false_type) {
+        vector_type(cont.begin(), cont.end()).swap(tmp);
+        return tmp.data();
+    }
+    static value_type *reserve(K &cont, std::size_t nbItems, vector_type &, std::true_type) {
+        if (cont.size() != nbItems) vector_type(nbItems).swap(cont);
+        return cont.data();
+    }
+    static value_type *reserve(K &, std::size_t nbItems, vector_type &tmp, std::false_type) {
+        vector_type(nbItems).swap(tmp);
+        return tmp.data();
+    }
+    static void commit(K &, vector_type &, std::true_type) {}
+    static void commit(K &cont, vector_type &tmp, std::false_type) { cont = K(tmp.begin(), tmp.end()); }
+};
+// Number of objects per rank converted in number of bytes per rank
+template <typename K>
+std::vector<std::size_t> bytes_counts(const std::vector<std::size_t> &counts) {
+    std::vector<std::size_t> bytes(counts.size());
+    for (std::size_t i = 0; i < counts.size(); ++i) bytes[i] = counts[i] * sizeof(K);
+    return bytes;
+}
+}
+// #################################################################################################
+struct Communicator::Implementation {
+    // The communicators are duplicated as in MPI, so the messages of two communicators never match
+    Implementation() : Implementation(duplicate(Threads::current_process().world, Threads::current_process().rank)) {}
+    // ...............................................................................................
+    Implementation(const Implementation &impl, int color, int key)
+        : Implementation(impl.m_group->split(impl.m_rank, color, key)) {}
+    // ...............................................................................................
+    Implementation(const Implementation &impl) : Implementation(impl.m_group->duplicate(impl.m_rank)) {}
+    // ...............................................................................................
+    // The external communicator is the identifier of a group of the calling thread
+    Implementation(const Ext_Communicator &excom) : Implementation(duplicate(Threads::Group::find(excom))) {}
+    // ...............................................................................................
+    ~Implementation() {
+        if (m_group) m_group->rank(m_rank).detach(m_group.get(), m_rank);
+    }
+    // -----------------------------------------------------------------------------------------------
+    int getRank() const { return m_rank; }
+    // ...............................................................................................
+    int getSize() const { return (m_group ? m_group->size() : 0); }
+    // ...............................................................................................
+    void translateRanks(Communicator::Implementation &o_impl, int nbRanks, const int *ranks, int *tr_ranks) const {
+        for (int i = 0; i < nbRanks; ++i) tr_ranks[i] = m_group->translate(ranks[i], *o_impl.m_group);
+    }
+    // ...............................................................................................
+    int world_rank(int rk) const { return m_group->translate(rk, *Threads::current_process().world); }
+    // ...............................................................................................
+    const Ext_Communicator &get_ext_comm() const { return m_id; }
+    // ...............................................................................................
+    // All the ranks share the memory of the process
+    Implementation *split_shared() const { return new Implementation(*this); }
+    // ...............................................................................................
+    void set_pipelined_broadcast(std::size_t threshold, std::size_t segment_size, Communicator::BroadcastTree tree) {
+        m_pipeline_threshold = threshold;
+        m_pipeline_segment   = segment_size;
+        m_pipeline_tree      = tree;
+    }
+    void set_compression(std::size_t threshold) { m_compression_threshold = threshold; }
+    std::size_t compression_threshold() const { return m_compression_threshold; }
+    // All the ranks are in the same node : the two level collectives are the usual ones
+    void set_hierarchical_collectives(std::size_t, int) {}
+    // ===============================================================================================
+    template <typename K>
+    void send(std::size_t nbItems, const K *sndbuff, int dest, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        m_group->send(Threads::Group::user, m_rank, dest, tag, sndbuff, nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+    }
+    // ...........................................................................................
+    template <typename K>
+    void send(const K &snd, int dest, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        typename Items<K>::vector_type tmp;
+        m_group->send(Threads::Group::user, m_rank, dest, tag, Items<K>::data(snd, tmp),
+                      Items<K>::size(snd) * sizeof(typename Items<K>::value_type));
+        END_PROFILE_COMMUNICATION
+    }
+    // ...........................................................................................
+    // Stream of a serialized object, gathered in one message
+    void send_parts(const Serialization::OutputArchive &archive, int dest, int tag) const {
+        std::vector<char> stream = archive.contiguous();
+        send(stream.size(), stream.data(), dest, tag);
+    }
+    // -------------------------------------------------------------------------------------------
+    // The small messages are copied at once, the large messages are copied by the receiver directly
+    // from the send buffer, which must not be modified before the completion of the request.
+    template <typename K>
+    Request isend(std::size_t nbItems, const K *sndbuff, int dest, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        auto completion = m_group->isend(Threads::Group::user, m_rank, dest, tag, sndbuff, nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+        return request(completion, nullptr);
+    }
+    // .........................................................................................
+    template <typename K>
+    Request isend(const K &snd, int dest, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        // The temporary copy of a container which isn't a vector lives until the completion
+        auto tmp        = std::make_shared<typename Items<K>::vector_type>();
+        auto completion = m_group->isend(Threads::Group::user, m_rank, dest, tag, Items<K>::data(snd, *tmp),
+                                         Items<K>::size(snd) * sizeof(typename Items<K>::value_type));
+        END_PROFILE_COMMUNICATION
+        return request(completion, tmp);
+    }
+    // -------------------------------------------------------------------------------------------
+    template <typename K>
+    Status recv(std::size_t nbItems, K *rcvbuff, int sender, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        Status status = m_group->recv(Threads::Group::user, m_rank, sender, tag, rcvbuff, nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+        return status;
+    }
+    // .........................................................................................
+    // The size of a container is given by the incoming message
+    template <typename K>
+    Status recv(K &rcvobj, int sender, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        using value_type  = typename Items<K>::value_type;
+        std::size_t bytes = sizeof(K);
+        if (is_container<K>::value) {
+            Status incoming = probe(sender, tag);
+            sender          = incoming.source();
+            tag             = incoming.tag();
+            bytes           = incoming.m_bytes;
+        }
+        typename Items<K>::vector_type tmp;
+        const std::size_t nbItems = bytes / sizeof(value_type);
+        Status status             = m_group->recv(Threads::Group::user, m_rank, sender, tag,
+                                      Items<K>::reserve(rcvobj, nbItems, tmp), nbItems * sizeof(value_type));
+        Items<K>::commit(rcvobj, tmp);
+        END_PROFILE_COMMUNICATION
+        return status;
+    }
+    // -------------------------------------------------------------------------------------------
+    template <typename K>
+    Request irecv(std::size_t nbItems, K *rcvbuff, int sender, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        auto completion = m_group->irecv(Threads::Group::user, m_rank, sender, tag, rcvbuff, nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+        return request(completion, nullptr);
+    }
+    // .........................................................................................
+    // The receive of a container is posted when the incoming message is probed ( to know its size ),
+    // and the container is filled at the completion.
+    template <typename K>
+    Request irecv(K &rcvobj, int sender, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        if (!is_container<K>::value) {
+            auto completion = m_group->irecv(Threads::Group::user, m_rank, sender, tag, &rcvobj, sizeof(K));
+            END_PROFILE_COMMUNICATION
+            return request(completion, nullptr);
+        }
+        using value_type = typename Items<K>::value_type;
+        struct Pending {
+            std::shared_ptr<Threads::Completion> completion;
+            typename Items<K>::vector_type tmp;
+        };
+        auto pending = std::make_shared<Pending>();
+        auto group   = m_group;
+        int rank     = m_rank;
+        K *pt_rcv    = &rcvobj;
+        END_PROFILE_COMMUNICATION
+        return Request([group, rank, sender, tag, pt_rcv, pending](Status &status) {
+            group->progress(rank);
+            if (!pending->completion) {
+                Status incoming;
+                if (!group->endpoint(rank, Threads::Group::user).probe(sender, tag, incoming)) return false;
+                const std::size_t nbItems = incoming.m_bytes / sizeof(value_type);
+                pending->completion =
+                    group->irecv(Threads::Group::user, rank, incoming.source(), incoming.tag(),
+                                 Items<K>::reserve(*pt_rcv, nbItems, pending->tmp), nbItems * sizeof(value_type));
+            }
+            if (!pending->completion->done.load(std::memory_order_acquire)) return false;
+            Items<K>::commit(*pt_rcv, pending->tmp);
+            status = pending->completion->status;
+            return true;
+        });
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K>
+    void broadcast(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufrcv != nullptr);
+        if (nbItems * sizeof(K) >= m_pipeline_threshold) {
+            END_PROFILE_COMMUNICATION
+            pipelined_broadcast(nbItems, bufsnd, bufrcv, root, m_pipeline_segment, m_pipeline_tree);
+            return;
+        }
+        if (root == m_rank) {
+            assert(bufsnd != nullptr);
+            if ((bufsnd != nullptr) && (bufsnd != bufrcv)) std::copy_n(bufsnd, nbItems, bufrcv);
+        }
+        m_group->bcast(m_rank, root, bufrcv, nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    Request ibroadcast(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufrcv != nullptr);
+        if (root == m_rank) {
+            assert(bufsnd != nullptr);
+            if ((bufsnd != nullptr) && (bufsnd != bufrcv)) std::copy_n(bufsnd, nbItems, bufrcv);
+        }
+        auto completions = m_group->ibcast(m_rank, root, bufrcv, nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+        auto group = m_group;
+        int rank   = m_rank;
+        return Request([group, rank, completions](Status &) {
+            for (const auto &completion : completions)
+                if (!completion->done.load(std::memory_order_acquire)) {
+                    group->progress(rank);
+                    if (!completion->done.load(std::memory_order_acquire)) return false;
+                }
+            return true;
+        });
+    }
+    // .........................................................................................
+    // The children copy the large messages directly from the buffer of their parent, so the
+    // segments are broadcast one after the other ( along the binomial tree, whatever the tree asked )
+    // to bound the time while a segment is waited.
+    template <typename K>
+    void pipelined_broadcast(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root, std::size_t segment_size,
+                             Communicator::BroadcastTree) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufrcv != nullptr);
+        if (root == m_rank) {
+            assert(bufsnd != nullptr);
+            if ((bufsnd != nullptr) && (bufsnd != bufrcv)) std::copy_n(bufsnd, nbItems, bufrcv);
+        }
+        const std::size_t items_per_segment = std::max(std::size_t(1), segment_size / sizeof(K));
+        for (std::size_t beg = 0; beg < nbItems; beg += items_per_segment)
+            m_group->bcast(m_rank, root, bufrcv + beg, std::min(items_per_segment, nbItems - beg) * sizeof(K));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void hierarchical_broadcast(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+        broadcast(nbItems, bufsnd, bufrcv, root);
+    }
+    template <typename K>
+    void hierarchical_reduce(std::size_t nbItems, const K *objs, K *res, Operation op, int root) {
+        reduce(nbItems, objs, res, op, root);
+    }
+    template <typename K>
+    void hierarchical_allreduce(std::size_t nbItems, const K *objs, K *res, Operation op) {
+        allreduce(nbItems, objs, res, op);
+    }
+    // .........................................................................................
+    // The size of a container is broadcast before its values
+    template <typename K>
+    void broadcast(const K *obj_snd, K &obj_rcv, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        using value_type = typename Items<K>::value_type;
+        if ((root == m_rank) && (obj_snd != nullptr) && (obj_snd != &obj_rcv)) obj_rcv = *obj_snd;
+        std::size_t nbItems = Items<K>::size(obj_rcv);
+        if (is_container<K>::value) m_group->bcast(m_rank, root, &nbItems, sizeof(std::size_t));
+        typename Items<K>::vector_type tmp;
+        value_type *buffer = (root == m_rank ? const_cast<value_type *>(Items<K>::data(obj_rcv, tmp))
+                                             : Items<K>::reserve(obj_rcv, nbItems, tmp));
+        m_group->bcast(m_rank, root, buffer, nbItems * sizeof(value_type));
+        if (root != m_rank) Items<K>::commit(obj_rcv, tmp);
+        END_PROFILE_COMMUNICATION
+    }
+    // -----------------------------------------------------------------------------------------
+    void barrier() const {
+        BEGIN_PROFILE_COMMUNICATION
+        m_group->barrier(m_rank);
+        END_PROFILE_COMMUNICATION
+    }
+    // ----------------------------------------------------------------------------------------------------
+    Status probe(int source, int tag) const {
+        BEGIN_PROFILE_COMMUNICATION
+        Status status;
+        while (!m_group->endpoint(m_rank, Threads::Group::user).probe(source, tag, status)) {
+            m_group->progress(m_rank);
+            std::this_thread::yield();
+        }
+        END_PROFILE_COMMUNICATION
+        return status;
+    }
+    // ----------------------------------------------------------------------------------------------------
+    bool iprobe(int source, int tag, Status &status) {
+        BEGIN_PROFILE_COMMUNICATION
+        bool flag = m_group->endpoint(m_rank, Threads::Group::user).probe(source, tag, status);
+        END_PROFILE_COMMUNICATION
+        return flag;
+    }
+    // ====================================================================================================
+    template <typename K>
+    void reduce(std::size_t nbItems, const K *objs, K *res, Operation op, int root) {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(objs != nullptr);
+        assert((root != m_rank) || (res != nullptr));
+        m_group->reduce(m_rank, root, objs, res, nbItems * sizeof(K), predefined_operation<K>(op));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void reduce(const K &loc, K *glob, const Operation &op, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        reduce_items(loc, glob, predefined_operation<typename Items<K>::value_type>(op), root);
+        END_PROFILE_COMMUNICATION
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K, typename F>
+    void reduce(std::size_t nbItems, const K *objs, K *res, const F &fct, bool, int root) {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(objs != nullptr);
+        assert((root != m_rank) || (res != nullptr));
+        m_group->reduce(m_rank, root, objs, res, nbItems * sizeof(K), user_operation<K>(fct));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    // For a container, the functor reduces the values of the container one by one
+    template <typename K, typename F>
+    void reduce(const K &loc, K *glob, const F &fct, bool, int root) {
+        BEGIN_PROFILE_COMMUNICATION
+        reduce_items(loc, glob, user_operation<typename Items<K>::value_type>(fct), root);
+        END_PROFILE_COMMUNICATION
+    }
+    // ====================================================================================================
+    template <typename K>
+    void allreduce(std::size_t nbItems, const K *objs, K *res, Operation op) {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(objs != nullptr);
+        assert(res != nullptr);
+        m_group->allreduce(m_rank, objs, res, nbItems * sizeof(K), predefined_operation<K>(op));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void allreduce(const K &loc, K *glob, const Operation &op) const {
+        BEGIN_PROFILE_COMMUNICATION
+        allreduce_items(loc, glob, predefined_operation<typename Items<K>::value_type>(op));
+        END_PROFILE_COMMUNICATION
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K, typename F>
+    void allreduce(std::size_t nbItems, const K *objs, K *res, const F &fct, bool) {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(objs != nullptr);
+        assert(res != nullptr);
+        m_group->allreduce(m_rank, objs, res, nbItems * sizeof(K), user_operation<K>(fct));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K, typename F>
+    void allreduce(const K &loc, K *glob, const F &fct, bool) {
+        BEGIN_PROFILE_COMMUNICATION
+        allreduce_items(loc, glob, user_operation<typename Items<K>::value_type>(fct));
+        END_PROFILE_COMMUNICATION
+    }
+    // ====================================================================================================
+    // Gather, scatter and all to all families :
+    template <typename K>
+    void gather(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufsnd != nullptr);
+        assert((root != m_rank) || (bufrcv != nullptr));
+        m_group->gatherv(m_rank, root, bufsnd, nbItems * sizeof(K), bufrcv,
+                         std::vector<std::size_t>(getSize(), nbItems * sizeof(K)));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void gatherv(std::size_t nbItems, const K *bufsnd, const std::vector<std::size_t> &counts, K *bufrcv,
+                 int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert((root != m_rank) || ((int(counts.size()) == getSize()) && (counts[root] == nbItems)));
+        m_group->gatherv(m_rank, root, bufsnd, nbItems * sizeof(K), bufrcv,
+                         (root == m_rank ? bytes_counts<K>(counts) : std::vector<std::size_t>()));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    std::vector<std::size_t> gatherv(const K &snd, K &rcv, int root) const {
+        static_assert(is_container<K>::value, "gatherv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        using value_type    = typename Items<K>::value_type;
+        std::size_t nbItems = snd.size();
+        std::vector<std::size_t> counts(root == m_rank ? getSize() : 0);
+        m_group->gatherv(m_rank, root, &nbItems, sizeof(std::size_t), counts.data(),
+                         std::vector<std::size_t>(getSize(), sizeof(std::size_t)));
+        typename Items<K>::vector_type tmp_snd, tmp_rcv;
+        value_type *bufrcv = nullptr;
+        if (root == m_rank) {
+            std::size_t total = 0;
+            for (auto c : counts) total += c;
+            bufrcv = Items<K>::reserve(rcv, total, tmp_rcv);
+        }
+        m_group->gatherv(m_rank, root, Items<K>::data(snd, tmp_snd), nbItems * sizeof(value_type), bufrcv,
+                         (root == m_rank ? bytes_counts<value_type>(counts) : std::vector<std::size_t>()));
+        if (root == m_rank) Items<K>::commit(rcv, tmp_rcv);
+        END_PROFILE_COMMUNICATION
+        return counts;
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K>
+    void scatter(std::size_t nbItems, const K *bufsnd, K *bufrcv, int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufrcv != nullptr);
+        assert((root != m_rank) || (bufsnd != nullptr));
+        m_group->scatterv(m_rank, root, bufsnd, std::vector<std::size_t>(getSize(), nbItems * sizeof(K)), bufrcv,
+                          nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void scatterv(const std::vector<std::size_t> &counts, const K *bufsnd, std::size_t nbItems, K *bufrcv,
+                  int root) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert((root != m_rank) || ((int(counts.size()) == getSize()) && (counts[root] == nbItems)));
+        m_group->scatterv(m_rank, root, bufsnd, (root == m_rank ? bytes_counts<K>(counts) : std::vector<std::size_t>()),
+                          bufrcv, nbItems * sizeof(K));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void scatterv(const K &snd, const std::vector<std::size_t> &counts, K &rcv, int root) const {
+        static_assert(is_container<K>::value, "scatterv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        using value_type = typename Items<K>::value_type;
+        std::size_t nbItems;
+        m_group->scatterv(m_rank, root, counts.data(), std::vector<std::size_t>(getSize(), sizeof(std::size_t)),
+                          &nbItems, sizeof(std::size_t));
+        typename Items<K>::vector_type tmp_snd, tmp_rcv;
+        const value_type *bufsnd = nullptr;
+        if (root == m_rank) {
+            assert(int(counts.size()) == getSize());
+            bufsnd = Items<K>::data(snd, tmp_snd);
+        }
+        m_group->scatterv(m_rank, root, bufsnd,
+                          (root == m_rank ? bytes_counts<value_type>(counts) : std::vector<std::size_t>()),
+                          Items<K>::reserve(rcv, nbItems, tmp_rcv), nbItems * sizeof(value_type));
+        Items<K>::commit(rcv, tmp_rcv);
+        END_PROFILE_COMMUNICATION
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K>
+    void allgather(std::size_t nbItems, const K *bufsnd, K *bufrcv) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufsnd != nullptr);
+        assert(bufrcv != nullptr);
+        m_group->allgatherv(m_rank, bufsnd, nbItems * sizeof(K), bufrcv,
+                            std::vector<std::size_t>(getSize(), nbItems * sizeof(K)));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void allgatherv(std::size_t nbItems, const K *bufsnd, const std::vector<std::size_t> &counts, K *bufrcv) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(int(counts.size()) == getSize());
+        assert(counts[m_rank] == nbItems);
+        m_group->allgatherv(m_rank, bufsnd, nbItems * sizeof(K), bufrcv, bytes_counts<K>(counts));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    std::vector<std::size_t> allgatherv(const K &snd, K &rcv) const {
+        static_assert(is_container<K>::value, "allgatherv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        using value_type    = typename Items<K>::value_type;
+        std::size_t nbItems = snd.size();
+        std::vector<std::size_t> counts(getSize());
+        m_group->allgatherv(m_rank, &nbItems, sizeof(std::size_t), counts.data(),
+                            std::vector<std::size_t>(getSize(), sizeof(std::size_t)));
+        std::size_t total = 0;
+        for (auto c : counts) total += c;
+        typename Items<K>::vector_type tmp_snd, tmp_rcv;
+        m_group->allgatherv(m_rank, Items<K>::data(snd, tmp_snd), nbItems * sizeof(value_type),
+                            Items<K>::reserve(rcv, total, tmp_rcv), bytes_counts<value_type>(counts));
+        Items<K>::commit(rcv, tmp_rcv);
+        END_PROFILE_COMMUNICATION
+        return counts;
+    }
+    // -----------------------------------------------------------------------------------------
+    template <typename K>
+    void alltoall(std::size_t nbItems, const K *bufsnd, K *bufrcv) const {
+        BEGIN_PROFILE_COMMUNICATION
+        assert(bufsnd != nullptr);
+        assert(bufrcv != nullptr);
+        std::vector<std::size_t> counts(getSize(), nbItems * sizeof(K));
+        m_group->alltoallv(m_rank, bufsnd, counts, bufrcv, counts);
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    void alltoallv(const std::vector<std::size_t> &snd_counts, const K *bufsnd,
+                   const std::vector<std::size_t> &rcv_counts, K *bufrcv) const {
+        BEGIN_PROFILE_COMMUNICATION
+        m_group->alltoallv(m_rank, bufsnd, bytes_counts<K>(snd_counts), bufrcv, bytes_counts<K>(rcv_counts));
+        END_PROFILE_COMMUNICATION
+    }
+    // .........................................................................................
+    template <typename K>
+    std::vector<std::size_t> alltoallv(const std::vector<std::size_t> &snd_counts, const K &snd, K &rcv) const {
+        static_assert(is_container<K>::value, "alltoallv on an object is only available for containers");
+        BEGIN_PROFILE_COMMUNICATION
+        using value_type = typename Items<K>::value_type;
+        assert(int(snd_counts.size()) == getSize());
+        std::vector<std::size_t> rcv_counts(getSize());
+        std::vector<std::size_t> size_counts(getSize(), sizeof(std::size_t));
+        m_group->alltoallv(m_rank, snd_counts.data(), size_counts, rcv_counts.data(), size_counts);
+        std::size_t total = 0;
+        for (auto c : rcv_counts) total += c;
+        typename Items<K>::vector_type tmp_snd, tmp_rcv;
+        m_group->alltoallv(m_rank, Items<K>::data(snd, tmp_snd), bytes_counts<value_type>(snd_counts),
+                           Items<K>::reserve(rcv, total, tmp_rcv), bytes_counts<value_type>(rcv_counts));
+        Items<K>::commit(rcv, tmp_rcv);
+        END_PROFILE_COMMUNICATION
+        return rcv_counts;
+    }
+    // .........................................................................................
+    template <typename K>
+    std::map<int, std::vector<K>> sparse_exchange(const std::map<int, std::vector<K>> &messages) const {
+        BEGIN_PROFILE_COMMUNICATION
+        std::map<int, std::vector<K>> received;
+        std::vector<Threads::Group::Outgoing> outgoing;
+        outgoing.reserve(messages.size());
+        for (const auto &msg : messages) {
+            assert((msg.first >= 0) && (msg.first < getSize()));
+            if (msg.first == m_rank)
+                received[m_rank] = msg.second;
+            else
+                outgoing.push_back({msg.first, msg.second.data(), msg.second.size() * sizeof(K)});
+        }
+        m_group->sparse_exchange(m_rank, outgoing, [&received](int source, std::size_t bytes) -> void * {
+            std::vector<K> &rcv = received[source];
+            rcv.resize(bytes / sizeof(K));
+            return rcv.data();
+        });
+        END_PROFILE_COMMUNICATION
+        return received;
+    }
+    // ===============================================================================================
+    std::atomic<Communicator::Chronometer *> m_pt_active_chrono{nullptr};
+
+  private:
+    using GroupAndRank = std::pair<std::shared_ptr<Threads::Group>, int>;
+    Implementation(GroupAndRank group)
+        : m_group(std::move(group.first)), m_rank(group.second), m_id(m_group ? m_group->id() : undefined) {
+        if (m_group) m_group->rank(m_rank).attach(m_group.get(), m_rank);
+    }
+    // Duplicate the group for the calling thread
+    static GroupAndRank duplicate(const std::shared_ptr<Threads::Group> &group) {
+        assert(group && "Unknown communicator");
+        const Threads::Process &process = Threads::current_process();
+        return group->duplicate(group->rank_of(process.world->rank(process.rank)));
+    }
+    static GroupAndRank duplicate(const std::shared_ptr<Threads::Group> &group, int rank) {
+        assert(group && "The parallel context must be created before the communicators");
+        return group->duplicate(rank);
+    }
+    // Request completed with the completion ( keep alive the data needed until the completion )
+    Request request(const std::shared_ptr<Threads::Completion> &completion, std::shared_ptr<void> data) const {
+        auto group = m_group;
+        int rank   = m_rank;
+        return Request([group, rank, completion, data](Status &status) {
+            if (!completion->done.load(std::memory_order_acquire)) {
+                group->progress(rank);
+                if (!completion->done.load(std::memory_order_acquire)) return false;
+            }
+            status = completion->status;
+            return true;
+        });
+    }
+    // Reductions of an object, or of the values of a container
+    template <typename K>
+    void reduce_items(const K &loc, K *glob, const Threads::Group::Combine &combine, int root) const {
+        using value_type = typename Items<K>::value_type;
+        typename Items<K>::vector_type tmp_loc, tmp_glob;
+        const std::size_t nbItems = Items<K>::size(loc);
+        value_type *pt_glob       = nullptr;
+        if (root == m_rank) {
+            assert(glob != nullptr);
+            pt_glob = Items<K>::reserve(*glob, nbItems, tmp_glob);
+        }
+        m_group->reduce(m_rank, root, Items<K>::data(loc, tmp_loc), pt_glob, nbItems * sizeof(value_type), combine);
+        if (root == m_rank) Items<K>::commit(*glob, tmp_glob);
+    }
+    template <typename K>
+    void allreduce_items(const K &loc, K *glob, const Threads::Group::Combine &combine) const {
+        using value_type = typename Items<K>::value_type;
+        assert(glob != nullptr);
+        typename Items<K>::vector_type tmp_loc, tmp_glob;
+        const std::size_t nbItems = Items<K>::size(loc);
+        const value_type *pt_loc  = Items<K>::data(loc, tmp_loc);
+        m_group->allreduce(m_rank, pt_loc, Items<K>::reserve(*glob, nbItems, tmp_glob), nbItems * sizeof(value_type),
+                           combine);
+        Items<K>::commit(*glob, tmp_glob);
+    }
+
+    std::shared_ptr<Threads::Group> m_group;
+    int m_rank;
+    Ext_Communicator m_id;
+    std::size_t m_pipeline_threshold            = std::numeric_limits<std::size_t>::max();
+    std::size_t m_pipeline_segment              = Communicator::default_segment_size;
+    Communicator::BroadcastTree m_pipeline_tree = Communicator::BroadcastTree::binary;
+    std::size_t m_compression_threshold         = std::numeric_limits<std::size_t>::max();
+};
+}
+#undef BEGIN_PROFILE_COMMUNICATION
+#undef END_PROFILE_COMMUNICATION
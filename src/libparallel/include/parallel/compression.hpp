@@ -0,0 +1,50 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Lossless compression of the floating point buffers sent by the communicators
+#ifndef _PARALLEL_COMPRESSION_HPP_
+#define _PARALLEL_COMPRESSION_HPP_
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Lossless compression of buffers of float or double.
+ *
+ *             Each value is xored with the previous one : the close values of a smooth field give
+ *             words whose high bytes ( sign, exponent, high bits of the mantissa ) are null. The
+ *             bytes are then shuffled ( the first bytes of all the values, then the second bytes
+ *             and so on ) and the runs of null bytes are encoded by their length. The stream gives
+ *             the number and the size of the values, and keeps the raw values when the compression
+ *             doesn't reduce the size. The bits of the values ( NaN, signed zeros ) are kept.
+ */
+namespace Compression {
+/**
+ * @brief      True for the types which can be compressed
+ */
+template <typename K>
+struct is_compressible
+    : std::integral_constant<bool, std::is_same<K, float>::value || std::is_same<K, double>::value> {};
+
+std::vector<unsigned char> compress(std::size_t nbItems, const float *values);
+std::vector<unsigned char> compress(std::size_t nbItems, const double *values);
+/**
+ * @brief      Decompress the stream in nbItems values ( throw std::runtime_error if the stream
+ *             doesn't contain nbItems values of this type )
+ */
+void decompress(std::size_t nbBytes, const unsigned char *stream, std::size_t nbItems, float *values);
+void decompress(std::size_t nbBytes, const unsigned char *stream, std::size_t nbItems, double *values);
+}
+}
+#endif
@@ -22,6 +22,7 @@ namespace Parallel {
 const int any_tag    = MPI_ANY_TAG;
 const int any_source = MPI_ANY_SOURCE;
 const int undefined  = MPI_UNDEFINED;
+const int proc_null  = MPI_PROC_NULL;
 
 enum error {
     success = MPI_SUCCESS,
@@ -123,27 +124,26 @@ struct Type_MPI<unsigned long> {
 const int any_tag    = -1; /*!< Constant to receive from any tag */
 const int any_source = -1; /*!< Constant to receive from any source */
 const int undefined  = -1; /*!< Constant for undefined parameter */
+const int proc_null  = -2; /*!< Constant for a non existing process */
 
 typedef int Ext_Communicator;
 
 typedef int Operation;
 
-enum operation {
-    null = 0,
-    max,
-    min,
-    sum,
-    prod,
-    logical_and,
-    binary_and,
-    logical_or,
-    binary_or,
-    logical_xor,
-    binary_xor,
-    minloc,
-    maxloc,
-    replace
-};
+const Operation null        = 0;
+const Operation max         = 1;
+const Operation min         = 2;
+const Operation sum         = 3;
+const Operation prod        = 4;
+const Operation logical_and = 5;
+const Operation binary_and  = 6;
+const Operation logical_or  = 7;
+const Operation binary_or   = 8;
+const Operation logical_xor = 9;
+const Operation binary_xor  = 10;
+const Operation minloc      = 11;
+const Operation maxloc      = 12;
+const Operation replace     = 13;
 /*!
  * \enum error
  * \brief To manage error coming for parallel calls
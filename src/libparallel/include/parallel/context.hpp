@@ -21,7 +21,13 @@
  */
 #ifndef _PARALLEL_CONTEXT_HPP_
 #define _PARALLEL_CONTEXT_HPP_
+#include "core/chronometer.hpp"
 #include "parallel/communicator.hpp"
+#include <atomic>
+#include <memory>
+#if defined( USE_THREADS )
+#include <functional>
+#endif
 /*!  \namespace Parallel
  *
  *   Namespace gathering the objects managing the parallel services
@@ -56,6 +62,43 @@ namespace Parallel {
             Serialized, /*!< Only one thread will make Parallel library calls at one time. */
             Multiple    /*!< Multiple threads may call MPI at once with no restrictions. */
         };
+        /*!
+         *    \enum    startup_phase
+         *    \brief   Phases of the startup whose time is recorded
+         *
+         *    The communicators created after Context::endStartup aren't recorded.
+         */
+        enum startup_phase {
+            Initialization, /*!< Initialization of the underlying library ( MPI_Init ) */
+            Duplication,    /*!< Duplications of communicators ( global communicator included ) */
+            Split,          /*!< Splits of communicators */
+            nb_startup_phases
+        };
+        /*!
+         *    \brief   Number of calls and total time of a startup phase
+         */
+        struct StartupRecord {
+            unsigned long nb_calls;
+            double        total_time;
+        };
+        /*!
+         *    \class   StartupChronometer
+         *    \brief   Report of the startup time of the process in a Core::MultiTimer
+         *
+         *    Prints the time spent in each startup phase, so that the initialization can be
+         *    compared with the other timers of the program :
+         *
+         *        timer.subscribe<Parallel::Context::StartupChronometer>( "Startup" );
+         *        log << LogInformation << timer << std::endl;
+         */
+        class StartupChronometer : public Core::Chronometer {
+        public:
+            virtual std::ostream& print( std::ostream& out ) const override;
+
+        protected:
+            virtual void   start_chrono( ) override {}
+            virtual double get_delta_time( ) override { return 0.; }
+        };
         /*!
          *    Construction initializing the parallel context
          *
@@ -90,13 +133,72 @@ namespace Parallel {
          *     Return the actual multithread level support
          */
         thread_support levelOfThreadSupport( ) const { return m_provided; }
+        /*!
+         *     Start a thread which drives the progress of the non blocking communications of
+         *     the process, so that the large messages are transferred during the computations
+         *     ( many MPI libraries progress a message only inside the calls to the library ).
+         *     The thread needs the Multiple thread level support and is stopped by
+         *     stopProgressThread or by the destructor. Without MPI, the messages are copied by
+         *     the ranks themselves and nothing is started.
+         *
+         *     \param   interval Time in seconds between two polls of the library ( 0 : the
+         *                       thread polls continuously )
+         *     \param   core     Core where the thread is pinned ( -1 : no pinning ). Pin it on a
+         *                       core not used by the computations.
+         */
+        void startProgressThread( double interval = 1.E-4, int core = -1 );
+        /*!
+         *     Stop the progress thread ( if any )
+         */
+        void stopProgressThread( );
+        /*!
+         *     Return true if a progress thread is running
+         */
+        bool hasProgressThread( ) const { return bool( m_progress ); }
 
-        // The global communicator
+        /*!
+         *     Return the global communicator, created by the first call ( collective call ) and
+         *     shared by the listeners and the helpers which only need the ranks of the
+         *     processes. Thread safe, and freed by the destructor of the context.
+         */
         static const Communicator& globalCommunicator( );
+        /*!
+         *     Return the number of calls and the total time of a startup phase of the process
+         */
+        static StartupRecord startupTime( startup_phase phase );
+        /*!
+         *     Add time seconds to a startup phase ( called by the context and the communicators ),
+         *     until the end of the startup
+         */
+        static void recordStartup( startup_phase phase, double time );
+        /*!
+         *     End the startup of the process : the communicators created afterwards ( the
+         *     deferred ones included ) aren't recorded. Without this call, the startup times
+         *     cover all the communicators created by the program.
+         */
+        static void endStartup( );
+        /*!
+         *     Return true if Context::endStartup has been called
+         */
+        static bool startupEnded( );
+#if defined( USE_THREADS )
+        /*!
+         *     Run body on nbRanks ranks, each rank being a thread of the process ( the calling
+         *     thread is the rank 0 ). The body creates its Context and its communicators as
+         *     the main function of a MPI program. The first exception thrown by a rank is
+         *     thrown again when all the ranks are finished.
+         *
+         *     \param   nbRanks Number of ranks of the world communicator
+         *     \param   body    Function run by each rank
+         */
+        static void spawn( int nbRanks, const std::function<void( )>& body );
+#endif
 
     private:
-        thread_support       m_provided; /*!< Actual multithread level support */
-        static Communicator* pt_global_com;
+        class ProgressThread;
+        thread_support                  m_provided; /*!< Actual multithread level support */
+        std::unique_ptr<ProgressThread> m_progress; /*!< Thread driving the communications */
+        static std::atomic<Communicator*> pt_global_com;
     };
 }
 
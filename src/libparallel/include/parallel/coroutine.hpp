@@ -0,0 +1,273 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Coroutines waiting for the communications ( C++20 )
+#ifndef _PARALLEL_COROUTINE_HPP_
+#define _PARALLEL_COROUTINE_HPP_
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include "parallel/communicator"
+#include <algorithm>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <list>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Communication tasks written as coroutines.
+ *
+ *             A task co_awaits its non blocking communications instead of waiting them : the
+ *             scheduler resumes the other tasks of the process meanwhile, and resumes the task
+ *             when its communication is completed. Several communication tasks of a process
+ *             interleave without hand written state machines :
+ *
+ * @code
+ *             Parallel::Async::Task exchange(const Parallel::Communicator& com, int peer, int tag) {
+ *                 std::vector<double> snd(n), rcv(n);
+ *                 co_await Parallel::Async::recv(com, n, rcv.data(), peer, tag);
+ *                 co_await Parallel::Async::send(com, n, snd.data(), peer, tag);
+ *             }
+ *             Parallel::Async::Scheduler scheduler;
+ *             scheduler.spawn(exchange(com, left, 1));
+ *             scheduler.spawn(exchange(com, right, 2));
+ *             scheduler.run();
+ * @endcode
+ */
+namespace Async {
+class Scheduler;
+/**
+ * @brief      Coroutine returning nothing. A task starts when it is spawned by a scheduler or
+ *             co_awaited by another task ( which is resumed at the end of the task ). The
+ *             exception thrown by a task is thrown again by co_await or by Scheduler::run.
+ */
+class Task {
+  public:
+    struct promise_type {
+        Scheduler *scheduler = nullptr;
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct Resume_continuation {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    std::coroutine_handle<> next = h.promise().continuation;
+                    return (next ? next : std::noop_coroutine());
+                }
+                void await_resume() noexcept {}
+            };
+            return Resume_continuation{};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task &&task) noexcept : m_handle(std::exchange(task.m_handle, nullptr)) {}
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    Task &operator=(Task &&) = delete;
+    ~Task() {
+        if (m_handle) m_handle.destroy();
+    }
+    bool done() const { return !m_handle || m_handle.done(); }
+
+    // co_await of a task : the task runs in the scheduler of the awaiting task
+    bool await_ready() const { return done(); }
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> awaiting) {
+        m_handle.promise().scheduler    = awaiting.promise().scheduler;
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+    void await_resume() {
+        if (m_handle.promise().error) std::rethrow_exception(m_handle.promise().error);
+    }
+
+  private:
+    friend class Scheduler;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+    std::coroutine_handle<promise_type> m_handle;
+};
+// =================================================================================================
+/**
+ * @brief      Scheduler of the tasks of a process : the completion of the communications
+ *             awaited by the tasks are tested together ( Request::testsome ).
+ */
+class Scheduler {
+  public:
+    Scheduler() = default;
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    /**
+     * @brief      Add a task, started by run
+     */
+    void spawn(Task task) {
+        task.m_handle.promise().scheduler = this;
+        m_ready.push_back(task.m_handle);
+        m_tasks.push_back(std::move(task));
+    }
+    /**
+     * @brief      Run the tasks until they are all finished, and throw the first exception thrown
+     *             by a task
+     */
+    void run() {
+        std::vector<Request *> requests;
+        while (!m_ready.empty() || !m_waiting.empty()) {
+            while (!m_ready.empty()) {
+                std::coroutine_handle<> handle = m_ready.front();
+                m_ready.pop_front();
+                handle.resume();
+            }
+            if (m_waiting.empty()) break;
+            requests.clear();
+            for (auto &waiting : m_waiting) requests.push_back(waiting.first);
+            std::vector<std::size_t> completed = Request::testsome(requests);
+            if (completed.empty()) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::vector<bool> is_completed(m_waiting.size(), false);
+            for (std::size_t i : completed) is_completed[i] = true;
+            std::vector<std::pair<Request *, std::coroutine_handle<>>> still_waiting;
+            for (std::size_t i = 0; i < m_waiting.size(); ++i) {
+                if (is_completed[i])
+                    m_ready.push_back(m_waiting[i].second);
+                else
+                    still_waiting.push_back(m_waiting[i]);
+            }
+            m_waiting.swap(still_waiting);
+        }
+        std::exception_ptr error;
+        for (auto &task : m_tasks)
+            if (!error && task.m_handle.promise().error) error = task.m_handle.promise().error;
+        m_tasks.clear();
+        if (error) std::rethrow_exception(error);
+    }
+
+  private:
+    friend class Wait;
+    friend class Yield;
+    std::list<Task> m_tasks;
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::vector<std::pair<Request *, std::coroutine_handle<>>> m_waiting;
+};
+// =================================================================================================
+/**
+ * @brief      Awaitable completion of a non blocking communication ( co_await returns its status )
+ */
+class Wait {
+  public:
+    explicit Wait(Request request) : m_request(std::move(request)) {}
+    bool await_ready() { return m_request.test(); }
+    template <typename P>
+    void await_suspend(std::coroutine_handle<P> awaiting) {
+        awaiting.promise().scheduler->m_waiting.emplace_back(&m_request, awaiting);
+    }
+    Status await_resume() const { return m_request.status(); }
+
+  private:
+    Request m_request;
+};
+/**
+ * @brief      Awaitable letting the other ready tasks run
+ */
+class Yield {
+  public:
+    bool await_ready() const { return false; }
+    template <typename P>
+    void await_suspend(std::coroutine_handle<P> awaiting) {
+        awaiting.promise().scheduler->m_ready.push_back(awaiting);
+    }
+    void await_resume() const {}
+};
+// -------------------------------------------------------------------------------------------------
+inline Wait wait(Request request) { return Wait(std::move(request)); }
+inline Yield yield() { return Yield(); }
+/**
+ * @brief      Awaitable send of nbItems objects ( the buffer must be kept until the send is completed )
+ */
+template <typename K>
+Wait send(const Communicator &com, std::size_t nbItems, const K *buffer, int dest, int tag = 0) {
+    return Wait(com.isend(nbItems, buffer, dest, tag));
+}
+/**
+ * @brief      Awaitable receive of nbItems objects
+ */
+template <typename K>
+Wait recv(const Communicator &com, std::size_t nbItems, K *buffer, int sender = any_source, int tag = any_tag) {
+    return Wait(com.irecv(nbItems, buffer, sender, tag));
+}
+// =================================================================================================
+// Collective operations built on the point to point messages : a process can run several of them
+// at once, with different tags ( the tag must not be used by the other messages of com ).
+/**
+ * @brief      Dissemination barrier
+ */
+inline Task barrier(const Communicator &com, int tag) {
+    char token = 0, incoming;
+    for (int dist = 1; dist < com.size; dist *= 2) {
+        Wait rcv = recv(com, 1, &incoming, (com.rank + com.size - dist) % com.size, tag);
+        Wait snd = send(com, 1, &token, (com.rank + dist) % com.size, tag);
+        co_await snd;
+        co_await rcv;
+    }
+}
+/**
+ * @brief      Binomial tree broadcast of nbItems objects from root
+ */
+template <typename K>
+Task bcast(const Communicator &com, std::size_t nbItems, K *buffer, int root, int tag) {
+    const int vrank = (com.rank - root + com.size) % com.size;
+    int mask        = 1;
+    while (mask < com.size) {
+        if (vrank & mask) {
+            co_await recv(com, nbItems, buffer, (vrank - mask + root) % com.size, tag);
+            break;
+        }
+        mask <<= 1;
+    }
+    std::vector<Wait> sends;
+    for (mask >>= 1; mask > 0; mask >>= 1)
+        if (vrank + mask < com.size) sends.push_back(send(com, nbItems, buffer, (vrank + mask + root) % com.size, tag));
+    for (auto &snd : sends) co_await snd;
+}
+/**
+ * @brief      Reduction of nbItems objects with the associative functor op ( rcv = snd_0 op snd_1
+ *             op ... in the order of the ranks ), result given to all the processes
+ */
+template <typename K, typename Func>
+Task allreduce(const Communicator &com, std::size_t nbItems, const K *snd, K *rcv, Func op, int tag) {
+    if (rcv != snd) std::copy(snd, snd + nbItems, rcv);
+    std::vector<K> incoming(nbItems);
+    for (int mask = 1; mask < com.size; mask <<= 1) {
+        if (com.rank & mask) {
+            co_await send(com, nbItems, rcv, com.rank - mask, tag);
+            break;
+        }
+        if (com.rank + mask < com.size) {
+            co_await recv(com, nbItems, incoming.data(), com.rank + mask, tag);
+            for (std::size_t i = 0; i < nbItems; ++i) rcv[i] = op(rcv[i], incoming[i]);
+        }
+    }
+    co_await bcast(com, nbItems, rcv, 0, tag);
+}
+}
+}
+#endif
+#endif
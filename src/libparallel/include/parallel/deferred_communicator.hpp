@@ -0,0 +1,79 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Communicator created at its first use
+#ifndef _PARALLEL_DEFERRED_COMMUNICATOR_HPP_
+#define _PARALLEL_DEFERRED_COMMUNICATOR_HPP_
+#include "parallel/communicator"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Parallel {
+/**
+ * @brief      Split of a communicator deferred until the communicator is used.
+ *
+ *             The split communicators of a program ( rows, columns, nodes, ... ) are declared at
+ *             the startup but often used by a few phases only : the split ( a collective call,
+ *             costly on many processes ) is done by the first call of get(), and never if the
+ *             communicator isn't used. This first call must be done by all the processes of the
+ *             parent communicator, which must live until then. get() is thread safe.
+ *
+ * @code
+ *             Parallel::DeferredCommunicator rowCom(com, row, column);
+ *             ...
+ *             rowCom.get().bcast(n, buffer, 0); // Split here
+ * @endcode
+ */
+class DeferredCommunicator {
+  public:
+    using Factory = std::function<std::unique_ptr<Communicator>()>;
+    /**
+     * @brief      Split of com by color and key ( see Communicator(com, color, key) )
+     */
+    DeferredCommunicator(const Communicator &com, int color, int key)
+        : m_create([&com, color, key]() { return std::unique_ptr<Communicator>(new Communicator(com, color, key)); }) {}
+    /**
+     * @brief      Communicator created by create ( split_shared, line of a ProcessGrid, ... )
+     */
+    explicit DeferredCommunicator(Factory create) : m_create(std::move(create)) {}
+    DeferredCommunicator(const DeferredCommunicator &) = delete;
+    DeferredCommunicator &operator=(const DeferredCommunicator &) = delete;
+
+    /**
+     * @brief      The communicator, created by the first call ( collective call )
+     */
+    const Communicator &get() const {
+        std::call_once(m_once, [this]() {
+            m_com = m_create();
+            m_created.store(true, std::memory_order_release);
+        });
+        return *m_com;
+    }
+    Communicator &get() {
+        return const_cast<Communicator &>(static_cast<const DeferredCommunicator &>(*this).get());
+    }
+    /**
+     * @brief      Return true if the communicator has been created
+     */
+    bool created() const { return m_created.load(std::memory_order_acquire); }
+
+  private:
+    Factory m_create;
+    mutable std::once_flag m_once;
+    mutable std::unique_ptr<Communicator> m_com;
+    mutable std::atomic<bool> m_created{false};
+};
+}
+#endif
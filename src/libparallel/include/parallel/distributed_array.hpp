@@ -0,0 +1,378 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// N-dimensional array distributed over the processes of a communicator
+#ifndef _PARALLEL_DISTRIBUTED_ARRAY_HPP_
+#define _PARALLEL_DISTRIBUTED_ARRAY_HPP_
+#include "core/uvector.hpp"
+#include "parallel/communicator"
+#include "parallel/process_grid.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Distribution of the indices of a dimension over the processes of this dimension
+ */
+enum class Distribution {
+    block,       /*!< Contiguous blocks of ( almost ) the same size */
+    cyclic,      /*!< Index i on the process i % P */
+    block_cyclic /*!< Blocks of block_size indices given in turn to the processes */
+};
+/**
+ * @brief      N-dimensional array whose global index space is distributed over a grid of processes.
+ *
+ *             Each dimension is distributed over its own number of processes ( chosen to balance
+ *             the grid when not given ), and the process of coordinates ( p_0, ..., p_N-1 ) in the
+ *             grid is the rank p_N-1 + P_N-1 * ( p_N-2 + ... ) of the communicator. A process stores
+ *             its own elements and the ghost layers around them ( copies of the elements of the
+ *             neighbouring processes, for the dimensions with the block distribution ) in a
+ *             ao::uvector, so the storage is never default initialized. The elements are stored
+ *             in row major order ( the last index is contiguous ).
+ *
+ *             The local indices go from 0 to the local size of each dimension, and from -ghosts
+ *             to local size + ghosts with the ghost layers.
+ *
+ * @code
+ *             Parallel::DistributedArray<double, 2> u(com, {nx, ny}, 1);
+ *             auto n = u.local_shape();
+ *             for (long i = 0; i < long(n[0]); ++i)
+ *                 for (long j = 0; j < long(n[1]); ++j) u({i, j}) = f(u.to_global({i, j}));
+ *             u.update_ghosts();
+ * @endcode
+ *
+ * @tparam     T     Type of the elements ( trivially copyable )
+ * @tparam     N     Number of dimensions
+ */
+template <typename T, std::size_t N>
+class DistributedArray {
+  public:
+    using index       = std::array<std::size_t, N>;
+    using local_index = std::array<long, N>;
+    /**
+     * @brief      Layout of a dimension
+     */
+    struct Dimension {
+        std::size_t size;                                    /*!< Global number of indices */
+        Distribution distribution = Distribution::block;     /*!< Distribution of the indices */
+        std::size_t block_size    = 1;                       /*!< Size of the blocks of block_cyclic */
+        std::size_t ghosts        = 0;                       /*!< Width of the ghost layers ( block only ) */
+        int nb_procs              = 0;                       /*!< Number of processes ( 0 : automatic ) */
+    };
+
+    /**
+     * @brief      Create the array with the layout of each dimension ( collective call )
+     *
+     *             Throws std::invalid_argument if the grid of processes doesn't match the size of
+     *             the communicator, or if ghost layers are asked for a dimension without the block
+     *             distribution.
+     */
+    DistributedArray(const Communicator &com, const std::array<Dimension, N> &dimensions)
+        : m_com(com), m_dims(dimensions) {
+        build_grid();
+        std::size_t storage_size = 1;
+        for (std::size_t d = N; d-- > 0;) {
+            const Dimension &dim = m_dims[d];
+            if ((dim.ghosts > 0) && (dim.distribution != Distribution::block))
+                throw std::invalid_argument("Ghost layers need the block distribution of the dimension " +
+                                            std::to_string(d));
+            if (dim.distribution == Distribution::cyclic) m_dims[d].block_size = 1;
+            if (m_dims[d].block_size == 0) throw std::invalid_argument("Null block size");
+            m_local_shape[d] = count(d, m_coords[d]);
+            m_strides[d]     = storage_size;
+            storage_size *= m_local_shape[d] + 2 * dim.ghosts;
+        }
+        m_storage = ao::uvector<T>(storage_size);
+    }
+    /**
+     * @brief      Create an array distributed by blocks in all dimensions, with ghost layers of
+     *             the same width in all dimensions
+     */
+    DistributedArray(const Communicator &com, const index &shape, std::size_t ghosts = 0)
+        : DistributedArray(com, block_dimensions(shape, ghosts)) {}
+
+    // =============================================================================================
+    /**
+     * @brief      Global shape of the array
+     */
+    index shape() const {
+        index s;
+        for (std::size_t d = 0; d < N; ++d) s[d] = m_dims[d].size;
+        return s;
+    }
+    /**
+     * @brief      Number of elements owned by the process in each dimension ( without ghosts )
+     */
+    const index &local_shape() const { return m_local_shape; }
+    /**
+     * @brief      Number of elements owned by the process
+     */
+    std::size_t local_size() const {
+        std::size_t n = 1;
+        for (std::size_t d = 0; d < N; ++d) n *= m_local_shape[d];
+        return n;
+    }
+    /**
+     * @brief      Width of the ghost layers of the dimension d
+     */
+    std::size_t ghosts(std::size_t d) const { return m_dims[d].ghosts; }
+    /**
+     * @brief      Number of processes in each dimension
+     */
+    const std::array<int, N> &grid_shape() const { return m_grid; }
+    /**
+     * @brief      Coordinates of the process in the grid
+     */
+    const std::array<int, N> &grid_coords() const { return m_coords; }
+    /**
+     * @brief      Layout of the dimension d
+     */
+    const Dimension &dimension(std::size_t d) const { return m_dims[d]; }
+
+    // =============================================================================================
+    /**
+     * @brief      Rank of the process owning the element of global index g
+     */
+    int owner(const index &g) const {
+        std::array<int, N> coords;
+        for (std::size_t d = 0; d < N; ++d) coords[d] = owner_coord(d, g[d]);
+        return rank_of(coords);
+    }
+    /**
+     * @brief      True if the element of global index g belongs to the process
+     */
+    bool is_local(const index &g) const { return owner(g) == m_com.rank; }
+    /**
+     * @brief      Local index of the element of global index g owned by the process
+     */
+    local_index to_local(const index &g) const {
+        local_index l;
+        for (std::size_t d = 0; d < N; ++d) {
+            const std::size_t b = m_dims[d].block_size;
+            if (m_dims[d].distribution == Distribution::block)
+                l[d] = long(g[d]) - long(first(d, m_coords[d]));
+            else
+                l[d] = long((g[d] / b) / std::size_t(m_grid[d]) * b + g[d] % b);
+        }
+        return l;
+    }
+    /**
+     * @brief      Global index of the element of local index l ( ghosts included for the block
+     *             distribution )
+     */
+    index to_global(const local_index &l) const {
+        index g;
+        for (std::size_t d = 0; d < N; ++d) {
+            const std::size_t b = m_dims[d].block_size;
+            if (m_dims[d].distribution == Distribution::block)
+                g[d] = std::size_t(long(first(d, m_coords[d])) + l[d]);
+            else
+                g[d] = ((std::size_t(l[d]) / b) * std::size_t(m_grid[d]) + std::size_t(m_coords[d])) * b +
+                       std::size_t(l[d]) % b;
+        }
+        return g;
+    }
+
+    // =============================================================================================
+    /**
+     * @brief      Element of local index l ( from -ghosts to local size + ghosts in each dimension )
+     */
+    T &operator()(const local_index &l) { return m_storage[offset(l)]; }
+    const T &operator()(const local_index &l) const { return m_storage[offset(l)]; }
+    /**
+     * @brief      Element of global index g, owned by the process or in its ghost layers ( throw
+     *             std::out_of_range otherwise )
+     */
+    T &at(const index &g) { return m_storage[checked_offset(g)]; }
+    const T &at(const index &g) const { return m_storage[checked_offset(g)]; }
+    /**
+     * @brief      Storage of the elements and of the ghost layers
+     */
+    ao::uvector<T> &storage() { return m_storage; }
+    const ao::uvector<T> &storage() const { return m_storage; }
+    /**
+     * @brief      Distance in the storage between two consecutive indices of the dimension d
+     */
+    std::size_t stride(std::size_t d) const { return m_strides[d]; }
+    /**
+     * @brief      Set all the elements ( and the ghosts ) to value
+     */
+    void fill(const T &value) { std::fill(m_storage.begin(), m_storage.end(), value); }
+
+    // =============================================================================================
+    /**
+     * @brief      Copy the elements of the neighbouring processes in the ghost layers ( collective
+     *             call ). The dimensions are exchanged one after the other, each exchange including
+     *             the ghost layers of the other dimensions, so the corners are updated too. A
+     *             neighbour owning fewer elements than the ghost width only fills as many layers.
+     */
+    void update_ghosts() {
+        for (std::size_t d = 0; d < N; ++d) {
+            const long g = long(m_dims[d].ghosts);
+            if (g == 0) continue;
+            const long n = long(m_local_shape[d]);
+            // Neighbours in the dimension d : the processes owning no element are skipped
+            std::array<int, 2> neighbours = {neighbour(d, -1), neighbour(d, +1)};
+            if (n == 0) neighbours = {{-1, -1}};
+            // Each side sends as many layers as it owns ( up to the ghost width ), so the width
+            // received from a neighbour is the number of elements owned by this neighbour
+            std::array<long, 2> rcv_width = {{0, 0}};
+            std::array<ao::uvector<T>, 2> snd, rcv;
+            std::vector<Request> requests;
+            const long snd_width = std::min(g, n);
+            for (int side = 0; side < 2; ++side) {
+                if (neighbours[side] < 0) continue;
+                std::array<int, N> coords = m_coords;
+                coords[d]                 = neighbours[side];
+                rcv_width[side]           = std::min(g, long(count(d, neighbours[side])));
+                rcv[side]                 = ao::uvector<T>(slab_size(d, std::size_t(rcv_width[side])));
+                requests.push_back(
+                    m_com.irecv(rcv[side].size(), rcv[side].data(), rank_of(coords), int(2 * d + 1 - side)));
+                // Elements sent to the lower neighbour : the first layers, to the upper one : the last
+                snd[side] = ao::uvector<T>(slab_size(d, std::size_t(snd_width)));
+                copy_slab(d, (side == 0 ? 0 : n - snd_width), snd_width, snd[side].data(), true);
+                requests.push_back(
+                    m_com.isend(snd[side].size(), snd[side].data(), rank_of(coords), int(2 * d + side)));
+            }
+            for (auto &req : requests) req.wait();
+            for (int side = 0; side < 2; ++side) {
+                if (neighbours[side] < 0) continue;
+                copy_slab(d, (side == 0 ? -rcv_width[side] : n), rcv_width[side], rcv[side].data(), false);
+            }
+        }
+    }
+
+  private:
+    static std::array<Dimension, N> block_dimensions(const index &shape, std::size_t ghosts) {
+        std::array<Dimension, N> dims;
+        for (std::size_t d = 0; d < N; ++d) {
+            dims[d].size   = shape[d];
+            dims[d].ghosts = ghosts;
+        }
+        return dims;
+    }
+    // Number of processes in each dimension : the free dimensions share the remaining factor of
+    // the size of the communicator as evenly as possible ( as MPI_Dims_create )
+    void build_grid() {
+        std::vector<int> procs(N);
+        for (std::size_t d = 0; d < N; ++d) procs[d] = m_dims[d].nb_procs;
+        procs = ProcessGrid::balanced_dimensions(m_com.size, procs);
+        std::copy(procs.begin(), procs.end(), m_grid.begin());
+        int r = m_com.rank;
+        for (std::size_t d = N; d-- > 0;) {
+            m_coords[d] = r % m_grid[d];
+            r /= m_grid[d];
+        }
+    }
+    int rank_of(const std::array<int, N> &coords) const {
+        int r = 0;
+        for (std::size_t d = 0; d < N; ++d) r = r * m_grid[d] + coords[d];
+        return r;
+    }
+    // Coordinate in the dimension d of the next process owning elements in the direction dir ( -1
+    // if none )
+    int neighbour(std::size_t d, int dir) const {
+        for (int p = m_coords[d] + dir; (p >= 0) && (p < m_grid[d]); p += dir)
+            if (count(d, p) > 0) return p;
+        return -1;
+    }
+    // Number of indices of the dimension d owned by the process of coordinate p in this dimension
+    std::size_t count(std::size_t d, int p) const {
+        const std::size_t n = m_dims[d].size, np = std::size_t(m_grid[d]);
+        if (m_dims[d].distribution == Distribution::block) return n / np + (std::size_t(p) < n % np ? 1 : 0);
+        const std::size_t b = m_dims[d].block_size, nb_blocks = (n + b - 1) / b;
+        std::size_t nb      = (nb_blocks / np + (std::size_t(p) < nb_blocks % np ? 1 : 0)) * b;
+        // The last block may be incomplete
+        if ((nb_blocks > 0) && ((nb_blocks - 1) % np == std::size_t(p))) nb -= nb_blocks * b - n;
+        return nb;
+    }
+    // First global index of the block owned by the process of coordinate p ( block distribution )
+    std::size_t first(std::size_t d, int p) const {
+        const std::size_t n = m_dims[d].size, np = std::size_t(m_grid[d]);
+        return std::size_t(p) * (n / np) + std::min(std::size_t(p), n % np);
+    }
+    int owner_coord(std::size_t d, std::size_t i) const {
+        const std::size_t n = m_dims[d].size, np = std::size_t(m_grid[d]);
+        if (i >= n) throw std::out_of_range("Global index out of the array");
+        if (m_dims[d].distribution != Distribution::block) return int((i / m_dims[d].block_size) % np);
+        const std::size_t base = n / np, rem = n % np;
+        if (i < rem * (base + 1)) return int(i / (base + 1));
+        return int(rem + (i - rem * (base + 1)) / base);
+    }
+    std::size_t offset(const local_index &l) const {
+        std::size_t off = 0;
+        for (std::size_t d = 0; d < N; ++d) off += std::size_t(l[d] + long(m_dims[d].ghosts)) * m_strides[d];
+        return off;
+    }
+    std::size_t checked_offset(const index &g) const {
+        for (std::size_t d = 0; d < N; ++d) {
+            if (g[d] >= m_dims[d].size) throw std::out_of_range("Global index out of the array");
+            if (m_dims[d].distribution == Distribution::block) {
+                long l = long(g[d]) - long(first(d, m_coords[d])), w = long(m_dims[d].ghosts);
+                if ((l < -w) || (l >= long(m_local_shape[d]) + w))
+                    throw std::out_of_range("Global index neither owned nor in the ghost layers");
+            } else if (owner_coord(d, g[d]) != m_coords[d])
+                throw std::out_of_range("Global index not owned by the process");
+        }
+        return offset(to_local(g));
+    }
+    // Number of elements of a slab of width layers in the dimension d, with the ghost layers of the
+    // other dimensions
+    std::size_t slab_size(std::size_t d, std::size_t width) const {
+        std::size_t n = width;
+        for (std::size_t e = 0; e < N; ++e)
+            if (e != d) n *= m_local_shape[e] + 2 * m_dims[e].ghosts;
+        return n;
+    }
+    // Copy the layers [beg, beg + width) of the dimension d to buffer ( pack ) or from buffer
+    void copy_slab(std::size_t d, long beg, long width, T *buffer, bool pack) {
+        // Extents of the slab in the storage : whole extent with ghosts except in the dimension d
+        std::array<std::size_t, N> extent, start;
+        for (std::size_t e = 0; e < N; ++e) {
+            extent[e] = m_local_shape[e] + 2 * m_dims[e].ghosts;
+            start[e]  = 0;
+        }
+        extent[d] = std::size_t(width);
+        start[d]  = std::size_t(beg + long(m_dims[d].ghosts));
+        // The last dimension is contiguous : loop on the rows of the slab
+        const std::size_t row = extent[N - 1];
+        std::size_t nb_rows   = 1;
+        for (std::size_t e = 0; e + 1 < N; ++e) nb_rows *= extent[e];
+        std::array<std::size_t, N> pos{};
+        for (std::size_t r = 0; r < nb_rows; ++r, buffer += row) {
+            std::size_t off = start[N - 1] * m_strides[N - 1];
+            for (std::size_t e = 0; e + 1 < N; ++e) off += (start[e] + pos[e]) * m_strides[e];
+            if (pack)
+                std::copy_n(m_storage.data() + off, row, buffer);
+            else
+                std::copy_n(buffer, row, m_storage.data() + off);
+            // Next row
+            for (std::size_t e = N - 1; e-- > 0;) {
+                if (++pos[e] < extent[e]) break;
+                pos[e] = 0;
+            }
+        }
+    }
+
+    Communicator m_com;
+    std::array<Dimension, N> m_dims;
+    std::array<int, N> m_grid, m_coords;
+    index m_local_shape, m_strides;
+    ao::uvector<T> m_storage;
+};
+}
+#endif
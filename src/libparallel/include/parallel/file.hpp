@@ -0,0 +1,348 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Collective parallel I/O of distributed arrays ( MPI-IO )
+#ifndef _PARALLEL_FILE_HPP_
+#define _PARALLEL_FILE_HPP_
+#include "parallel/communicator"
+#include "parallel/distributed_array.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef USE_MPI
+#include <mpi.h>
+namespace Parallel {
+/**
+ * @brief      File holding one N-dimensional array, read and written together by all the processes
+ *             of a communicator.
+ *
+ *             The file begins with a header describing the array ( number of dimensions, global
+ *             shape, size and kind of the elements ), followed by the elements in row major order.
+ *             Each process reads or writes its own part of the array through a file view built
+ *             from the distribution of the array, with collective calls : MPI-IO merges the
+ *             requests of the processes and accesses the file by large contiguous blocks from a
+ *             few aggregator processes ( two-phase collective buffering ), so the bandwidth of all
+ *             the I/O servers of the filesystem is used instead of the bandwidth of one process.
+ *
+ * @code
+ *             {
+ *                 Parallel::File file(com, "u.dat", Parallel::File::out);
+ *                 file.write(u); // Parallel::DistributedArray<double, 2>
+ *             }
+ *             Parallel::File file(com, "u.dat", Parallel::File::in);
+ *             Parallel::DistributedArray<double, 2> v(com, file.shape<2>(), 1);
+ *             file.read(v);
+ * @endcode
+ */
+class File {
+  public:
+    enum Mode { in, out };
+    /**
+     * @brief      Description of the array stored in the file
+     */
+    struct Header {
+        std::uint32_t item_size;          /*!< Size of an element in bytes */
+        std::uint32_t kind;               /*!< 'f' floating point, 'i' signed, 'u' unsigned, 'o' other */
+        std::uint64_t data_offset;        /*!< Position of the first element in the file */
+        std::vector<std::uint64_t> shape; /*!< Global shape of the array */
+    };
+
+    /**
+     * @brief      Open the file ( collective call ). A file opened for writing is created or
+     *             truncated, a file opened for reading must begin with a valid header. Throws
+     *             std::runtime_error on failure.
+     *
+     * @param[in]  com             The processes sharing the file
+     * @param[in]  filename        Name of the file
+     * @param[in]  mode            Reading ( in ) or writing ( out )
+     * @param[in]  nb_aggregators  Number of processes accessing the file during the collective
+     *                             calls ( 0 : choice of MPI-IO )
+     */
+    File(const Communicator &com, const std::string &filename, Mode mode, int nb_aggregators = 0)
+        : m_com(com), m_mode(mode) {
+        MPI_Info info;
+        MPI_Info_create(&info);
+        MPI_Info_set(info, "romio_cb_read", "enable");
+        MPI_Info_set(info, "romio_cb_write", "enable");
+        if (nb_aggregators > 0) MPI_Info_set(info, "cb_nodes", std::to_string(nb_aggregators).c_str());
+        const MPI_Comm &comm = m_com.externalCommunicator();
+        if (mode == out) {
+            // Remove the previous file so a shorter array doesn't keep its end
+            if (m_com.rank == 0) MPI_File_delete(filename.c_str(), MPI_INFO_NULL);
+            MPI_Barrier(comm);
+        }
+        int amode = (mode == in ? MPI_MODE_RDONLY : MPI_MODE_WRONLY | MPI_MODE_CREATE);
+        int err   = MPI_File_open(comm, filename.c_str(), amode, info, &m_file);
+        MPI_Info_free(&info);
+        if (err != MPI_SUCCESS) throw std::runtime_error("Unable to open the file " + filename);
+        if (mode == in) read_header(filename);
+    }
+    File(const File &) = delete;
+    File &operator=(const File &) = delete;
+    /**
+     * @brief      Close the file ( collective call )
+     */
+    ~File() { MPI_File_close(&m_file); }
+
+    /**
+     * @brief      Description of the array read from the file, or of the last written array
+     */
+    const Header &header() const { return m_header; }
+    /**
+     * @brief      Global shape of the array stored in the file ( throw std::runtime_error if the
+     *             array hasn't N dimensions )
+     */
+    template <std::size_t N>
+    std::array<std::size_t, N> shape() const {
+        if (m_header.shape.size() != N)
+            throw std::runtime_error("Wrong number of dimensions for the array of the file");
+        std::array<std::size_t, N> s;
+        for (std::size_t d = 0; d < N; ++d) s[d] = std::size_t(m_header.shape[d]);
+        return s;
+    }
+
+    // =============================================================================================
+    /**
+     * @brief      Write the elements owned by each process of the distributed array ( collective
+     *             call, the ghost layers aren't written )
+     */
+    template <typename T, std::size_t N>
+    void write(const DistributedArray<T, N> &array) {
+        write_header<T>(to_vector(array.shape()));
+        View view(*this, file_type(array), memory_type(array));
+        check(MPI_File_write_all(m_file, array.storage().data(), 1, view.memory, MPI_STATUS_IGNORE), "write");
+    }
+    /**
+     * @brief      Read the elements owned by each process of the distributed array ( collective
+     *             call ). The array must have the shape and the type of the array of the file. The
+     *             ghost layers aren't updated.
+     */
+    template <typename T, std::size_t N>
+    void read(DistributedArray<T, N> &array) {
+        check_array<T>(to_vector(array.shape()));
+        View view(*this, file_type(array), memory_type(array));
+        check(MPI_File_read_all(m_file, array.storage().data(), 1, view.memory, MPI_STATUS_IGNORE), "read");
+    }
+    /**
+     * @brief      Write a block of an array of global shape shape ( collective call ). Each process
+     *             gives the position of its block in the array and its elements, contiguous in row
+     *             major order ( a block of a matrix for instance ). The blocks mustn't overlap.
+     */
+    template <typename T, std::size_t N>
+    void write(const std::array<std::size_t, N> &shape, const std::array<std::size_t, N> &start,
+               const std::array<std::size_t, N> &count, const T *data) {
+        write_header<T>(to_vector(shape));
+        View view(*this, (nb_items(count) > 0 ? block_type<T>(shape, start, count) : contiguous<T>(0)),
+                  contiguous<T>(1));
+        check(MPI_File_write_all(m_file, data, nb_items(count), view.memory, MPI_STATUS_IGNORE), "write");
+    }
+    /**
+     * @brief      Read a block of the array of the file ( collective call )
+     */
+    template <typename T, std::size_t N>
+    void read(const std::array<std::size_t, N> &start, const std::array<std::size_t, N> &count, T *data) {
+        std::array<std::size_t, N> shape = this->shape<N>();
+        check_array<T>(to_vector(shape));
+        View view(*this, (nb_items(count) > 0 ? block_type<T>(shape, start, count) : contiguous<T>(0)),
+                  contiguous<T>(1));
+        check(MPI_File_read_all(m_file, data, nb_items(count), view.memory, MPI_STATUS_IGNORE), "read");
+    }
+
+  private:
+    static const std::size_t magic_size       = 8;
+    static const std::uint32_t version        = 1;
+    static const std::uint64_t data_alignment = 4096;
+    static const char *magic() { return "PARARRAY"; }
+
+    template <typename T>
+    static std::uint32_t kind() {
+        return std::is_floating_point<T>::value ? 'f'
+                                                : (std::is_integral<T>::value ? (std::is_signed<T>::value ? 'i' : 'u')
+                                                                              : 'o');
+    }
+    void check(int err, const char *what) const {
+        if (err != MPI_SUCCESS) throw std::runtime_error(std::string("Collective ") + what + " of the file failed");
+    }
+    // The header : magic, version, item size, kind, number of dimensions, data offset, shape. The
+    // elements begin on a boundary of data_alignment bytes.
+    template <typename T>
+    void write_header(const std::vector<std::uint64_t> &shape) {
+        if (m_mode != out) throw std::runtime_error("The file isn't opened for writing");
+        std::uint32_t fields[4] = {version, std::uint32_t(sizeof(T)), kind<T>(), std::uint32_t(shape.size())};
+        std::vector<char> buffer(magic_size + sizeof(fields) + sizeof(std::uint64_t) * (1 + shape.size()));
+        std::uint64_t offset = (buffer.size() + data_alignment - 1) / data_alignment * data_alignment;
+        char *pt             = buffer.data();
+        std::memcpy(pt, magic(), magic_size);
+        std::memcpy(pt += magic_size, fields, sizeof(fields));
+        std::memcpy(pt += sizeof(fields), &offset, sizeof(offset));
+        std::memcpy(pt + sizeof(offset), shape.data(), sizeof(std::uint64_t) * shape.size());
+        if (m_com.rank == 0)
+            check(MPI_File_write_at(m_file, 0, buffer.data(), int(buffer.size()), MPI_BYTE, MPI_STATUS_IGNORE),
+                  "write");
+        m_header = Header{std::uint32_t(sizeof(T)), kind<T>(), offset, shape};
+    }
+    // The rank 0 reads the header and broadcasts it
+    void read_header(const std::string &filename) {
+        std::vector<std::uint64_t> fields;
+        if (m_com.rank == 0) {
+            char head[magic_size + 4 * sizeof(std::uint32_t) + sizeof(std::uint64_t)];
+            std::uint32_t values[4];
+            MPI_Status status;
+            int nb_read = 0;
+            MPI_File_read_at(m_file, 0, head, int(sizeof(head)), MPI_BYTE, &status);
+            MPI_Get_count(&status, MPI_BYTE, &nb_read);
+            std::memcpy(values, head + magic_size, sizeof(values));
+            if ((nb_read == int(sizeof(head))) && (std::memcmp(head, magic(), magic_size) == 0) &&
+                (values[0] == version)) {
+                fields.resize(3 + values[3]);
+                fields[0] = values[1];
+                fields[1] = values[2];
+                std::memcpy(&fields[2], head + magic_size + sizeof(values), sizeof(std::uint64_t));
+                MPI_File_read_at(m_file, MPI_Offset(sizeof(head)), &fields[3], int(values[3]), MPI_UINT64_T, &status);
+            }
+        }
+        std::uint64_t nb_fields = fields.size();
+        MPI_Bcast(&nb_fields, 1, MPI_UINT64_T, 0, m_com.externalCommunicator());
+        if (nb_fields == 0) throw std::runtime_error("The file " + filename + " isn't an array file");
+        fields.resize(nb_fields);
+        MPI_Bcast(fields.data(), int(nb_fields), MPI_UINT64_T, 0, m_com.externalCommunicator());
+        m_header = Header{std::uint32_t(fields[0]), std::uint32_t(fields[1]), fields[2],
+                          std::vector<std::uint64_t>(fields.begin() + 3, fields.end())};
+    }
+    template <typename T>
+    void check_array(const std::vector<std::uint64_t> &shape) const {
+        if (m_mode != in) throw std::runtime_error("The file isn't opened for reading");
+        if ((m_header.item_size != sizeof(T)) || (m_header.kind != kind<T>()))
+            throw std::runtime_error("The type of the elements doesn't match the array of the file");
+        if (m_header.shape != shape) throw std::runtime_error("The shape doesn't match the array of the file");
+    }
+    // ---------------------------------------------------------------------------------------------
+    // Derived types : an element is a contiguous block of bytes, so any trivially copyable type can
+    // be read or written
+    template <typename T>
+    static MPI_Datatype contiguous(std::size_t n) {
+        MPI_Datatype type;
+        MPI_Type_contiguous(int(n * sizeof(T)), MPI_BYTE, &type);
+        return type;
+    }
+    template <std::size_t N>
+    static std::vector<std::uint64_t> to_vector(const std::array<std::size_t, N> &shape) {
+        return std::vector<std::uint64_t>(shape.begin(), shape.end());
+    }
+    // Number of elements of a block, given as the count of the collective access
+    template <std::size_t N>
+    static int nb_items(const std::array<std::size_t, N> &count) {
+        std::size_t n = 1;
+        for (std::size_t d = 0; d < N; ++d) n *= count[d];
+        if (n > std::size_t(std::numeric_limits<int>::max()))
+            throw std::overflow_error("Too many elements in the block for a collective access of the file");
+        return int(n);
+    }
+    template <typename T, std::size_t N>
+    static MPI_Datatype block_type(const std::array<std::size_t, N> &shape, const std::array<std::size_t, N> &start,
+                                   const std::array<std::size_t, N> &count) {
+        std::array<int, N> sizes, subsizes, starts;
+        for (std::size_t d = 0; d < N; ++d) {
+            sizes[d]    = int(shape[d]);
+            subsizes[d] = int(count[d]);
+            starts[d]   = int(start[d]);
+        }
+        MPI_Datatype item = contiguous<T>(1), type;
+        MPI_Type_create_subarray(int(N), sizes.data(), subsizes.data(), starts.data(), MPI_ORDER_C, item, &type);
+        MPI_Type_free(&item);
+        return type;
+    }
+    // The owned elements inside the storage of the array ( without the ghost layers )
+    template <typename T, std::size_t N>
+    static MPI_Datatype memory_type(const DistributedArray<T, N> &array) {
+        std::array<std::size_t, N> shape, start;
+        for (std::size_t d = 0; d < N; ++d) {
+            shape[d] = array.local_shape()[d] + 2 * array.ghosts(d);
+            start[d] = array.ghosts(d);
+        }
+        if (array.local_size() == 0) return contiguous<T>(0);
+        return block_type<T>(shape, start, array.local_shape());
+    }
+    // The owned elements inside the file : in each dimension, the owned global indices are grouped
+    // in runs of consecutive indices ( one run for a block distribution, one run per block for a
+    // cyclic distribution ). The type of the dimension d repeats the type of the dimension d + 1,
+    // whose extent is the size of a slice of the global array.
+    template <typename T, std::size_t N>
+    static MPI_Datatype file_type(const DistributedArray<T, N> &array) {
+        if (array.local_size() == 0) return contiguous<T>(0);
+        MPI_Datatype type   = contiguous<T>(1);
+        MPI_Aint slice_size = MPI_Aint(sizeof(T));
+        for (std::size_t d = N; d-- > 0;) {
+            std::vector<int> lengths;
+            std::vector<MPI_Aint> displacements;
+            typename DistributedArray<T, N>::local_index l{};
+            std::size_t previous = 0;
+            for (std::size_t i = 0; i < array.local_shape()[d]; ++i) {
+                l[d]          = long(i);
+                std::size_t g = array.to_global(l)[d];
+                if ((i > 0) && (g == previous + 1))
+                    ++lengths.back();
+                else {
+                    lengths.push_back(1);
+                    displacements.push_back(MPI_Aint(g) * slice_size);
+                }
+                previous = g;
+            }
+            MPI_Datatype resized, repeated;
+            MPI_Type_create_resized(type, 0, slice_size, &resized);
+            MPI_Type_create_hindexed(int(lengths.size()), lengths.data(), displacements.data(), resized, &repeated);
+            MPI_Type_free(&resized);
+            MPI_Type_free(&type);
+            type = repeated;
+            slice_size *= MPI_Aint(array.shape()[d]);
+        }
+        return type;
+    }
+    // File view for a collective access, released at the end of the access
+    struct View {
+        View(File &file, MPI_Datatype filetype, MPI_Datatype memtype)
+            : file(file), file_type(filetype), memory(memtype) {
+            MPI_Type_commit(&file_type);
+            MPI_Type_commit(&memory);
+            int err = MPI_File_set_view(file.m_file, MPI_Offset(file.m_header.data_offset), MPI_BYTE, file_type,
+                                        "native", MPI_INFO_NULL);
+            if (err != MPI_SUCCESS) {
+                // The destructor isn't called : release the types here
+                MPI_Type_free(&file_type);
+                MPI_Type_free(&memory);
+                file.check(err, "view");
+            }
+        }
+        ~View() {
+            MPI_File_set_view(file.m_file, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+            MPI_Type_free(&file_type);
+            MPI_Type_free(&memory);
+        }
+        File &file;
+        MPI_Datatype file_type, memory;
+    };
+
+    Communicator m_com;
+    Mode m_mode;
+    MPI_File m_file;
+    Header m_header{0, 0, 0, {}};
+};
+}
+#endif
+#endif
@@ -16,6 +16,7 @@
 # define _PARALLEL_LOG_FROM_ROOT_OUTPUT_HPP_
 # include "core/logger.hpp"
 # include "parallel/communicator.hpp"
+# include "parallel/context.hpp"
 
 namespace Parallel
 {
@@ -25,7 +26,8 @@ namespace Parallel
    *details    
    *             This class wrap a sequential logger to be runned on the root process ( usually 0 but can be redefined)
    *             The root logger is used as the wrapped logger, but is only available for the root process, other process
-   *             doesn't listen for the incoming streamed messages.
+   *             doesn't listen for the incoming streamed messages. The rank is the one of the global communicator
+   *             of the creating rank ( before Context::spawn, the calling thread is a single rank ).
    * @tparam     L     The sequential loger wrapped by this class
    */
   template<typename L> class LogFromRootOutput : public Core::Logger::Listener
@@ -33,14 +35,14 @@ namespace Parallel
   public:
     template<class... Args>
     LogFromRootOutput( int flags, Args&&... args  ) :
-      Core::Logger::Listener((Parallel::Communicator().rank == 0 ?
+      Core::Logger::Listener((Parallel::Context::globalCommunicator().rank == 0 ?
 			      flags : Core::Logger::Listener::Listen_for_nothing)),
       m_listener(flags, std::forward<Args>(args)...)
     {}
     // ...............................................................................................
     template<class... Args>
     LogFromRootOutput( int flags, int root, Args&&... args  ) :
-      Core::Logger::Listener((Parallel::Communicator().rank == root ?
+      Core::Logger::Listener((Parallel::Context::globalCommunicator().rank == root ?
 			      flags : Core::Logger::Listener::Listen_for_nothing)),
       m_listener(flags, std::forward<Args>(args)...)
     {}
@@ -0,0 +1,235 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Grid of processes whose ranks are placed according to the nodes of the machine
+#ifndef _PARALLEL_PROCESS_GRID_HPP_
+#define _PARALLEL_PROCESS_GRID_HPP_
+#include "parallel/communicator"
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      N-D grid of processes placed on the nodes of the machine.
+ *
+ *             The processes of a node get a tile of the grid ( the same tile shape for all the
+ *             nodes ), chosen to minimize the number of nodes crossed by the lines of the grid, so
+ *             most of the messages of the row and column communicators stay inside the nodes. The
+ *             tiles are placed in row major order of the nodes. The processes are renumbered in
+ *             the communicator of the grid, whose rank of the process of coordinates
+ *             ( c_0, ..., c_N-1 ) is c_N-1 + P_N-1 * ( c_N-2 + ... ).
+ *
+ *             When the nodes don't hold the same number of processes or when no tile divides the
+ *             grid, the processes keep their order ( as without topology ).
+ *
+ * @code
+ *             Parallel::ProcessGrid grid(com, {p, p});
+ *             auto rowCom = grid.line(1); // Processes of the same row, ranked by column
+ *             auto colCom = grid.line(0); // Processes of the same column, ranked by row
+ * @endcode
+ */
+class ProcessGrid {
+  public:
+    /**
+     * @brief      Build the grid with the processes of com ( collective call )
+     *
+     *             Throws std::invalid_argument if the grid doesn't match the size of com.
+     *
+     * @param      com             The communicator containing the processes of the grid
+     * @param      dims            Number of processes in each direction ( 0 : balanced )
+     * @param      ranks_per_node  0 for the shared memory nodes, or number of consecutive ranks of
+     *                             com gathered in a node ( sockets, or emulation of several nodes )
+     */
+    ProcessGrid(const Communicator &com, const std::vector<int> &dims, int ranks_per_node = 0)
+        : m_dims(balanced_dimensions(com.size, dims)), m_coords(m_dims.size(), 0) {
+        int nb_procs = 1;
+        for (int n : m_dims) nb_procs *= n;
+        if (nb_procs != com.size)
+            throw std::invalid_argument("The grid of processes doesn't match the size of the communicator");
+        // Node of each process, known by the rank of its first process
+        int leader = com.rank;
+        if (ranks_per_node > 0)
+            leader = com.rank - com.rank % ranks_per_node;
+        else {
+            auto node = com.split_shared();
+            node->bcast(leader, leader, 0);
+        }
+        std::vector<int> leaders(com.size);
+        com.allgather(leader, leaders.data());
+        // Index of the node of the current process and rank inside its node
+        std::vector<int> node_sizes;
+        std::vector<int> node_of(com.size, -1);
+        int node_index = 0, local_rank = 0;
+        for (int r = 0; r < com.size; ++r) {
+            if (leaders[r] == r) {
+                node_of[r] = int(node_sizes.size());
+                node_sizes.push_back(0);
+            } else
+                node_of[r] = node_of[leaders[r]];
+            if (r == com.rank) {
+                node_index = node_of[r];
+                local_rank = node_sizes[node_of[r]];
+            }
+            ++node_sizes[node_of[r]];
+        }
+        bool uniform = true;
+        for (int n : node_sizes) uniform = uniform && (n == node_sizes.front());
+        if (uniform) m_tile = node_tile(m_dims, node_sizes.front());
+        int rank = com.rank;
+        if (!m_tile.empty()) {
+            // Coordinates of the node in the grid of the tiles, then of the process in its tile
+            std::vector<int> node_grid(m_dims.size());
+            for (std::size_t d = 0; d < m_dims.size(); ++d) node_grid[d] = m_dims[d] / m_tile[d];
+            std::vector<int> node_coords = unravel(node_index, node_grid), local_coords = unravel(local_rank, m_tile);
+            for (std::size_t d = 0; d < m_dims.size(); ++d) m_coords[d] = node_coords[d] * m_tile[d] + local_coords[d];
+            rank = rankOf(m_coords);
+        } else {
+            m_tile.assign(m_dims.size(), 1);
+            m_coords = unravel(rank, m_dims);
+        }
+        m_com.reset(new Communicator(com, 0, rank));
+    }
+    ProcessGrid(const ProcessGrid &) = delete;
+    ProcessGrid &operator=(const ProcessGrid &) = delete;
+
+    /**
+     * @brief      Communicator of the grid, whose ranks follow the row major order of the grid
+     */
+    const Communicator &communicator() const { return *m_com; }
+    int ndims() const { return int(m_dims.size()); }
+    /**
+     * @brief      Number of processes in each direction
+     */
+    const std::vector<int> &dimensions() const { return m_dims; }
+    /**
+     * @brief      Coordinates of the current process
+     */
+    const std::vector<int> &coordinates() const { return m_coords; }
+    /**
+     * @brief      Shape of the tile of the processes of a node ( 1 in each direction when the
+     *             processes aren't placed according to the nodes )
+     */
+    const std::vector<int> &node_dimensions() const { return m_tile; }
+    /**
+     * @brief      Coordinates of the process of rank rk in the communicator of the grid
+     */
+    std::vector<int> coordinates(int rk) const { return unravel(rk, m_dims); }
+    /**
+     * @brief      Rank in the communicator of the grid of the process at the coordinates coords
+     */
+    int rankOf(const std::vector<int> &coords) const {
+        int r = 0;
+        for (std::size_t d = 0; d < m_dims.size(); ++d) r = r * m_dims[d] + coords[d];
+        return r;
+    }
+    /**
+     * @brief      Communicator of the processes differing from the current process only by their
+     *             coordinate in the direction, ranked by this coordinate ( collective call )
+     */
+    std::unique_ptr<Communicator> line(int direction) const {
+        int color = 0;
+        for (std::size_t d = 0; d < m_dims.size(); ++d)
+            if (int(d) != direction) color = color * m_dims[d] + m_coords[d];
+        return std::unique_ptr<Communicator>(new Communicator(*m_com, color, m_coords[direction]));
+    }
+    // ---------------------------------------------------------------------------------------------
+    /**
+     * @brief      Balanced distribution of nbProcs processes in dims.size() directions : the null
+     *             values of dims share the remaining factor of nbProcs as evenly as possible ( as
+     *             MPI_Dims_create ). Throws std::invalid_argument if the non null values don't
+     *             divide nbProcs.
+     */
+    static std::vector<int> balanced_dimensions(int nbProcs, const std::vector<int> &dims) {
+        std::vector<int> grid(dims);
+        std::vector<std::size_t> free_dims;
+        int remaining = nbProcs;
+        for (std::size_t d = 0; d < grid.size(); ++d) {
+            if (grid[d] > 0) {
+                if (remaining % grid[d] != 0)
+                    throw std::invalid_argument("The grid of processes doesn't match the size of the communicator");
+                remaining /= grid[d];
+            } else
+                free_dims.push_back(d);
+        }
+        if (free_dims.empty()) {
+            if (remaining != 1)
+                throw std::invalid_argument("The grid of processes doesn't match the size of the communicator");
+            return grid;
+        }
+        for (std::size_t d : free_dims) grid[d] = 1;
+        // Largest prime factors first, each one to the free direction with the fewest processes
+        std::vector<int> factors;
+        for (int f = 2; f * f <= remaining; ++f)
+            while (remaining % f == 0) {
+                factors.push_back(f);
+                remaining /= f;
+            }
+        if (remaining > 1) factors.push_back(remaining);
+        for (auto it = factors.rbegin(); it != factors.rend(); ++it) {
+            std::size_t smallest = free_dims.front();
+            for (std::size_t d : free_dims)
+                if (grid[d] < grid[smallest]) smallest = d;
+            grid[smallest] *= *it;
+        }
+        return grid;
+    }
+    /**
+     * @brief      Tile of nbProcs processes dividing the grid dims which minimizes the number of
+     *             nodes crossed by the lines of the grid ( the sum of dims[d]/tile[d] weighted by
+     *             the number of lines of each direction ). Empty if no tile divides the grid.
+     */
+    static std::vector<int> node_tile(const std::vector<int> &dims, int nbProcs) {
+        std::vector<int> best, tile(dims.size(), 1);
+        double best_cost = 0.;
+        search_tile(dims, 0, nbProcs, tile, best, best_cost);
+        return best;
+    }
+
+  private:
+    static std::vector<int> unravel(int index, const std::vector<int> &dims) {
+        std::vector<int> coords(dims.size());
+        for (std::size_t d = dims.size(); d-- > 0;) {
+            coords[d] = index % dims[d];
+            index /= dims[d];
+        }
+        return coords;
+    }
+    // A line of the direction d crosses dims[d]/tile[d] nodes, and there are P/dims[d] such lines,
+    // so the cost is the sum of 1/tile[d] ( P being constant )
+    static void search_tile(const std::vector<int> &dims, std::size_t d, int remaining, std::vector<int> &tile,
+                            std::vector<int> &best, double &best_cost) {
+        if (d == dims.size()) {
+            if (remaining != 1) return;
+            double cost = 0.;
+            for (int t : tile) cost += 1. / t;
+            if (best.empty() || (cost < best_cost)) {
+                best      = tile;
+                best_cost = cost;
+            }
+            return;
+        }
+        for (int t = 1; t <= dims[d]; ++t) {
+            if ((dims[d] % t != 0) || (remaining % t != 0)) continue;
+            tile[d] = t;
+            search_tile(dims, d + 1, remaining / t, tile, best, best_cost);
+        }
+        tile[d] = 1;
+    }
+
+    std::vector<int> m_dims, m_coords, m_tile;
+    std::unique_ptr<Communicator> m_com;
+};
+}
+#endif
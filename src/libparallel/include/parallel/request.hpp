@@ -16,6 +16,8 @@
 #define _PARALLEL_REQUEST_HPP_
 #include "parallel/constantes.hpp"
 #include "parallel/status.hpp"
+#include <cstdlib>
+#include <vector>
 
 #ifdef USE_MPI
 #include <mpi.h>
@@ -60,25 +62,87 @@ class Request {
      * @return     The status of the message
      */
     Status status() const { return Status(m_status); }
+    /**
+     * @brief      Test a set of requests at once ( MPI_Testsome )
+     *
+     * @return     The indices of the requests completed by this call
+     */
+    static std::vector<std::size_t> testsome(const std::vector<Request *> &requests) {
+        std::vector<MPI_Request> handles(requests.size());
+        for (std::size_t i = 0; i < requests.size(); ++i) handles[i] = requests[i]->m_req;
+        std::vector<int> indices(requests.size());
+        std::vector<MPI_Status> statuses(requests.size());
+        int nb_completed;
+        MPI_Testsome(int(handles.size()), handles.data(), &nb_completed, indices.data(), statuses.data());
+        std::vector<std::size_t> completed;
+        if (nb_completed == MPI_UNDEFINED) return completed;
+        for (int i = 0; i < nb_completed; ++i) {
+            Request &req = *requests[indices[i]];
+            req.m_req    = handles[indices[i]];
+            req.m_status = statuses[i];
+            completed.push_back(std::size_t(indices[i]));
+        }
+        return completed;
+    }
 
   private:
-    MPI_Request m_req;
+    MPI_Request m_req = MPI_REQUEST_NULL;
     MPI_Status m_status;
 };
 // Waitall to do, not so easy !
 #elif defined(USE_PVM)
 #error("Not yet implemanted");
 #else
+#include <functional>
+#include <thread>
 namespace Parallel {
+/**
+ * @brief      Request for asynchronous message passing between the ranks of the threads implementation
+ */
 class Request {
   public:
-    Request() {}
-    bool test() { return true; }
-    void wait() {}
-    // To think about status... Some trick to do ?
-    Status status() const { return Status{.m_count = 0, .m_tag = 0, .m_error = 0}; }
+    /**
+     * @brief      Return a completed request
+     */
+    Request() = default;
+    /**
+     * @brief      Request completed when the progress function returns true ( the function
+     *             progresses the communications of the rank and fills the status )
+     */
+    Request(std::function<bool(Status &)> progress) : m_progress(std::move(progress)) {}
+    /**
+     * @brief      Test if the message is completed
+     */
+    bool test() {
+        if (m_progress && m_progress(m_status)) m_progress = nullptr;
+        return !m_progress;
+    }
+    /**
+     * @brief      Wait that the message is completed.
+     */
+    void wait() {
+        while (!test()) std::this_thread::yield();
+    }
+    /**
+     * @brief      Return the status of the message
+     */
+    Status status() const { return m_status; }
+    /**
+     * @brief      Test a set of requests at once
+     *
+     * @return     The indices of the requests completed by this call
+     */
+    static std::vector<std::size_t> testsome(const std::vector<Request *> &requests) {
+        std::vector<std::size_t> completed;
+        for (std::size_t i = 0; i < requests.size(); ++i)
+            if (requests[i]->m_progress && requests[i]->test()) completed.push_back(i);
+        return completed;
+    }
+
+  private:
+    std::function<bool(Status &)> m_progress;
+    Status m_status;
 };
-// TO DO
 #endif
 }
 #endif
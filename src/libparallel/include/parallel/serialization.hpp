@@ -0,0 +1,432 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Serialization of the objects which can't be sent as a block of bytes
+#ifndef _PARALLEL_SERIALIZATION_HPP_
+#define _PARALLEL_SERIALIZATION_HPP_
+#include "core/detect_container.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Serialization of the objects sent by the communicators.
+ *
+ *             An archive is given the parts of an object with `ar & part`, by the same function for
+ *             the serialization and the deserialization. The parts are the trivially copyable
+ *             objects ( copied as bytes ), the strings and the standard containers ( their size,
+ *             then their elements ) and the objects with a serialize member :
+ *
+ * @code
+ *             struct Mesh {
+ *                 std::string name;
+ *                 std::vector<double> coordinates;
+ *                 std::map<int, std::vector<int>> groups;
+ *                 template <typename Archive>
+ *                 void serialize(Archive &ar) { ar & name & coordinates & groups; }
+ *             };
+ *             com.send(mesh, 1); // On rank 1 : com.recv(mesh, 0);
+ * @endcode
+ *
+ *             The types which can't be changed are serialized by a specialization of Serializer.
+ *             The size of the stream is computed first ( SizeArchive ), so the serialization writes
+ *             in a single buffer allocated once ( OutputArchive ). The large contiguous blocks of
+ *             trivially copyable values ( a std::vector<double> for instance ) aren't copied : the
+ *             stream is a list of parts, either in the buffer of the archive or in the memory of
+ *             the object, sent as one message.
+ */
+namespace Serialization {
+/**
+ * @brief      Customisation point : serialization of the type T by `apply(ar, obj)`
+ */
+template <typename T, typename Enable = void>
+struct Serializer;
+
+template <typename... Ts>
+struct make_void {
+    typedef void type;
+};
+/**
+ * @brief      True for the types with a member `template <typename Archive> void serialize(Archive&)`
+ */
+template <typename T, typename Enable = void>
+struct has_serialize_member : std::false_type {};
+/**
+ * @brief      True for the containers of trivially copyable values ( sent as a buffer of values by
+ *             the communicators )
+ */
+template <typename T, typename Enable = void>
+struct is_flat_container : std::false_type {};
+/**
+ * @brief      True for the types which must be serialized to be sent
+ */
+template <typename T>
+struct needs_serialization
+    : std::integral_constant<bool, has_serialize_member<T>::value ||
+                                       (is_container<T>::value ? !is_flat_container<T>::value
+                                                               : !std::is_trivially_copyable<T>::value)> {};
+
+/**
+ * @brief      Size of the stream of an object
+ */
+class SizeArchive {
+  public:
+    static const bool is_loading = false;
+    template <typename T>
+    SizeArchive &operator&(const T &obj) {
+        Serializer<T>::apply(*this, const_cast<T &>(obj));
+        return *this;
+    }
+    void bytes(const void *, std::size_t nbBytes) {
+        m_size += nbBytes;
+        m_copied += nbBytes;
+    }
+    std::size_t size() const { return m_size; }
+    /**
+     * @brief      Size of the parts copied in the buffer of an OutputArchive
+     */
+    std::size_t copiedSize() const { return m_copied; }
+
+  private:
+    template <typename, typename>
+    friend struct Serializer;
+    void block(const void *, std::size_t nbBytes);
+    std::size_t m_size = 0, m_copied = 0;
+};
+/**
+ * @brief      Stream of an object : the parts are in the buffer of the archive or, for the large
+ *             contiguous blocks, in the memory of the object ( which mustn't change until the
+ *             stream is sent )
+ */
+class OutputArchive {
+  public:
+    static const bool is_loading = false;
+    /**
+     * @brief      Part of the stream
+     */
+    struct Part {
+        const char *data;
+        std::size_t size;
+    };
+    /**
+     * @brief      Contiguous blocks of at least zero_copy_threshold bytes aren't copied
+     */
+    static const std::size_t zero_copy_threshold = 4096;
+
+    /**
+     * @brief      Serialize the object in an archive allocated for its size
+     */
+    template <typename T>
+    explicit OutputArchive(const T &obj) {
+        SizeArchive sizes;
+        sizes & obj;
+        m_size = sizes.size();
+        m_buffer.reserve(sizes.copiedSize());
+        *this & obj;
+        close_part();
+    }
+    OutputArchive(const OutputArchive &) = delete;
+    OutputArchive &operator=(const OutputArchive &) = delete;
+    template <typename T>
+    OutputArchive &operator&(const T &obj) {
+        Serializer<T>::apply(*this, const_cast<T &>(obj));
+        return *this;
+    }
+    void bytes(const void *data, std::size_t nbBytes) {
+        const char *pt = static_cast<const char *>(data);
+        m_buffer.insert(m_buffer.end(), pt, pt + nbBytes);
+    }
+    /**
+     * @brief      Number of bytes of the stream
+     */
+    std::size_t size() const { return m_size; }
+    /**
+     * @brief      The parts of the stream, in order
+     */
+    const std::vector<Part> &parts() const { return m_parts; }
+    /**
+     * @brief      Copy the stream in a contiguous buffer
+     */
+    std::vector<char> contiguous() const {
+        std::vector<char> stream(m_size);
+        char *pt = stream.data();
+        for (const auto &part : m_parts) {
+            std::memcpy(pt, part.data, part.size);
+            pt += part.size;
+        }
+        return stream;
+    }
+
+  private:
+    template <typename, typename>
+    friend struct Serializer;
+    // Large blocks are referenced, the smaller ones are copied
+    void block(const void *data, std::size_t nbBytes) {
+        if (nbBytes < zero_copy_threshold) return bytes(data, nbBytes);
+        close_part();
+        m_parts.push_back(Part{static_cast<const char *>(data), nbBytes});
+    }
+    // The buffer doesn't move ( reserved for the copied size ), so its parts can be referenced
+    void close_part() {
+        std::size_t end = m_buffer.size();
+        if (end > m_begin_part) m_parts.push_back(Part{m_buffer.data() + m_begin_part, end - m_begin_part});
+        m_begin_part = end;
+    }
+    std::vector<char> m_buffer;
+    std::vector<Part> m_parts;
+    std::size_t m_begin_part = 0, m_size = 0;
+};
+inline void SizeArchive::block(const void *, std::size_t nbBytes) {
+    m_size += nbBytes;
+    if (nbBytes < OutputArchive::zero_copy_threshold) m_copied += nbBytes;
+}
+/**
+ * @brief      Rebuild the objects from a stream ( throws std::runtime_error if the stream is too
+ *             short )
+ */
+class InputArchive {
+  public:
+    static const bool is_loading = true;
+    InputArchive(const char *stream, std::size_t nbBytes) : m_pt(stream), m_end(stream + nbBytes) {}
+    template <typename T>
+    InputArchive &operator&(T &obj) {
+        Serializer<T>::apply(*this, obj);
+        return *this;
+    }
+    void bytes(void *data, std::size_t nbBytes) {
+        if (std::size_t(m_end - m_pt) < nbBytes) throw std::runtime_error("Truncated serialized stream");
+        std::memcpy(data, m_pt, nbBytes);
+        m_pt += nbBytes;
+    }
+    /**
+     * @brief      Number of bytes not yet read
+     */
+    std::size_t remaining() const { return std::size_t(m_end - m_pt); }
+
+  private:
+    template <typename, typename>
+    friend struct Serializer;
+    void block(void *data, std::size_t nbBytes) { bytes(data, nbBytes); }
+    const char *m_pt, *m_end;
+};
+
+// =================================================================================================
+template <typename T>
+struct has_serialize_member<T, typename make_void<decltype(std::declval<T &>().serialize(
+                                   std::declval<SizeArchive &>()))>::type> : std::true_type {};
+template <typename T>
+struct is_flat_container<T, typename make_void<typename T::value_type>::type>
+    : std::integral_constant<bool, std::is_trivially_copyable<typename T::value_type>::value &&
+                                       !has_serialize_member<typename T::value_type>::value> {};
+
+// Objects copied as bytes
+template <typename T>
+struct Serializer<T, typename std::enable_if<std::is_trivially_copyable<T>::value &&
+                                             !has_serialize_member<T>::value>::type> {
+    template <typename Archive>
+    static void apply(Archive &ar, T &obj) {
+        ar.bytes(&obj, sizeof(T));
+    }
+};
+// Objects with a serialize member
+template <typename T>
+struct Serializer<T, typename std::enable_if<has_serialize_member<T>::value>::type> {
+    template <typename Archive>
+    static void apply(Archive &ar, T &obj) {
+        obj.serialize(ar);
+    }
+};
+namespace detail {
+template <typename Archive>
+std::size_t size(Archive &ar, std::size_t n) {
+    std::uint64_t size = n;
+    ar.bytes(&size, sizeof(size));
+    return std::size_t(size);
+}
+// Contiguous storage : the trivially copyable values are copied as one block
+template <typename Archive, typename Cont>
+void contiguous(Archive &ar, Cont &cont, std::true_type) {
+    std::size_t n = size(ar, cont.size());
+    if (Archive::is_loading) cont.resize(n);
+    if (n > 0) Serializer<Cont>::block(ar, &cont[0], n * sizeof(typename Cont::value_type));
+}
+template <typename Archive, typename Cont>
+void contiguous(Archive &ar, Cont &cont, std::false_type) {
+    std::size_t n = size(ar, cont.size());
+    if (Archive::is_loading) cont.resize(n);
+    for (auto &value : cont) ar & value;
+}
+// Sequences and associative containers : the elements one after the other ( the keys are const
+// when saved, rebuilt when loaded )
+template <typename Archive, typename Cont>
+void sequence(Archive &ar, Cont &cont, std::false_type) {
+    size(ar, cont.size());
+    for (auto &value : cont) ar & value;
+}
+template <typename Archive, typename Cont>
+void sequence(Archive &ar, Cont &cont, std::true_type) {
+    std::size_t n = size(ar, cont.size());
+    cont.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+        typename Cont::value_type value;
+        ar & value;
+        cont.insert(cont.end(), std::move(value));
+    }
+}
+template <typename Archive, typename Cont>
+void associative(Archive &ar, Cont &cont, std::false_type) {
+    size(ar, cont.size());
+    for (auto &item : cont) ar & item.first & item.second;
+}
+template <typename Archive, typename Cont>
+void associative(Archive &ar, Cont &cont, std::true_type) {
+    std::size_t n = size(ar, cont.size());
+    cont.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+        typename Cont::key_type key;
+        typename Cont::mapped_type value;
+        ar & key & value;
+        cont.emplace(std::move(key), std::move(value));
+    }
+}
+template <typename Archive, typename Cont>
+void sequence(Archive &ar, Cont &cont) {
+    sequence(ar, cont, std::integral_constant<bool, Archive::is_loading>());
+}
+template <typename Archive, typename Cont>
+void associative(Archive &ar, Cont &cont) {
+    associative(ar, cont, std::integral_constant<bool, Archive::is_loading>());
+}
+template <typename T>
+struct is_block_copyable
+    : std::integral_constant<bool, std::is_trivially_copyable<T>::value && !has_serialize_member<T>::value> {};
+}
+
+template <typename C, typename Tr, typename A>
+struct Serializer<std::basic_string<C, Tr, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::basic_string<C, Tr, A> &str) {
+        detail::contiguous(ar, str, std::true_type());
+    }
+    template <typename Archive>
+    static void block(Archive &ar, const C *data, std::size_t nbBytes) {
+        ar.block(const_cast<C *>(data), nbBytes);
+    }
+};
+template <typename T, typename A>
+struct Serializer<std::vector<T, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::vector<T, A> &vec) {
+        detail::contiguous(ar, vec, detail::is_block_copyable<T>());
+    }
+    template <typename Archive>
+    static void block(Archive &ar, const T *data, std::size_t nbBytes) {
+        ar.block(const_cast<T *>(data), nbBytes);
+    }
+};
+template <typename A>
+struct Serializer<std::vector<bool, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::vector<bool, A> &vec) {
+        std::size_t n = detail::size(ar, vec.size());
+        if (Archive::is_loading) vec.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            bool value = vec[i];
+            ar.bytes(&value, sizeof(bool));
+            vec[i] = value;
+        }
+    }
+};
+template <typename T, std::size_t N>
+struct Serializer<std::array<T, N>, typename std::enable_if<!detail::is_block_copyable<T>::value>::type> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::array<T, N> &arr) {
+        for (auto &value : arr) ar & value;
+    }
+};
+template <typename T1, typename T2>
+struct Serializer<std::pair<T1, T2>,
+                  typename std::enable_if<!detail::is_block_copyable<std::pair<T1, T2>>::value>::type> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::pair<T1, T2> &p) {
+        ar & p.first & p.second;
+    }
+};
+template <typename T, typename A>
+struct Serializer<std::list<T, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::list<T, A> &cont) {
+        detail::sequence(ar, cont);
+    }
+};
+template <typename T, typename A>
+struct Serializer<std::deque<T, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::deque<T, A> &cont) {
+        detail::sequence(ar, cont);
+    }
+};
+template <typename T, typename C, typename A>
+struct Serializer<std::set<T, C, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::set<T, C, A> &cont) {
+        detail::sequence(ar, cont);
+    }
+};
+template <typename T, typename H, typename E, typename A>
+struct Serializer<std::unordered_set<T, H, E, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::unordered_set<T, H, E, A> &cont) {
+        detail::sequence(ar, cont);
+    }
+};
+template <typename K, typename T, typename C, typename A>
+struct Serializer<std::map<K, T, C, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::map<K, T, C, A> &cont) {
+        detail::associative(ar, cont);
+    }
+};
+template <typename K, typename T, typename H, typename E, typename A>
+struct Serializer<std::unordered_map<K, T, H, E, A>> {
+    template <typename Archive>
+    static void apply(Archive &ar, std::unordered_map<K, T, H, E, A> &cont) {
+        detail::associative(ar, cont);
+    }
+};
+
+/**
+ * @brief      Rebuild obj from a stream ( throws std::runtime_error if the stream doesn't match )
+ */
+template <typename T>
+void deserialize(const char *stream, std::size_t nbBytes, T &obj) {
+    InputArchive ar(stream, nbBytes);
+    ar & obj;
+    if (ar.remaining() != 0) throw std::runtime_error("The serialized stream doesn't match the received object");
+}
+}
+}
+#endif
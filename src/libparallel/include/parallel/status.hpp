@@ -18,6 +18,7 @@
 #include <mpi.h>
 #endif
 #include "parallel/constantes.hpp"
+#include <cstdlib>
 namespace Parallel {
 #if defined(USE_MPI)
 /**
@@ -84,7 +85,7 @@ struct Status {
      */
     template <typename K>
     int count() const {
-        return m_count;
+        return int(m_bytes / sizeof(K));
     }
     /*!
      *    \brief Return the identity tag of the incoming message
@@ -93,13 +94,14 @@ struct Status {
     /*!
      *    \brief Return the rank of the sender of the incoming message
      */
-    int source() const { return 0; }
+    int source() const { return m_source; }
     /*!
      *    \brief Return the error state of the incoming message.
      */
     int error() const { return m_error; }
     /// \privatesection
-    int m_count, m_tag, m_error;
+    std::size_t m_bytes = 0;
+    int m_source = 0, m_tag = 0, m_error = 0;
 };
 #endif
 }
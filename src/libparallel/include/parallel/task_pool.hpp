@@ -0,0 +1,260 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Distributed pool of tasks balanced by work stealing
+#ifndef _PARALLEL_TASK_POOL_HPP_
+#define _PARALLEL_TASK_POOL_HPP_
+#include "parallel/communicator"
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <list>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      Distributed pool of irregular tasks.
+ *
+ *             Each process executes the tasks of its own deque ( the last pushed first ). A process
+ *             whose deque is empty sends a steal request to a random process, which answers with
+ *             the older half of its deque ( or nothing ). The requests are answered between two
+ *             tasks, so a task should not last too long. The end of the work ( all the deques empty
+ *             and no task in flight ) is detected by a token going around the ring of the processes
+ *             ( Safra's algorithm ). The pool uses its own duplicate of the communicator, so its
+ *             messages never match the messages of the application.
+ *
+ * @code
+ *             Parallel::TaskPool<Leaf> pool(com, [&](const Leaf& leaf, Parallel::TaskPool<Leaf>& p) {
+ *                 if (leaf.too_large()) { p.push(leaf.left()); p.push(leaf.right()); }
+ *                 else solve(leaf);
+ *             });
+ *             if (com.rank == 0) pool.push(root_leaf);
+ *             pool.run();
+ * @endcode
+ *
+ * @tparam     K     Type of the tasks ( trivially copyable )
+ */
+template <typename K>
+class TaskPool {
+  public:
+    using Executor = std::function<void(const K &task, TaskPool &pool)>;
+
+    /**
+     * @brief      Create the pool ( collective call )
+     *
+     * @param[in]  com       The processes sharing the tasks
+     * @param[in]  executor  Function executing a task ( it can push new tasks in the pool )
+     */
+    TaskPool(const Communicator &com, Executor executor)
+        : m_com(com), m_executor(std::move(executor)), m_random(unsigned(5489 + 7919 * com.rank)) {}
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    /**
+     * @brief      Add a task to the deque of the process
+     */
+    void push(const K &task) { m_tasks.push_back(task); }
+    /**
+     * @brief      Number of tasks in the deque of the process
+     */
+    std::size_t size() const { return m_tasks.size(); }
+    /**
+     * @brief      Execute the tasks of all the processes, and return when all the tasks ( including
+     *             the tasks pushed by the executions ) are executed ( collective call )
+     */
+    void run() {
+        while (!m_terminated) {
+            poll();
+            if (!m_tasks.empty()) {
+                K task = m_tasks.back();
+                m_tasks.pop_back();
+                m_executor(task, *this);
+                ++m_nb_executed;
+                continue;
+            }
+            if (m_com.size == 1) break;
+            if (!m_waiting) request_tasks();
+            if (m_has_token) pass_token();
+            if (!m_terminated) std::this_thread::yield();
+        }
+        finish();
+    }
+
+    /**
+     * @brief      Number of tasks executed by the process
+     */
+    std::size_t nbTasksExecuted() const { return m_nb_executed; }
+    /**
+     * @brief      Number of tasks stolen by the process from the other processes
+     */
+    std::size_t nbTasksStolen() const { return m_nb_stolen; }
+    /**
+     * @brief      Number of steal requests sent by the process
+     */
+    std::size_t nbStealRequests() const { return m_nb_requests; }
+
+  private:
+    enum Tag { steal_request = 1, steal_reply, token, done, finished, leave };
+    enum Color { white = 0, black = 1 };
+    struct Token {
+        long count; // Sum of the number of task messages sent minus received by the visited processes
+        int color;
+    };
+    struct Outgoing {
+        std::vector<K> tasks;
+        Token token;
+        char signal;
+        Request request;
+    };
+
+    // Non blocking send of a message kept until it is sent
+    Outgoing &outgoing() {
+        while (!m_outgoing.empty() && m_outgoing.front().request.test()) m_outgoing.pop_front();
+        m_outgoing.emplace_back();
+        return m_outgoing.back();
+    }
+    void signal(int dest, Tag tag) {
+        Outgoing &msg = outgoing();
+        msg.request   = m_com.isend(1, &msg.signal, dest, tag);
+    }
+    void request_tasks() {
+        int victim = std::uniform_int_distribution<int>(0, m_com.size - 2)(m_random);
+        if (victim >= m_com.rank) ++victim;
+        signal(victim, steal_request);
+        m_waiting = true;
+        ++m_nb_requests;
+    }
+    // Give the older half of the deque to the thief
+    void answer(int thief) {
+        Outgoing &msg        = outgoing();
+        std::size_t nb_given = m_tasks.size() / 2;
+        msg.tasks.assign(m_tasks.begin(), m_tasks.begin() + nb_given);
+        m_tasks.erase(m_tasks.begin(), m_tasks.begin() + nb_given);
+        if (nb_given > 0) ++m_counter;
+        msg.request = m_com.isend(msg.tasks.size(), msg.tasks.data(), thief, steal_reply);
+    }
+    // The passive process holding the token forwards it along the ring. The token is white when it
+    // comes back to the rank 0 if no process received tasks during the round, and then all the tasks
+    // are executed when the counts of the sent and received task messages balance.
+    void pass_token() {
+        if (m_com.rank == 0) {
+            if (m_round_started) {
+                if ((m_token.color == white) && (m_color == white) && (m_token.count + m_counter == 0)) {
+                    for (int dest = 1; dest < m_com.size; ++dest) signal(dest, done);
+                    m_terminated = true;
+                    return;
+                }
+            }
+            m_token         = Token{0, white};
+            m_round_started = true;
+        } else {
+            m_token.count += m_counter;
+            if (m_color == black) m_token.color = black;
+        }
+        m_color       = white;
+        m_has_token   = false;
+        Outgoing &msg = outgoing();
+        msg.token     = m_token;
+        msg.request   = m_com.isend(1, &msg.token, (m_com.rank + 1) % m_com.size, token);
+    }
+    // Handle the incoming messages
+    void poll() {
+        Status status;
+        while (m_com.iprobe(status, any_source, any_tag)) handle(status);
+    }
+    void handle(const Status &status) {
+        const int source = status.source();
+        char byte;
+        switch (status.tag()) {
+        case steal_request:
+            m_com.recv(1, &byte, source, steal_request);
+            answer(source);
+            break;
+        case steal_reply: {
+            std::vector<K> tasks(std::size_t(status.count<char>()) / sizeof(K));
+            m_com.recv(tasks.size(), tasks.data(), source, steal_reply);
+            if (!tasks.empty()) {
+                --m_counter;
+                m_color = black;
+                m_nb_stolen += tasks.size();
+                m_tasks.insert(m_tasks.begin(), tasks.begin(), tasks.end());
+            }
+            m_waiting = false;
+            break;
+        }
+        case token:
+            m_com.recv(1, &m_token, source, token);
+            m_has_token = true;
+            break;
+        case done:
+            m_com.recv(1, &byte, source, done);
+            m_terminated = true;
+            break;
+        case finished:
+            m_com.recv(1, &byte, source, finished);
+            ++m_nb_finished;
+            break;
+        case leave:
+            m_com.recv(1, &byte, source, leave);
+            m_leave = true;
+            new_run();
+            break;
+        }
+    }
+    // After the termination, the pending steal requests are answered until all the processes have
+    // received the answer of their own request. The messages of the next run ( the token, the steal
+    // requests ) can come as soon as the rank 0 has sent the leave signals.
+    void finish() {
+        if (m_com.size > 1) {
+            while (m_waiting) poll();
+            if (m_com.rank == 0) {
+                while (m_nb_finished < m_com.size - 1) poll();
+                new_run();
+                for (int dest = 1; dest < m_com.size; ++dest) signal(dest, leave);
+            } else {
+                signal(0, finished);
+                while (!m_leave) poll();
+            }
+        } else
+            new_run();
+        for (auto &msg : m_outgoing) msg.request.wait();
+        m_outgoing.clear();
+        m_nb_finished = 0;
+        m_leave       = false;
+    }
+    void new_run() {
+        m_color         = white;
+        m_counter       = 0;
+        m_token         = Token{0, white};
+        m_has_token     = (m_com.rank == 0);
+        m_round_started = false;
+        m_terminated    = false;
+    }
+
+    Communicator m_com;
+    Executor m_executor;
+    std::deque<K> m_tasks;
+    std::list<Outgoing> m_outgoing;
+    std::minstd_rand m_random;
+    int m_color = white;
+    long m_counter = 0; // Number of task messages sent minus received
+    Token m_token{0, white};
+    bool m_has_token = (m_com.rank == 0), m_round_started = false, m_waiting = false, m_terminated = false,
+         m_leave = false;
+    int m_nb_finished = 0;
+    std::size_t m_nb_executed = 0, m_nb_stolen = 0, m_nb_requests = 0;
+};
+}
+#endif
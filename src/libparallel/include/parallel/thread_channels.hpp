@@ -0,0 +1,66 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Private communicators of the threads of the processes
+#ifndef _PARALLEL_THREAD_CHANNELS_HPP_
+#define _PARALLEL_THREAD_CHANNELS_HPP_
+#include "parallel/communicator"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace Parallel {
+/**
+ * @brief      One duplicate of a communicator for each thread index of the processes.
+ *
+ *             The thread t of each process communicates on the channel t, so its messages can't be
+ *             matched by the receives of the other threads ( even with any_source or any_tag ), and
+ *             the threads of a given index can run collective operations concurrently with the
+ *             other threads. The Context must provide the Multiple thread level support.
+ *
+ * @code
+ *             Parallel::ThreadChannels channels(com, omp_get_max_threads());
+ *             #pragma omp parallel
+ *             {
+ *                 Parallel::Communicator &channel = channels[omp_get_thread_num()];
+ *                 channel.send(data, (channel.rank + 1) % channel.size, 0);
+ *                 ...
+ *             }
+ * @endcode
+ */
+class ThreadChannels {
+  public:
+    /**
+     * @brief      Create nb_threads channels ( collective call, with the same number of threads on
+     *             all the processes of com )
+     */
+    ThreadChannels(const Communicator &com, int nb_threads) {
+        if (nb_threads <= 0) throw std::invalid_argument("The number of threads must be positive");
+        m_channels.reserve(nb_threads);
+        for (int t = 0; t < nb_threads; ++t) m_channels.emplace_back(new Communicator(com));
+    }
+    ThreadChannels(const ThreadChannels &) = delete;
+    ThreadChannels &operator=(const ThreadChannels &) = delete;
+
+    int size() const { return int(m_channels.size()); }
+    /**
+     * @brief      Communicator of the thread of index thread
+     */
+    Communicator &operator[](int thread) { return *m_channels.at(thread); }
+    const Communicator &operator[](int thread) const { return *m_channels.at(thread); }
+
+  private:
+    std::vector<std::unique_ptr<Communicator>> m_channels;
+};
+}
+#endif
@@ -0,0 +1,270 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Runtime of the threads implementation : the ranks are threads of the same process which exchange
+// messages through lock-free mailboxes.
+#ifndef _PARALLEL_THREAD_RUNTIME_HPP_
+#define _PARALLEL_THREAD_RUNTIME_HPP_
+#include "parallel/status.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace Parallel {
+namespace Threads {
+/**
+ * @brief      Node of an intrusive queue
+ */
+struct Node {
+    std::atomic<Node *> next{nullptr};
+};
+/**
+ * @brief      Lock-free queue with several producers ( the senders ) and one consumer ( the
+ *             receiver ), following the algorithm of D. Vyukov : a push is one atomic exchange.
+ */
+class MailBox {
+  public:
+    MailBox() : m_head(&m_stub), m_tail(&m_stub) {}
+    MailBox(const MailBox &) = delete;
+    MailBox &operator=(const MailBox &) = delete;
+    /**
+     * @brief      Add a node to the queue ( from any thread )
+     */
+    void push(Node *node);
+    /**
+     * @brief      Remove the oldest node of the queue ( only from the consumer ), or return nullptr if
+     *             the queue is empty or if a push is not finished yet.
+     */
+    Node *pop();
+
+  private:
+    std::atomic<Node *> m_head;
+    Node *m_tail;
+    Node m_stub;
+};
+// =================================================================================================
+/**
+ * @brief      Completion of a send or of a receive
+ */
+struct Completion {
+    std::atomic<bool> done{false};
+    Status status;
+};
+/**
+ * @brief      Message in a mailbox. The small messages are copied after the header ( eager protocol ),
+ *             the large messages only reference the buffer of the sender, which is waiting that the
+ *             receiver copies them directly in its own buffer ( rendezvous protocol ).
+ */
+struct Message : Node {
+    int source, tag;
+    std::size_t bytes;
+    const void *data;
+    std::shared_ptr<Completion> sender; // Not null for the rendezvous protocol
+
+    static Message *eager(int source, int tag, const void *data, std::size_t bytes);
+    static Message *rendezvous(int source, int tag, const void *data, std::size_t bytes,
+                               std::shared_ptr<Completion> sender);
+    static void release(Message *msg);
+};
+/**
+ * @brief      Mailbox of a rank for one communication context, with the matching of the messages
+ *             with the posted receives ( in the order of the posts and of the arrivals ).
+ */
+class Endpoint {
+  public:
+    Endpoint() = default;
+    Endpoint(const Endpoint &) = delete;
+    Endpoint &operator=(const Endpoint &) = delete;
+    ~Endpoint();
+
+    /**
+     * @brief      Deliver a message ( lock-free, from the sender thread )
+     */
+    void deliver(Message *msg) { m_mailbox.push(msg); }
+    /**
+     * @brief      Post a receive in buffer. The receive is completed at once if a matching message
+     *             is already arrived, else when the message arrives and the endpoint is progressed.
+     */
+    std::shared_ptr<Completion> post(int source, int tag, void *buffer, std::size_t capacity);
+    /**
+     * @brief      Look for an arrived message matching source and tag without receiving it
+     */
+    bool probe(int source, int tag, Status &status);
+    /**
+     * @brief      Match the arrived messages with the posted receives
+     */
+    void progress();
+
+  private:
+    struct Posted {
+        int source, tag;
+        void *buffer;
+        std::size_t capacity;
+        std::shared_ptr<Completion> completion;
+    };
+    void drain();
+
+    MailBox m_mailbox;
+    std::mutex m_mutex;
+    std::deque<Posted> m_posted;
+    std::deque<Message *> m_unexpected;
+};
+// =================================================================================================
+class Group;
+/**
+ * @brief      State of a rank : the endpoints of the communicators where the rank takes part, which
+ *             are progressed while the rank waits for a completion.
+ */
+class Rank {
+  public:
+    void attach(Group *group, int rank);
+    void detach(Group *group, int rank);
+    void progress();
+
+  private:
+    std::mutex m_mutex;
+    std::vector<std::pair<Group *, int>> m_endpoints;
+};
+/**
+ * @brief      Group of ranks sharing two communication contexts ( one for the point to point messages
+ *             of the user and one for the collective operations ). All the operations work on bytes.
+ */
+class Group : public std::enable_shared_from_this<Group> {
+  public:
+    enum context { user = 0, collective = 1 };
+    static const std::size_t eager_limit = 65536; /*!< Largest message sent with the eager protocol */
+    using Combine = std::function<void(const void *in, void *inout, std::size_t bytes)>;
+    // Buffer where receive the message of bytes bytes coming from source
+    using Allocate = std::function<void *(int source, std::size_t bytes)>;
+    struct Outgoing {
+        int dest;
+        const void *data;
+        std::size_t bytes;
+    };
+
+    /**
+     * @brief      Create the world group of nbRanks ranks
+     */
+    explicit Group(int nbRanks);
+    /**
+     * @brief      Create a group with some ranks of the world
+     */
+    Group(std::shared_ptr<Group> world, std::vector<Rank *> ranks);
+    Group(const Group &) = delete;
+    Group &operator=(const Group &) = delete;
+    /**
+     * @brief      Create a world group of nbRanks ranks, registered to be found from its identifier
+     */
+    static std::shared_ptr<Group> create(int nbRanks);
+    /**
+     * @brief      Group with the identifier id ( nullptr if the group is destroyed )
+     */
+    static std::shared_ptr<Group> find(int id);
+
+    int size() const { return int(m_ranks.size()); }
+    int id() const { return m_id; }
+    Rank &rank(int rk) const { return *m_ranks[rk]; }
+    Endpoint &endpoint(int rk, int ctx) { return *m_endpoints[2 * rk + ctx]; }
+    /**
+     * @brief      Rank in this group of the rank state ( undefined if missing )
+     */
+    int rank_of(const Rank &state) const;
+    /**
+     * @brief      Rank in the group other of the rank rk of this group ( undefined if missing )
+     */
+    int translate(int rk, const Group &other) const;
+    // ---------------------------------------------------------------------------------------------
+    std::shared_ptr<Completion> isend(int ctx, int rk, int dest, int tag, const void *data, std::size_t bytes);
+    std::shared_ptr<Completion> irecv(int ctx, int rk, int source, int tag, void *data, std::size_t bytes);
+    void send(int ctx, int rk, int dest, int tag, const void *data, std::size_t bytes);
+    Status recv(int ctx, int rk, int source, int tag, void *data, std::size_t bytes);
+    /**
+     * @brief      Progress the rank rk until the completion is done
+     */
+    void wait(int rk, const Completion &completion);
+    /**
+     * @brief      Progress the communications of the rank rk
+     */
+    void progress(int rk);
+    // ---------------------------------------------------------------------------------------------
+    void barrier(int rk);
+    void bcast(int rk, int root, void *data, std::size_t bytes);
+    /**
+     * @brief      Start a broadcast : the completions of the sends of the root, or of the receive of
+     *             the other ranks
+     */
+    std::vector<std::shared_ptr<Completion>> ibcast(int rk, int root, void *data, std::size_t bytes);
+    void reduce(int rk, int root, const void *snd, void *rcv, std::size_t bytes, const Combine &combine);
+    void allreduce(int rk, const void *snd, void *rcv, std::size_t bytes, const Combine &combine);
+    void gatherv(int rk, int root, const void *snd, std::size_t bytes, void *rcv,
+                 const std::vector<std::size_t> &counts);
+    void scatterv(int rk, int root, const void *snd, const std::vector<std::size_t> &counts, void *rcv,
+                  std::size_t bytes);
+    void allgatherv(int rk, const void *snd, std::size_t bytes, void *rcv, const std::vector<std::size_t> &counts);
+    void alltoallv(int rk, const void *snd, const std::vector<std::size_t> &snd_counts, void *rcv,
+                   const std::vector<std::size_t> &rcv_counts);
+    /**
+     * @brief      Sparse exchange : each rank sends its outgoing messages and receives the messages
+     *             addressed to it ( unknown in advance ) in the buffers given by allocate.
+     */
+    void sparse_exchange(int rk, const std::vector<Outgoing> &messages, const Allocate &allocate);
+    // ---------------------------------------------------------------------------------------------
+    /**
+     * @brief      Collective creation of the sub-groups of the ranks with the same color ( none if
+     *             color is undefined ), ordered by key.
+     *
+     * @return     The new group of the rank and its rank inside
+     */
+    std::pair<std::shared_ptr<Group>, int> split(int rk, int color, int key);
+    std::pair<std::shared_ptr<Group>, int> duplicate(int rk) { return split(rk, 0, rk); }
+
+  private:
+    std::shared_ptr<Group> m_world; // Keep the states of the ranks alive
+    std::vector<std::unique_ptr<Rank>> m_owned_ranks;
+    std::vector<Rank *> m_ranks;
+    std::vector<std::unique_ptr<Endpoint>> m_endpoints;
+    int m_id;
+};
+// =================================================================================================
+/**
+ * @brief      World and rank of the calling thread, and the data of this rank ( see rank_local )
+ */
+struct Process {
+    std::shared_ptr<Group> world;
+    int rank = 0;
+    std::map<std::type_index, std::shared_ptr<void>> locals;
+};
+Process &current_process();
+/**
+ * @brief      Object of type T of the rank of the calling thread, created at its first use and
+ *             destroyed at the end of the rank. Unlike a thread_local variable, the calling thread
+ *             of Context::spawn gets a new object for its rank 0, and finds its own one back
+ *             after the spawn.
+ */
+template <typename T>
+T &rank_local() {
+    std::shared_ptr<void> &slot = current_process().locals[std::type_index(typeid(T))];
+    if (!slot) slot = std::make_shared<T>();
+    return *static_cast<T *>(slot.get());
+}
+}
+}
+#endif
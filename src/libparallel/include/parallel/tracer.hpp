@@ -0,0 +1,145 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Tracing of the communications
+#ifndef _PARALLEL_TRACER_HPP_
+#define _PARALLEL_TRACER_HPP_
+#include "parallel/status.hpp"
+#include <cstdlib>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Parallel {
+class Communicator;
+/**
+ * @brief      Tracing of all the communications of a rank, to find the communication hotspots.
+ *
+ *             When the tracing is enabled, each operation of the communicators is recorded in a
+ *             ring buffer of the rank ( operation, peer, bytes, tag, start and end ) and added to
+ *             the statistics of the rank. When the parallel context is destroyed, the statistics
+ *             of all the ranks are written by the rank 0 :
+ *             - the traffic matrix : bytes sent by each rank ( row ) to each rank ( column ). The
+ *               collective operations count the data each rank sends to the others ( to the root
+ *               for gather and reduce, from the root for bcast and scatter ), the operations
+ *               depending on the algorithm of the library ( allreduce, barrier ) aren't counted ;
+ *             - the histogram of the message sizes ( in powers of two ) ;
+ *             - the number of calls, bytes, time and bandwidth per operation.
+ *
+ *             The peers are given as ranks of the world communicator. The time of a non blocking
+ *             operation is the time to post it.
+ *
+ * @code
+ *             Parallel::Context context(nargs, argv);
+ *             Parallel::Tracer::enable(); // On all the ranks
+ *             ...
+ *             // The report is written at the destruction of the context
+ * @endcode
+ */
+class Tracer {
+  public:
+    enum Call { send, isend, recv, irecv, probe, bcast, reduce, allreduce, gather, scatter, allgather, alltoall,
+                barrier, exchange, nb_calls };
+    static const int all = -1; /*!< Peer of the collective operations without root */
+    static const std::size_t default_capacity = 65536;
+    /**
+     * @brief      One traced operation ( times in seconds since the tracing was enabled )
+     */
+    struct Event {
+        Call call;
+        int peer, tag;
+        std::size_t bytes;
+        double start, end;
+    };
+
+    /**
+     * @brief      Enable the tracing for the rank ( must be called by all the ranks )
+     *
+     * @param[in]  capacity  Number of events kept in the ring buffer ( the oldest are overwritten )
+     * @param[in]  filename  File where the rank 0 writes the report at the end ( standard output if empty )
+     */
+    static void enable(std::size_t capacity = default_capacity, const std::string &filename = "");
+    static void disable();
+    static bool enabled();
+    /**
+     * @brief      Events of the ring buffer of the rank, from the oldest to the newest
+     */
+    static std::vector<Event> events();
+    /**
+     * @brief      Write on the root the statistics of all the ranks of com ( collective call )
+     */
+    static void report(std::ostream &out, const Communicator &com, int root = 0);
+    /**
+     * @brief      Write the report if the tracing is enabled, and disable it ( called by the
+     *             destructor of the context )
+     */
+    static void finalize();
+    static const char *name(Call call);
+    // =============================================================================================
+    /**
+     * @brief      Record the operation done during the life of the scope ( nothing is done if the
+     *             tracing is disabled )
+     */
+    class Scope {
+      public:
+        /**
+         * @param[in]  peer   Rank in com of the destination, the source or the root ( Tracer::all for the
+         *                    collective operations without root )
+         * @param[in]  bytes  Size of the message, or bytes sent to each rank for the collective operations
+         */
+        Scope(const Communicator &com, Call call, int peer, int tag, std::size_t bytes)
+            : m_com(enabled() ? &com : nullptr), m_call(call), m_peer(peer), m_tag(tag), m_bytes(bytes) {
+            if (m_com != nullptr) m_start = now();
+        }
+        /**
+         * @brief      Operation sending counts[i] objects of item_size bytes to the rank i
+         */
+        Scope(const Communicator &com, Call call, int peer, const std::vector<std::size_t> &counts,
+              std::size_t item_size)
+            : Scope(com, call, peer, 0, 0) {
+            m_counts    = &counts;
+            m_item_size = item_size;
+            for (auto c : counts) m_bytes += c * item_size;
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope() {
+            if (m_com != nullptr) record(*m_com, *this, now());
+        }
+        /**
+         * @brief      Complete the event with the incoming message
+         */
+        void received(const Status &status) {
+            m_peer  = status.source();
+            m_tag   = status.tag();
+            m_bytes = std::size_t(status.count<char>());
+        }
+        void setBytes(std::size_t bytes) { m_bytes = bytes; }
+
+      private:
+        friend class Tracer;
+        const Communicator *m_com;
+        Call m_call;
+        int m_peer, m_tag;
+        std::size_t m_bytes;
+        const std::vector<std::size_t> *m_counts = nullptr;
+        std::size_t m_item_size                  = 0;
+        double m_start                           = 0.;
+    };
+
+  private:
+    static double now();
+    static void record(const Communicator &com, const Scope &scope, double end);
+};
+}
+#endif
@@ -0,0 +1,298 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// One-sided communications ( remote memory access )
+#ifndef _PARALLEL_WINDOW_HPP_
+#define _PARALLEL_WINDOW_HPP_
+#include "parallel/communicator.hpp"
+#include "parallel/constantes.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#ifdef USE_MPI
+#include <mpi.h>
+namespace Parallel {
+/**
+ * @brief      Memory of each process of a communicator exposed to the other processes, which can
+ *             read ( get ), write ( put ) or update ( accumulate ) it without any action of the
+ *             target process.
+ *
+ *             The displacements in the remote memory are given in number of objects. The remote
+ *             accesses must be done inside an epoch : a fence epoch ( collective, for regular
+ *             phases ) or a passive target epoch ( lock/lock_all, for irregular accesses ). The
+ *             epoch guards open the epoch at their construction and close it at their destruction :
+ *
+ * @code
+ *             Parallel::Window<double> win(com, nbItems);
+ *             {
+ *                 Parallel::Window<double>::LockAllEpoch epoch(win);
+ *                 win.get(n, local, target, disp);
+ *                 win.flush(target); // local can be read now
+ *             }
+ * @endcode
+ *
+ * @tparam     K     Type of the exposed objects
+ */
+template <typename K>
+class Window {
+  public:
+    /**
+     * @brief      Expose nbItems objects of memory owned by the caller
+     *
+     * @param[in]  com      The processes sharing the window ( collective call )
+     * @param      base     Address of the exposed memory, must outlive the window
+     * @param[in]  nbItems  Number of exposed objects
+     */
+    Window(const Communicator &com, K *base, std::size_t nbItems) : m_data(base), m_size(nbItems) {
+        MPI_Win_create(base, MPI_Aint(nbItems * sizeof(K)), int(sizeof(K)), MPI_INFO_NULL, com.externalCommunicator(),
+                       &m_window);
+    }
+    /**
+     * @brief      Allocate and expose nbItems objects ( the memory allocated by MPI may be faster
+     *             to access remotely, and is released with the window )
+     *
+     * @param[in]  com      The processes sharing the window ( collective call )
+     * @param[in]  nbItems  Number of exposed objects
+     */
+    Window(const Communicator &com, std::size_t nbItems) : m_size(nbItems) {
+        MPI_Win_allocate(MPI_Aint(nbItems * sizeof(K)), int(sizeof(K)), MPI_INFO_NULL, com.externalCommunicator(),
+                         &m_data, &m_window);
+    }
+    Window(const Window &) = delete;
+    Window &operator=(const Window &) = delete;
+    /**
+     * @brief      Free the window ( collective call )
+     */
+    ~Window() { MPI_Win_free(&m_window); }
+
+    /**
+     * @brief      Local exposed memory
+     */
+    K *data() { return m_data; }
+    const K *data() const { return m_data; }
+    /**
+     * @brief      Number of local exposed objects
+     */
+    std::size_t size() const { return m_size; }
+    // =============================================================================================
+    /**
+     * @brief      Write nbItems objects in the memory of target, from the displacement disp
+     */
+    void put(std::size_t nbItems, const K *origin, int target, std::size_t disp) const {
+        MPI_Put(origin, count(nbItems), type(), target, MPI_Aint(disp), count(nbItems), type(), m_window);
+    }
+    void put(const K &obj, int target, std::size_t disp) const { put(1, &obj, target, disp); }
+    /**
+     * @brief      Read nbItems objects in the memory of target, from the displacement disp. The
+     *             result is available at the end of the epoch or after a flush.
+     */
+    void get(std::size_t nbItems, K *origin, int target, std::size_t disp) const {
+        MPI_Get(origin, count(nbItems), type(), target, MPI_Aint(disp), count(nbItems), type(), m_window);
+    }
+    void get(K &obj, int target, std::size_t disp) const { get(1, &obj, target, disp); }
+    /**
+     * @brief      Update atomically nbItems objects of target : remote = op(remote, origin). Only
+     *             available for the types known by MPI and the predefined operations.
+     */
+    void accumulate(std::size_t nbItems, const K *origin, int target, std::size_t disp,
+                    Operation op = Parallel::sum) const {
+        assert(!Type_MPI<K>::must_be_packed());
+        MPI_Accumulate(origin, int(nbItems), Type_MPI<K>::mpi_type(), target, MPI_Aint(disp), int(nbItems),
+                       Type_MPI<K>::mpi_type(), op, m_window);
+    }
+    void accumulate(const K &obj, int target, std::size_t disp, Operation op = Parallel::sum) const {
+        accumulate(1, &obj, target, disp, op);
+    }
+    /**
+     * @brief      Update atomically one object of target and give its previous value ( shared
+     *             counters, work distribution ). The previous value is available at the end of the
+     *             epoch or after a flush.
+     */
+    void fetch_and_op(const K &value, K &previous, int target, std::size_t disp, Operation op = Parallel::sum) const {
+        assert(!Type_MPI<K>::must_be_packed());
+        MPI_Fetch_and_op(&value, &previous, Type_MPI<K>::mpi_type(), target, MPI_Aint(disp), op, m_window);
+    }
+    /**
+     * @brief      Update atomically one object of target and return its previous value. Only inside
+     *             a passive target epoch, where the call completes the operation ( inside a fence
+     *             epoch, the previous value is only given by the fence ).
+     */
+    K fetch_and_op(const K &value, int target, std::size_t disp, Operation op = Parallel::sum) const {
+        assert(m_passive_epochs.load() > 0);
+        K previous;
+        fetch_and_op(value, previous, target, disp, op);
+        MPI_Win_flush_local(target, m_window);
+        return previous;
+    }
+    // =============================================================================================
+    /**
+     * @brief      Collective synchronisation which closes the current fence epoch and opens a new one
+     */
+    void fence() const { MPI_Win_fence(0, m_window); }
+    /**
+     * @brief      Begin a passive target epoch towards target ( shared or exclusive lock )
+     */
+    void lock(int target, bool exclusive = false) const {
+        MPI_Win_lock((exclusive ? MPI_LOCK_EXCLUSIVE : MPI_LOCK_SHARED), target, 0, m_window);
+        ++m_passive_epochs;
+    }
+    void unlock(int target) const {
+        MPI_Win_unlock(target, m_window);
+        --m_passive_epochs;
+    }
+    /**
+     * @brief      Begin a passive target epoch towards all the processes ( shared lock )
+     */
+    void lock_all() const {
+        MPI_Win_lock_all(0, m_window);
+        ++m_passive_epochs;
+    }
+    void unlock_all() const {
+        MPI_Win_unlock_all(m_window);
+        --m_passive_epochs;
+    }
+    /**
+     * @brief      Complete the pending operations towards target ( local and remote ) inside a
+     *             passive target epoch
+     */
+    void flush(int target) const { MPI_Win_flush(target, m_window); }
+    void flush_all() const { MPI_Win_flush_all(m_window); }
+    /**
+     * @brief      Synchronize the public and private copies of the local memory ( needed to read
+     *             locally data written remotely inside a passive target epoch )
+     */
+    void sync() const { MPI_Win_sync(m_window); }
+    // =============================================================================================
+    /**
+     * @brief      Fence epoch : all the processes of the window must create the guard together
+     */
+    class FenceEpoch {
+      public:
+        FenceEpoch(const Window &win) : m_win(win) { MPI_Win_fence(MPI_MODE_NOPRECEDE, m_win.m_window); }
+        FenceEpoch(const FenceEpoch &) = delete;
+        FenceEpoch &operator=(const FenceEpoch &) = delete;
+        ~FenceEpoch() { MPI_Win_fence(MPI_MODE_NOSUCCEED, m_win.m_window); }
+
+      private:
+        const Window &m_win;
+    };
+    /**
+     * @brief      Passive target epoch towards one process
+     */
+    class LockEpoch {
+      public:
+        LockEpoch(const Window &win, int target, bool exclusive = false) : m_win(win), m_target(target) {
+            m_win.lock(target, exclusive);
+        }
+        LockEpoch(const LockEpoch &) = delete;
+        LockEpoch &operator=(const LockEpoch &) = delete;
+        ~LockEpoch() { m_win.unlock(m_target); }
+
+      private:
+        const Window &m_win;
+        int m_target;
+    };
+    /**
+     * @brief      Passive target epoch towards all the processes
+     */
+    class LockAllEpoch {
+      public:
+        LockAllEpoch(const Window &win) : m_win(win) { m_win.lock_all(); }
+        LockAllEpoch(const LockAllEpoch &) = delete;
+        LockAllEpoch &operator=(const LockAllEpoch &) = delete;
+        ~LockAllEpoch() { m_win.unlock_all(); }
+
+      private:
+        const Window &m_win;
+    };
+
+  protected:
+    Window() = default;
+
+  private:
+    static MPI_Datatype type() { return (Type_MPI<K>::must_be_packed() ? MPI_BYTE : Type_MPI<K>::mpi_type()); }
+    static int count(std::size_t nbItems) {
+        return int(Type_MPI<K>::must_be_packed() ? nbItems * sizeof(K) : nbItems);
+    }
+
+  protected:
+    K *m_data;
+    std::size_t m_size;
+    MPI_Win m_window;
+    mutable std::atomic<int> m_passive_epochs{0}; // Open passive target epochs ( lock and lock_all )
+};
+// =================================================================================================
+/**
+ * @brief      Window in the memory shared by the processes of a node : each process can read and
+ *             write directly the memory of the other processes of the node, without any copy.
+ *
+ *             The communicator must contain only processes of the same node ( see
+ *             Communicator::split_shared ). The memory of the processes is contiguous, so an array
+ *             can be stored once per node, for example allocated entirely by the first process :
+ *
+ * @code
+ *             auto node = com.split_shared();
+ *             Parallel::SharedWindow<double> table(*node, node->rank == 0 ? n : 0);
+ *             if (node->rank == 0) fill(table.data());
+ *             table.fence();
+ *             const double* values = table.data(0); // n values, read by all the processes of the node
+ * @endcode
+ *
+ *             The remote operations ( put, get, ... ) and the epochs of Window are also available.
+ *
+ * @tparam     K     Type of the shared objects
+ */
+template <typename K>
+class SharedWindow : public Window<K> {
+  public:
+    /**
+     * @brief      Allocate nbItems objects in the shared memory ( collective call, the number of
+     *             objects may differ between the processes )
+     */
+    SharedWindow(const Communicator &node_com, std::size_t nbItems) : m_peers(node_com.size) {
+        this->m_size = nbItems;
+        MPI_Win_allocate_shared(MPI_Aint(nbItems * sizeof(K)), int(sizeof(K)), MPI_INFO_NULL,
+                                node_com.externalCommunicator(), &this->m_data, &this->m_window);
+        for (int rk = 0; rk < node_com.size; ++rk) {
+            MPI_Aint size;
+            int disp_unit;
+            MPI_Win_shared_query(this->m_window, rk, &size, &disp_unit, &m_peers[rk].first);
+            m_peers[rk].second = std::size_t(size) / sizeof(K);
+        }
+    }
+
+    using Window<K>::data;
+    using Window<K>::size;
+    /**
+     * @brief      Address of the memory of the process rk of the node
+     */
+    K *data(int rk) { return m_peers[rk].first; }
+    const K *data(int rk) const { return m_peers[rk].first; }
+    /**
+     * @brief      Number of objects allocated by the process rk of the node
+     */
+    std::size_t size(int rk) const { return m_peers[rk].second; }
+
+  private:
+    std::vector<std::pair<K *, std::size_t>> m_peers;
+};
+}
+#elif defined(USE_PVM)
+#error("Not yet implemanted");
+#else
+#error("The one-sided communications need the MPI implementation");
+#endif
+#endif
@@ -0,0 +1,92 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Implementation of the CartesianCommunicator class
+#if defined( USE_MPI )
+#include "parallel/cartesian_communicator.hpp"
+#include <cassert>
+#include <mpi.h>
+
+namespace Parallel {
+    CartesianCommunicator::CartesianCommunicator( const Communicator& com, const std::vector<int>& dims,
+                                                  const std::vector<bool>& periods, bool reorder )
+        : CartesianCommunicator( create( com, dims, periods, reorder ), true ) {}
+    // .............................................................................
+    CartesianCommunicator::CartesianCommunicator( const Ext_Communicator& com )
+        : CartesianCommunicator( com, false ) {}
+    // .............................................................................
+    CartesianCommunicator::CartesianCommunicator( const CartesianCommunicator& com )
+        : Communicator( com ), m_dims( com.m_dims ), m_periods( com.m_periods ), m_coords( com.m_coords ) {}
+    // .............................................................................
+    CartesianCommunicator::CartesianCommunicator( Ext_Communicator com, bool free_input ) : Communicator( com ) {
+        if ( free_input ) MPI_Comm_free( &com );
+        int ndims;
+        MPI_Cartdim_get( externalCommunicator( ), &ndims );
+        std::vector<int> periods( ndims );
+        m_dims.resize( ndims );
+        m_coords.resize( ndims );
+        MPI_Cart_get( externalCommunicator( ), ndims, m_dims.data( ), periods.data( ), m_coords.data( ) );
+        m_periods.assign( periods.begin( ), periods.end( ) );
+    }
+    // .............................................................................
+    Ext_Communicator CartesianCommunicator::create( const Communicator& com, const std::vector<int>& dims,
+                                                    const std::vector<bool>& periods, bool reorder ) {
+        assert( dims.size( ) == periods.size( ) );
+        std::vector<int> grid = balancedDimensions( com.size, dims );
+        std::vector<int> cyclic( periods.begin( ), periods.end( ) );
+        MPI_Comm cart;
+        MPI_Cart_create( com.externalCommunicator( ), int( grid.size( ) ), grid.data( ), cyclic.data( ),
+                         ( reorder ? 1 : 0 ), &cart );
+        assert( cart != MPI_COMM_NULL );
+        return cart;
+    }
+    // =============================================================================
+    std::vector<int> CartesianCommunicator::balancedDimensions( int nbProcs, const std::vector<int>& dims ) {
+        std::vector<int> grid( dims );
+        MPI_Dims_create( nbProcs, int( grid.size( ) ), grid.data( ) );
+        return grid;
+    }
+    // .............................................................................
+    std::vector<int> CartesianCommunicator::coordinates( int rk ) const {
+        std::vector<int> coords( m_dims.size( ) );
+        MPI_Cart_coords( externalCommunicator( ), rk, int( coords.size( ) ), coords.data( ) );
+        return coords;
+    }
+    // .............................................................................
+    int CartesianCommunicator::rankOf( const std::vector<int>& coords ) const {
+        assert( coords.size( ) == m_dims.size( ) );
+        std::vector<int> wrapped( coords );
+        for ( std::size_t d = 0; d < m_dims.size( ); ++d ) {
+            if ( ( wrapped[d] >= 0 ) && ( wrapped[d] < m_dims[d] ) ) continue;
+            if ( !m_periods[d] ) return proc_null;
+            wrapped[d] = ( ( wrapped[d] % m_dims[d] ) + m_dims[d] ) % m_dims[d];
+        }
+        int rk;
+        MPI_Cart_rank( externalCommunicator( ), wrapped.data( ), &rk );
+        return rk;
+    }
+    // .............................................................................
+    std::pair<int, int> CartesianCommunicator::shift( int direction, int displacement ) const {
+        int source, dest;
+        MPI_Cart_shift( externalCommunicator( ), direction, displacement, &source, &dest );
+        return {source, dest};
+    }
+    // .............................................................................
+    int CartesianCommunicator::neighbor( const std::vector<int>& offset ) const {
+        assert( offset.size( ) == m_coords.size( ) );
+        std::vector<int> coords( m_coords );
+        for ( std::size_t d = 0; d < coords.size( ); ++d ) coords[d] += offset[d];
+        return rankOf( coords );
+    }
+}
+#endif
@@ -13,8 +13,13 @@
 // limitations under the License.
 // Implementation of the Communicator class
 #include "parallel/communicator.hpp"
+#include "parallel/context.hpp"
+#include "parallel/tracer.hpp"
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <map>
+#include <mutex>
 #include "core/std_cpp_chronometer.hpp"
 
 #if defined( USE_MPI )
@@ -22,7 +27,7 @@
 #elif defined( USE_PVM )
 #include "parallel/communicator_pvm.tpp"
 #else
-#include "parallel/communicator_stub.tpp"
+#include "parallel/communicator_threads.tpp"
 #endif
 
 namespace Parallel {
@@ -63,17 +68,37 @@ namespace Parallel {
         return m_pt_impl->pt_current_chronometer->stop( );
     }
     // ........................................................................
+    namespace {
+        // Same layout as Core::Chronometer::print
+        void print_times( std::ostream& out, unsigned long nb_calls, double total_time ) {
+            out << "Time per call : " << total_time / nb_calls << "\t Number of calls : " << nb_calls
+                << "\t Total time : " << total_time << "\t";
+        }
+    }
     std::ostream& Communicator::Chronometer::print( std::ostream& out ) const {
+        std::lock_guard<std::mutex> lock( m_pt_impl->m_mutex );
+        unsigned long nb_calls   = 0UL;
+        double        total_time = 0.;
         out << "---------------->" << std::endl;
         out << "\t Communication Details : " << std::endl;
         out << "\t ===================== " << std::endl;
+        for ( const auto& item : m_pt_impl->m_records ) {
+            out << "\t\t [ " << item.first << " ] => ";
+            print_times( out, item.second.nb_calls, item.second.total_time );
+            out << std::endl;
+            nb_calls += item.second.nb_calls;
+            total_time += item.second.total_time;
+        }
         for ( const auto& item : m_pt_impl->m_chronos ) {
             out << "\t\t [ " << item.first << " ] => ";
             out << *( item.second ) << std::endl;
         }
         out << "\t Communication Summaries : " << std::endl;
         out << "\t =======================" << std::endl << "\t\t";
-        Core::Chronometer::print( out );
+        if ( nb_calls > 0 )
+            print_times( out, nb_calls, total_time );
+        else
+            Core::Chronometer::print( out );
         out << "\n<----------------" << std::endl;
         return out;
     }
@@ -82,23 +107,42 @@ namespace Parallel {
     // -----------------------------------------------------------------------------
     void Communicator::Chronometer::deactivate( ) { m_pt_impl->is_activated = false; }
     // ========================================================================
-    Communicator::Communicator( ) : m_impl( new Communicator::Implementation ) {
+    namespace {
+        // Creation of the implementation of a communicator, whose time is added to the startup phase
+        template <typename Create>
+        auto timed_creation( Context::startup_phase phase, const Create& create ) -> decltype( create( ) ) {
+            auto start  = std::chrono::steady_clock::now( );
+            auto pt_com = create( );
+            Context::recordStartup( phase, std::chrono::duration<double>( std::chrono::steady_clock::now( ) - start ).count( ) );
+            return pt_com;
+        }
+    }
+    Communicator::Communicator( )
+        : m_impl( timed_creation( Context::Duplication, [] { return new Communicator::Implementation; } ) ) {
         rank = m_impl->getRank( );
         size = m_impl->getSize( );
     }
     // .............................................................................
     Communicator::Communicator( const Communicator& com, int color, int key )
-        : m_impl( new Communicator::Implementation( *com.m_impl, color, key ) ) {
+        : m_impl( timed_creation( Context::Split,
+                                  [&] { return new Communicator::Implementation( *com.m_impl, color, key ); } ) ) {
         rank = m_impl->getRank( );
         size = m_impl->getSize( );
     }
     // .............................................................................
-    Communicator::Communicator( const Communicator& com ) : m_impl( new Communicator::Implementation( *com.m_impl ) ) {
+    Communicator::Communicator( const Communicator& com )
+        : m_impl( timed_creation( Context::Duplication, [&] { return new Communicator::Implementation( *com.m_impl ); } ) ) {
         rank = m_impl->getRank( );
         size = m_impl->getSize( );
     }
     // .............................................................................
-    Communicator::Communicator( const Ext_Communicator& excom ) : m_impl( new Communicator::Implementation( excom ) ) {
+    Communicator::Communicator( const Ext_Communicator& excom )
+        : m_impl( timed_creation( Context::Duplication, [&] { return new Communicator::Implementation( excom ); } ) ) {
+        rank = m_impl->getRank( );
+        size = m_impl->getSize( );
+    }
+    // .............................................................................
+    Communicator::Communicator( Communicator::Implementation* impl ) : m_impl( impl ) {
         rank = m_impl->getRank( );
         size = m_impl->getSize( );
     }
@@ -124,12 +168,51 @@ namespace Parallel {
                                 tr_ranks.data( ) );
         return tr_ranks;
     }
+    // .............................................................................
+    int Communicator::worldRank( int rk ) const { return m_impl->world_rank( rk ); }
+    // .............................................................................
+    const Ext_Communicator& Communicator::externalCommunicator( ) const { return m_impl->get_ext_comm( ); }
+    // .............................................................................
+    std::unique_ptr<Communicator> Communicator::split_shared( ) const {
+        return std::unique_ptr<Communicator>(
+            new Communicator( timed_creation( Context::Split, [this] { return m_impl->split_shared( ); } ) ) );
+    }
     // -----------------------------------------------------------------------------
     void Communicator::set_pt_chrono( Communicator::Chronometer* pt_chrono ) { m_impl->m_pt_active_chrono = pt_chrono; }
     // =============================================================================
-    void Communicator::barrier( ) const { m_impl->barrier( ); }
+    void Communicator::setPipelinedBroadcast( std::size_t threshold, std::size_t segment_size, BroadcastTree tree ) {
+        m_impl->set_pipelined_broadcast( threshold, segment_size, tree );
+    }
+    // ------------------------------------------------------------------------------------
+    void Communicator::setHierarchicalCollectives( std::size_t threshold, int ranks_per_node ) {
+        m_impl->set_hierarchical_collectives( threshold, ranks_per_node );
+    }
+    // ------------------------------------------------------------------------------------
+    void Communicator::setCompression( std::size_t threshold ) { m_impl->set_compression( threshold ); }
+    // ------------------------------------------------------------------------------------
+    std::size_t Communicator::compressionThreshold( ) const { return m_impl->compression_threshold( ); }
+    // ------------------------------------------------------------------------------------
+    namespace {
+        std::atomic<std::size_t> max_count( Communicator::default_max_count );
+    }
+    void Communicator::setMaxCount( std::size_t count ) {
+        assert( ( count > 0 ) && ( count <= default_max_count ) );
+        max_count = count;
+    }
+    // ------------------------------------------------------------------------------------
+    std::size_t Communicator::maxCount( ) { return max_count; }
+    // -----------------------------------------------------------------------------
+    void Communicator::barrier( ) const {
+        Tracer::Scope trace( *this, Tracer::barrier, Tracer::all, 0, 0 );
+        m_impl->barrier( );
+    }
     // ========================================================================
-    Status Communicator::probe( int source, int tag ) { return m_impl->probe( source, tag ); }
+    Status Communicator::probe( int source, int tag ) {
+        Tracer::Scope trace( *this, Tracer::probe, source, tag, 0 );
+        Status        status = m_impl->probe( source, tag );
+        trace.received( status );
+        return status;
+    }
     // ------------------------------------------------------------------------------------
     bool Communicator::iprobe( Status& status, int source, int tag ) { return m_impl->iprobe( source, tag, status ); }
 }
@@ -0,0 +1,166 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Implementation of the compression of the floating point buffers
+#include "parallel/compression.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace Parallel {
+    namespace Compression {
+        namespace {
+            // Header of the stream : number of values, size of a value, encoding
+            const std::size_t header_size = sizeof( std::uint64_t ) + 2;
+            enum Encoding : unsigned char { raw = 0, xor_shuffle = 1 };
+            // ........................................................................................
+            // The null bytes are written as a zero followed by the length of the run ( minus one ) in
+            // base 128 ( the high bit tells if a byte follows )
+            unsigned char* write_run( std::size_t length, unsigned char* out ) {
+                *out++        = 0;
+                std::size_t n = length - 1;
+                while ( n >= 0x80 ) {
+                    *out++ = static_cast<unsigned char>( ( n & 0x7F ) | 0x80 );
+                    n >>= 7;
+                }
+                *out++ = static_cast<unsigned char>( n );
+                return out;
+            }
+            // ........................................................................................
+            // Length of the run of null bytes beginning at pt ( eight bytes are tested at once )
+            std::size_t null_run( const unsigned char* pt, const unsigned char* end ) {
+                const unsigned char* start = pt;
+                while ( end - pt >= 8 ) {
+                    std::uint64_t word;
+                    std::memcpy( &word, pt, 8 );
+                    if ( word != 0 ) break;
+                    pt += 8;
+                }
+                while ( ( pt < end ) && ( *pt == 0 ) ) ++pt;
+                return std::size_t( pt - start );
+            }
+            // ........................................................................................
+            template <typename Word>
+            std::vector<unsigned char> encode( std::size_t nbItems, const void* values ) {
+                const std::size_t nbBytes = nbItems * sizeof( Word );
+                // Xor with the previous value
+                std::vector<Word> deltas( nbItems );
+                std::memcpy( deltas.data( ), values, nbBytes );
+                for ( std::size_t i = nbItems; i > 1; --i ) deltas[i - 1] ^= deltas[i - 2];
+                // Shuffle the bytes : plane b holds the byte b of all the values
+                std::vector<unsigned char> planes( nbBytes );
+                for ( std::size_t b = 0; b < sizeof( Word ); ++b ) {
+                    unsigned char* plane = planes.data( ) + b * nbItems;
+                    for ( std::size_t i = 0; i < nbItems; ++i ) plane[i] = static_cast<unsigned char>( deltas[i] >> ( 8 * b ) );
+                }
+                // Encode the runs of null bytes ( a run takes at most 11 bytes )
+                std::vector<unsigned char> out( header_size + nbBytes + 16 );
+                std::uint64_t              n = nbItems;
+                std::memcpy( out.data( ), &n, sizeof( n ) );
+                out[sizeof( n )]           = static_cast<unsigned char>( sizeof( Word ) );
+                out[sizeof( n ) + 1]       = xor_shuffle;
+                unsigned char*       pt  = out.data( ) + header_size;
+                const unsigned char* in  = planes.data( );
+                const unsigned char* end = in + nbBytes;
+                // Offsets are compared rather than pointers : the limit is before the buffer for the tiny messages
+                const std::size_t limit = header_size + nbBytes;
+                while ( ( in < end ) && ( std::size_t( pt - out.data( ) ) + 11 < limit ) ) {
+                    if ( *in != 0 )
+                        *pt++ = *in++;
+                    else {
+                        std::size_t length = null_run( in, end );
+                        pt                 = write_run( length, pt );
+                        in += length;
+                    }
+                }
+                if ( in == end ) {
+                    out.resize( std::size_t( pt - out.data( ) ) );
+                    return out;
+                }
+                // Incompressible values are kept as is
+                out.resize( header_size + nbBytes );
+                out[sizeof( n ) + 1] = raw;
+                std::memcpy( out.data( ) + header_size, values, nbBytes );
+                return out;
+            }
+            // ........................................................................................
+            template <typename Word>
+            void decode( std::size_t nbBytes, const unsigned char* stream, std::size_t nbItems, void* values ) {
+                std::uint64_t n;
+                if ( nbBytes < header_size ) throw std::runtime_error( "Truncated compressed stream" );
+                std::memcpy( &n, stream, sizeof( n ) );
+                if ( ( n != nbItems ) || ( stream[sizeof( n )] != sizeof( Word ) ) )
+                    throw std::runtime_error( "The compressed stream doesn't match the receive buffer" );
+                const std::size_t    size = nbItems * sizeof( Word );
+                const unsigned char* pt   = stream + header_size;
+                const unsigned char* end  = stream + nbBytes;
+                if ( stream[sizeof( n ) + 1] == raw ) {
+                    if ( std::size_t( end - pt ) != size ) throw std::runtime_error( "Truncated compressed stream" );
+                    std::memcpy( values, pt, size );
+                    return;
+                }
+                std::vector<unsigned char> planes( size, 0 );
+                unsigned char*             out     = planes.data( );
+                unsigned char*             out_end = out + size;
+                while ( ( pt < end ) && ( out < out_end ) ) {
+                    if ( *pt != 0 ) {
+                        *out++ = *pt++;
+                        continue;
+                    }
+                    ++pt;
+                    std::size_t length = 0;
+                    int         shift  = 0;
+                    while ( pt < end ) {
+                        if ( shift > 63 ) throw std::runtime_error( "Corrupted compressed stream" );
+                        unsigned char c = *pt++;
+                        length |= std::size_t( c & 0x7F ) << shift;
+                        shift += 7;
+                        if ( ( c & 0x80 ) == 0 ) break;
+                    }
+                    if ( length >= std::size_t( out_end - out ) ) {
+                        if ( length + 1 != std::size_t( out_end - out ) )
+                            throw std::runtime_error( "Corrupted compressed stream" );
+                        out = out_end;
+                        break;
+                    }
+                    out += length + 1; // planes is already null
+                }
+                if ( ( pt != end ) || ( out != out_end ) ) throw std::runtime_error( "Corrupted compressed stream" );
+                // Gather the bytes of each value and undo the xor
+                std::vector<Word> deltas( nbItems, 0 );
+                for ( std::size_t b = 0; b < sizeof( Word ); ++b ) {
+                    const unsigned char* plane = planes.data( ) + b * nbItems;
+                    for ( std::size_t i = 0; i < nbItems; ++i ) deltas[i] |= Word( plane[i] ) << ( 8 * b );
+                }
+                for ( std::size_t i = 1; i < nbItems; ++i ) deltas[i] ^= deltas[i - 1];
+                std::memcpy( values, deltas.data( ), size );
+            }
+        }
+        // ============================================================================================
+        std::vector<unsigned char> compress( std::size_t nbItems, const float* values ) {
+            return encode<std::uint32_t>( nbItems, values );
+        }
+        // --------------------------------------------------------------------------------------------
+        std::vector<unsigned char> compress( std::size_t nbItems, const double* values ) {
+            return encode<std::uint64_t>( nbItems, values );
+        }
+        // --------------------------------------------------------------------------------------------
+        void decompress( std::size_t nbBytes, const unsigned char* stream, std::size_t nbItems, float* values ) {
+            decode<std::uint32_t>( nbBytes, stream, nbItems, values );
+        }
+        // --------------------------------------------------------------------------------------------
+        void decompress( std::size_t nbBytes, const unsigned char* stream, std::size_t nbItems, double* values ) {
+            decode<std::uint64_t>( nbBytes, stream, nbItems, values );
+        }
+    }
+}
@@ -0,0 +1,86 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Startup times of the process, common to all the implementations
+#include "parallel/context.hpp"
+#include <mutex>
+#if defined( USE_THREADS )
+#include "parallel/thread_runtime.hpp"
+#endif
+
+namespace Parallel {
+    namespace {
+        struct StartupRecords {
+            std::mutex             mutex;
+            Context::StartupRecord records[Context::nb_startup_phases] = {};
+            bool                   ended                               = false;
+        };
+        StartupRecords& startup_records( ) {
+#if defined( USE_THREADS )
+            // Each rank is a thread of the process
+            return Threads::rank_local<StartupRecords>( );
+#else
+            static StartupRecords records;
+            return records;
+#endif
+        }
+        const char* startup_labels[Context::nb_startup_phases] = {
+            "Initialization of the library", "Duplication of communicators", "Split of communicators"};
+    }
+    // ...............................................................................................
+    void Context::recordStartup( startup_phase phase, double time ) {
+        StartupRecords&             startup = startup_records( );
+        std::lock_guard<std::mutex> lock( startup.mutex );
+        if ( startup.ended ) return;
+        startup.records[phase].nb_calls += 1;
+        startup.records[phase].total_time += time;
+    }
+    // ...............................................................................................
+    void Context::endStartup( ) {
+        StartupRecords&             startup = startup_records( );
+        std::lock_guard<std::mutex> lock( startup.mutex );
+        startup.ended = true;
+    }
+    // ...............................................................................................
+    bool Context::startupEnded( ) {
+        StartupRecords&             startup = startup_records( );
+        std::lock_guard<std::mutex> lock( startup.mutex );
+        return startup.ended;
+    }
+    // ...............................................................................................
+    Context::StartupRecord Context::startupTime( startup_phase phase ) {
+        StartupRecords&             startup = startup_records( );
+        std::lock_guard<std::mutex> lock( startup.mutex );
+        return startup.records[phase];
+    }
+    // ...............................................................................................
+    std::ostream& Context::StartupChronometer::print( std::ostream& out ) const {
+        double total_time = 0.;
+        out << "---------------->" << std::endl;
+        // Without the end of the startup, the creations of the whole run are recorded
+        out << "\t Startup Details" << ( startupEnded( ) ? "" : " ( whole run, Context::endStartup not called )" )
+            << " : " << std::endl;
+        out << "\t =============== " << std::endl;
+        for ( int phase = 0; phase < nb_startup_phases; ++phase ) {
+            StartupRecord record = startupTime( startup_phase( phase ) );
+            out << "\t\t [ " << startup_labels[phase] << " ] => Number of calls : " << record.nb_calls
+                << "\t Total time : " << record.total_time << std::endl;
+            total_time += record.total_time;
+        }
+        out << "\t Startup Summary : " << std::endl;
+        out << "\t ===============" << std::endl << "\t\t";
+        out << "Total time : " << total_time;
+        out << "\n<----------------" << std::endl;
+        return out;
+    }
+}
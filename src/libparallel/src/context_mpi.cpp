@@ -13,12 +13,74 @@
 // limitations under the License.
 #if defined( USE_MPI )
 #include "parallel/context.hpp"
+#include <algorithm>
+#include <chrono>
 #include <mpi.h>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "parallel/tracer.hpp"
 #if defined( PARALLEL_TRACE )
 #include "core/logger.hpp"
 #endif
 namespace Parallel {
-    Communicator *Context::pt_global_com = nullptr;
+    // The progress thread owns a receive, on a private communicator, which is only matched when the
+    // thread is stopped. Testing this request enters the progress engine of the MPI library, which
+    // advances all the pending communications of the process.
+    class Context::ProgressThread {
+    public:
+        ProgressThread( double interval, int core ) : m_interval( interval ) {
+            MPI_Comm_dup( MPI_COMM_SELF, &m_comm );
+            MPI_Irecv( &m_stop, 1, MPI_INT, 0, 0, m_comm, &m_request );
+            m_thread = std::thread( [this, core]( ) {
+                if ( core >= 0 ) pin( core );
+                run( );
+            } );
+        }
+        ~ProgressThread( ) {
+            int stop = 1;
+            MPI_Send( &stop, 1, MPI_INT, 0, 0, m_comm );
+            m_thread.join( );
+            MPI_Comm_free( &m_comm );
+        }
+
+    private:
+        static void pin( int core ) {
+#if defined( __linux__ )
+            cpu_set_t cpus;
+            CPU_ZERO( &cpus );
+            CPU_SET( core, &cpus );
+            pthread_setaffinity_np( pthread_self( ), sizeof( cpu_set_t ), &cpus );
+#endif
+        }
+        void run( ) {
+            auto interval = std::chrono::duration<double>( m_interval );
+            for ( ;; ) {
+                int completed, index;
+                MPI_Testsome( 1, &m_request, &completed, &index, MPI_STATUSES_IGNORE );
+                if ( completed > 0 ) break;
+                if ( m_interval > 0. )
+                    std::this_thread::sleep_for( interval );
+                else
+                    std::this_thread::yield( );
+            }
+        }
+
+        double      m_interval;
+        MPI_Comm    m_comm;
+        MPI_Request m_request;
+        int         m_stop = 0;
+        std::thread m_thread;
+    };
+    // ...............................................................................................
+    std::atomic<Communicator *> Context::pt_global_com( nullptr );
+    namespace {
+        std::mutex global_com_mutex;
+    }
     Context::Context( int &nargc, char *argv[], bool isMultithreaded )
         : Context::Context(
               nargc, argv, ( isMultithreaded ? Context::thread_support::Multiple : Context::thread_support::Single ) ) {
@@ -30,6 +92,7 @@ namespace Parallel {
         Core::Logger log;
         log << LogTrace << "Parallel context initialization with MPI" << std::endl;
 #endif
+        auto start = std::chrono::steady_clock::now( );
         if ( thread_level_support == Context::thread_support::Single )
             MPI_Init( &nargc, &argv );
         else {
@@ -47,12 +110,13 @@ namespace Parallel {
             default:
                 level_support = MPI_THREAD_MULTIPLE;
             }
+            // The requested level only : a higher level may slow down all the communications
             int provided;
-            MPI_Init_thread( &nargc, &argv, MPI_THREAD_MULTIPLE, &provided );
+            MPI_Init_thread( &nargc, &argv, level_support, &provided );
 #if defined( PARALLEL_TRACE )
             log << " Compability level : " << provided << std::endl;
 #endif
-            if ( provided < MPI_THREAD_SERIALIZED )
+            if ( provided < std::min( level_support, int( MPI_THREAD_SERIALIZED ) ) )
                 throw std::runtime_error(
                     "Not found multithreaded mode for "
                     "the current MPI library" );
@@ -67,19 +131,41 @@ namespace Parallel {
                 m_provided = Context::thread_support::Multiple;
             }
         }
+        recordStartup( Initialization, std::chrono::duration<double>( std::chrono::steady_clock::now( ) - start ).count( ) );
     }
     // ...............................................................................................
     Context::~Context( ) {
+        stopProgressThread( );
+        Tracer::finalize( );
 #if defined( PARALLEL_TRACE )
         Core::Logger log;
         log << LogTrace << "Stop MPI context" << std::endl;
 #endif
+        delete pt_global_com.exchange( nullptr );
         MPI_Finalize( );
     }
     // ...............................................................................................
+    void Context::startProgressThread( double interval, int core ) {
+        if ( m_provided != thread_support::Multiple )
+            throw std::runtime_error( "The progress thread needs the multiple thread level support" );
+        stopProgressThread( );
+        m_progress.reset( new ProgressThread( interval, core ) );
+    }
+    // ...............................................................................................
+    void Context::stopProgressThread( ) { m_progress.reset( ); }
+    // ...............................................................................................
+    // Double checked creation : the lock is only taken until the communicator exists
     const Communicator &Context::globalCommunicator( ) {
-        if ( pt_global_com == nullptr ) pt_global_com = new Communicator;
-        return *pt_global_com;
+        Communicator *pt_com = pt_global_com.load( std::memory_order_acquire );
+        if ( pt_com == nullptr ) {
+            std::lock_guard<std::mutex> lock( global_com_mutex );
+            pt_com = pt_global_com.load( std::memory_order_relaxed );
+            if ( pt_com == nullptr ) {
+                pt_com = new Communicator;
+                pt_global_com.store( pt_com, std::memory_order_release );
+            }
+        }
+        return *pt_com;
     }
 }
 #endif
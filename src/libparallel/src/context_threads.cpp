@@ -0,0 +1,110 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#if defined( USE_THREADS )
+#include "parallel/context.hpp"
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "parallel/thread_runtime.hpp"
+#include "parallel/tracer.hpp"
+#if defined( PARALLEL_TRACE )
+#include "core/logger.hpp"
+#endif
+namespace Parallel {
+    // The ranks copy the messages themselves : there is no library to drive
+    class Context::ProgressThread {};
+    // ...............................................................................................
+    std::atomic<Communicator *> Context::pt_global_com( nullptr );
+    Context::Context( int &nargc, char *argv[], bool isMultithreaded )
+        : Context::Context(
+              nargc, argv, ( isMultithreaded ? Context::thread_support::Multiple : Context::thread_support::Single ) ) {
+    }
+    // ...............................................................................................
+    // Outside of Context::spawn, the program is the only rank of its world ( the arguments aren't
+    // used )
+    Context::Context( int &, char *[], Context::thread_support thread_level_support )
+        : m_provided( thread_level_support ) {
+        auto              start   = std::chrono::steady_clock::now( );
+        Threads::Process &process = Threads::current_process( );
+        if ( !process.world ) {
+            process.world = Threads::Group::create( 1 );
+            process.rank  = 0;
+        }
+        recordStartup( Initialization, std::chrono::duration<double>( std::chrono::steady_clock::now( ) - start ).count( ) );
+#if defined( PARALLEL_TRACE )
+        Core::Logger log;
+        log << LogTrace << "Parallel context initialization with threads : rank " << process.rank << " of "
+            << process.world->size( ) << std::endl;
+#endif
+    }
+    // ...............................................................................................
+    Context::~Context( ) {
+        Tracer::finalize( );
+#if defined( PARALLEL_TRACE )
+        Core::Logger log;
+        log << LogTrace << "Stop threads context" << std::endl;
+#endif
+        Threads::Process &process = Threads::current_process( );
+        process.world->barrier( process.rank );
+    }
+    // ...............................................................................................
+    void Context::startProgressThread( double, int ) {}
+    // ...............................................................................................
+    void Context::stopProgressThread( ) { m_progress.reset( ); }
+    // ...............................................................................................
+    // Each rank has its own global communicator
+    namespace {
+        struct GlobalCommunicator {
+            std::unique_ptr<Communicator> com;
+        };
+    }
+    const Communicator &Context::globalCommunicator( ) {
+        std::unique_ptr<Communicator> &global_com = Threads::rank_local<GlobalCommunicator>( ).com;
+        if ( !global_com ) global_com.reset( new Communicator );
+        return *global_com;
+    }
+    // ...............................................................................................
+    void Context::spawn( int nbRanks, const std::function<void( )> &body ) {
+        std::shared_ptr<Threads::Group> world = Threads::Group::create( nbRanks );
+        std::vector<std::exception_ptr> errors( nbRanks );
+        auto                            run_rank = [&]( int rank ) {
+            Threads::Process &process  = Threads::current_process( );
+            Threads::Process  previous = process;
+            // The data of the calling thread ( global communicator, traces, ... ) isn't shared by its rank
+            process.world = world;
+            process.rank  = rank;
+            process.locals.clear( );
+            try {
+                body( );
+            } catch ( ... ) {
+                errors[rank] = std::current_exception( );
+            }
+            {
+                // Destroyed in the rank, out of the map of the process
+                auto locals = std::move( process.locals );
+                process.locals.clear( );
+            }
+            process = previous;
+        };
+        std::vector<std::thread> threads;
+        for ( int rank = 1; rank < nbRanks; ++rank ) threads.emplace_back( run_rank, rank );
+        run_rank( 0 );
+        for ( auto &thread : threads ) thread.join( );
+        for ( auto &error : errors )
+            if ( error ) std::rethrow_exception( error );
+    }
+}
+#endif
@@ -1,5 +1,6 @@
 # include "parallel/log_from_distributed_file.hpp"
 # include "parallel/communicator.hpp"
+# include "parallel/context.hpp"
 # include <sstream>
 # include <iomanip>
 
@@ -11,7 +12,7 @@ namespace Parallel
      Core::Logger::Listener(flags),
      m_pt_log(nullptr)
   {
-	    Communicator com;
+	    const Communicator& com = Context::globalCommunicator();
 	    std::stringstream file_name;
 	    file_name << basename << std::setfill('0') << std::setw(5)
 		            << com.rank << ".txt";
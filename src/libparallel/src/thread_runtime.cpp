@@ -0,0 +1,510 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Implementation of the runtime of the threads implementation
+#if defined( USE_THREADS )
+#include "parallel/thread_runtime.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <new>
+#include <thread>
+#include "parallel/constantes.hpp"
+
+namespace Parallel {
+    namespace Threads {
+        namespace {
+            // Tags of the messages of the collective operations ( each operation completes all its
+            // messages before returning, except ibcast whose messages have their own tag, and the
+            // messages between two ranks are never overtaken )
+            enum collective_tag { tag_barrier = 1, tag_bcast, tag_reduce, tag_gather, tag_scatter, tag_alltoall, tag_split,
+                                 tag_sparse, tag_ibcast };
+
+            std::atomic<int> last_group_id( 0 );
+            // Registry of the groups, so a communicator can be created from the identifier of a group
+            std::mutex                         registry_mutex;
+            std::map<int, std::weak_ptr<Group>> registry;
+
+            void enroll( const std::shared_ptr<Group>& group ) {
+                std::lock_guard<std::mutex> lock( registry_mutex );
+                for ( auto it = registry.begin( ); it != registry.end( ); )
+                    it = ( it->second.expired( ) ? registry.erase( it ) : std::next( it ) );
+                registry[group->id( )] = group;
+            }
+
+            inline bool matches( int source, int tag, const Message& msg ) {
+                return ( ( source == any_source ) || ( source == msg.source ) ) &&
+                       ( ( tag == any_tag ) || ( tag == msg.tag ) );
+            }
+            // Copy the message in the receive buffer ( directly from the buffer of the sender for the
+            // rendezvous protocol ) and complete the receive and the rendezvous send.
+            void complete( Message* msg, void* buffer, std::size_t capacity, Completion& completion ) {
+                std::size_t bytes = std::min( msg->bytes, capacity );
+                if ( bytes > 0 ) std::memcpy( buffer, msg->data, bytes );
+                completion.status.m_bytes  = bytes;
+                completion.status.m_source = msg->source;
+                completion.status.m_tag    = msg->tag;
+                completion.status.m_error  = ( msg->bytes > capacity ? error::count : error::success );
+                completion.done.store( true, std::memory_order_release );
+                if ( msg->sender ) {
+                    msg->sender->status = completion.status;
+                    msg->sender->done.store( true, std::memory_order_release );
+                }
+                Message::release( msg );
+            }
+            // Active wait with a back off : the ranks may be more numerous than the cores
+            inline void pause( int& iteration ) {
+                if ( ++iteration > 64 ) std::this_thread::yield( );
+            }
+        }
+        // =========================================================================================
+        void MailBox::push( Node* node ) {
+            node->next.store( nullptr, std::memory_order_relaxed );
+            Node* prev = m_head.exchange( node, std::memory_order_acq_rel );
+            prev->next.store( node, std::memory_order_release );
+        }
+        // .........................................................................................
+        Node* MailBox::pop( ) {
+            Node* tail = m_tail;
+            Node* next = tail->next.load( std::memory_order_acquire );
+            if ( tail == &m_stub ) {
+                if ( next == nullptr ) return nullptr;
+                m_tail = next;
+                tail   = next;
+                next   = next->next.load( std::memory_order_acquire );
+            }
+            if ( next != nullptr ) {
+                m_tail = next;
+                return tail;
+            }
+            if ( tail != m_head.load( std::memory_order_acquire ) ) return nullptr; // A push is in progress
+            push( &m_stub );
+            next = tail->next.load( std::memory_order_acquire );
+            if ( next != nullptr ) {
+                m_tail = next;
+                return tail;
+            }
+            return nullptr;
+        }
+        // =========================================================================================
+        Message* Message::eager( int source, int tag, const void* data, std::size_t bytes ) {
+            // One allocation for the header and the payload
+            void*    memory = ::operator new( sizeof( Message ) + bytes );
+            Message* msg    = new ( memory ) Message;
+            msg->source     = source;
+            msg->tag        = tag;
+            msg->bytes      = bytes;
+            msg->data       = static_cast<char*>( memory ) + sizeof( Message );
+            if ( bytes > 0 ) std::memcpy( static_cast<char*>( memory ) + sizeof( Message ), data, bytes );
+            return msg;
+        }
+        // .........................................................................................
+        Message* Message::rendezvous( int source, int tag, const void* data, std::size_t bytes,
+                                      std::shared_ptr<Completion> sender ) {
+            Message* msg = eager( source, tag, nullptr, 0 );
+            msg->bytes   = bytes;
+            msg->data    = data;
+            msg->sender  = std::move( sender );
+            return msg;
+        }
+        // .........................................................................................
+        void Message::release( Message* msg ) {
+            msg->~Message( );
+            ::operator delete( msg );
+        }
+        // =========================================================================================
+        Endpoint::~Endpoint( ) {
+            drain( );
+            for ( Message* msg : m_unexpected ) Message::release( msg );
+        }
+        // .........................................................................................
+        void Endpoint::drain( ) {
+            while ( Node* node = m_mailbox.pop( ) ) {
+                Message* msg = static_cast<Message*>( node );
+                auto     it  = std::find_if( m_posted.begin( ), m_posted.end( ),
+                                        [msg]( const Posted& p ) { return matches( p.source, p.tag, *msg ); } );
+                if ( it == m_posted.end( ) )
+                    m_unexpected.push_back( msg );
+                else {
+                    complete( msg, it->buffer, it->capacity, *it->completion );
+                    m_posted.erase( it );
+                }
+            }
+        }
+        // .........................................................................................
+        std::shared_ptr<Completion> Endpoint::post( int source, int tag, void* buffer, std::size_t capacity ) {
+            auto                        completion = std::make_shared<Completion>( );
+            std::lock_guard<std::mutex> lock( m_mutex );
+            drain( );
+            auto it = std::find_if( m_unexpected.begin( ), m_unexpected.end( ),
+                                    [=]( const Message* msg ) { return matches( source, tag, *msg ); } );
+            if ( it == m_unexpected.end( ) )
+                m_posted.push_back( Posted{source, tag, buffer, capacity, completion} );
+            else {
+                Message* msg = *it;
+                m_unexpected.erase( it );
+                complete( msg, buffer, capacity, *completion );
+            }
+            return completion;
+        }
+        // .........................................................................................
+        bool Endpoint::probe( int source, int tag, Status& status ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            drain( );
+            for ( const Message* msg : m_unexpected ) {
+                if ( matches( source, tag, *msg ) ) {
+                    status.m_bytes  = msg->bytes;
+                    status.m_source = msg->source;
+                    status.m_tag    = msg->tag;
+                    status.m_error  = error::success;
+                    return true;
+                }
+            }
+            return false;
+        }
+        // .........................................................................................
+        void Endpoint::progress( ) {
+            std::unique_lock<std::mutex> lock( m_mutex, std::try_to_lock );
+            if ( lock.owns_lock( ) ) drain( );
+        }
+        // =========================================================================================
+        void Rank::attach( Group* group, int rank ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_endpoints.emplace_back( group, rank );
+        }
+        // .........................................................................................
+        void Rank::detach( Group* group, int rank ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            auto it = std::find( m_endpoints.begin( ), m_endpoints.end( ), std::make_pair( group, rank ) );
+            if ( it != m_endpoints.end( ) ) m_endpoints.erase( it );
+        }
+        // .........................................................................................
+        void Rank::progress( ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            for ( auto& ep : m_endpoints ) {
+                ep.first->endpoint( ep.second, Group::user ).progress( );
+                ep.first->endpoint( ep.second, Group::collective ).progress( );
+            }
+        }
+        // =========================================================================================
+        Group::Group( int nbRanks ) : m_id( ++last_group_id ) {
+            for ( int rk = 0; rk < nbRanks; ++rk ) {
+                m_owned_ranks.emplace_back( new Rank );
+                m_ranks.push_back( m_owned_ranks.back( ).get( ) );
+            }
+            for ( int i = 0; i < 2 * nbRanks; ++i ) m_endpoints.emplace_back( new Endpoint );
+        }
+        // .........................................................................................
+        Group::Group( std::shared_ptr<Group> world, std::vector<Rank*> ranks )
+            : m_world( std::move( world ) ), m_ranks( std::move( ranks ) ), m_id( ++last_group_id ) {
+            for ( std::size_t i = 0; i < 2 * m_ranks.size( ); ++i ) m_endpoints.emplace_back( new Endpoint );
+        }
+        // .........................................................................................
+        std::shared_ptr<Group> Group::create( int nbRanks ) {
+            auto world = std::make_shared<Group>( nbRanks );
+            enroll( world );
+            return world;
+        }
+        // .........................................................................................
+        std::shared_ptr<Group> Group::find( int id ) {
+            std::lock_guard<std::mutex> lock( registry_mutex );
+            auto                        it = registry.find( id );
+            return ( it == registry.end( ) ? nullptr : it->second.lock( ) );
+        }
+        // .........................................................................................
+        int Group::rank_of( const Rank& state ) const {
+            auto it = std::find( m_ranks.begin( ), m_ranks.end( ), &state );
+            return ( it == m_ranks.end( ) ? undefined : int( it - m_ranks.begin( ) ) );
+        }
+        // .........................................................................................
+        int Group::translate( int rk, const Group& other ) const {
+            return other.rank_of( *m_ranks[rk] );
+        }
+        // =========================================================================================
+        std::shared_ptr<Completion> Group::isend( int ctx, int rk, int dest, int tag, const void* data,
+                                                  std::size_t bytes ) {
+            auto completion = std::make_shared<Completion>( );
+            if ( dest == proc_null ) {
+                completion->done.store( true );
+                return completion;
+            }
+            assert( ( dest >= 0 ) && ( dest < size( ) ) );
+            if ( bytes <= eager_limit ) {
+                endpoint( dest, ctx ).deliver( Message::eager( rk, tag, data, bytes ) );
+                completion->status.m_bytes  = bytes;
+                completion->status.m_source = rk;
+                completion->status.m_tag    = tag;
+                completion->done.store( true, std::memory_order_release );
+            } else
+                endpoint( dest, ctx ).deliver( Message::rendezvous( rk, tag, data, bytes, completion ) );
+            return completion;
+        }
+        // .........................................................................................
+        std::shared_ptr<Completion> Group::irecv( int ctx, int rk, int source, int tag, void* data,
+                                                  std::size_t bytes ) {
+            if ( source == proc_null ) {
+                auto completion             = std::make_shared<Completion>( );
+                completion->status.m_source = proc_null;
+                completion->status.m_tag    = any_tag;
+                completion->done.store( true );
+                return completion;
+            }
+            return endpoint( rk, ctx ).post( source, tag, data, bytes );
+        }
+        // .........................................................................................
+        void Group::send( int ctx, int rk, int dest, int tag, const void* data, std::size_t bytes ) {
+            auto completion = isend( ctx, rk, dest, tag, data, bytes );
+            wait( rk, *completion );
+        }
+        // .........................................................................................
+        Status Group::recv( int ctx, int rk, int source, int tag, void* data, std::size_t bytes ) {
+            auto completion = irecv( ctx, rk, source, tag, data, bytes );
+            wait( rk, *completion );
+            return completion->status;
+        }
+        // .........................................................................................
+        void Group::progress( int rk ) {
+            endpoint( rk, user ).progress( );
+            endpoint( rk, collective ).progress( );
+            rank( rk ).progress( );
+        }
+        // .........................................................................................
+        void Group::wait( int rk, const Completion& completion ) {
+            int iteration = 0;
+            while ( !completion.done.load( std::memory_order_acquire ) ) {
+                progress( rk );
+                pause( iteration );
+            }
+        }
+        // =========================================================================================
+        // Dissemination barrier : log2(n) rounds of empty messages
+        void Group::barrier( int rk ) {
+            const int n = size( );
+            for ( int k = 1; k < n; k <<= 1 ) {
+                auto rcv = irecv( collective, rk, ( rk - k + n ) % n, tag_barrier, nullptr, 0 );
+                isend( collective, rk, ( rk + k ) % n, tag_barrier, nullptr, 0 );
+                wait( rk, *rcv );
+            }
+        }
+        // .........................................................................................
+        // Binomial tree rooted on root : the children copy the data directly from the buffer of their
+        // parent for the large messages.
+        void Group::bcast( int rk, int root, void* data, std::size_t bytes ) {
+            const int n  = size( );
+            const int vr = ( rk - root + n ) % n;
+            int       mask = 1;
+            while ( mask < n ) {
+                if ( vr & mask ) {
+                    recv( collective, rk, ( vr - mask + root ) % n, tag_bcast, data, bytes );
+                    break;
+                }
+                mask <<= 1;
+            }
+            std::vector<std::shared_ptr<Completion>> sends;
+            for ( mask >>= 1; mask > 0; mask >>= 1 )
+                if ( vr + mask < n ) sends.push_back( isend( collective, rk, ( vr + mask + root ) % n, tag_bcast, data, bytes ) );
+            for ( auto& snd : sends ) wait( rk, *snd );
+        }
+        // .........................................................................................
+        // Flat tree : the root sends the data to each rank, so a broadcast started by all the ranks
+        // completes without any further call of the root
+        std::vector<std::shared_ptr<Completion>> Group::ibcast( int rk, int root, void* data, std::size_t bytes ) {
+            std::vector<std::shared_ptr<Completion>> completions;
+            if ( rk != root )
+                completions.push_back( irecv( collective, rk, root, tag_ibcast, data, bytes ) );
+            else
+                for ( int dest = 0; dest < size( ); ++dest )
+                    if ( dest != root ) completions.push_back( isend( collective, rk, dest, tag_ibcast, data, bytes ) );
+            return completions;
+        }
+        // .........................................................................................
+        // Binomial tree rooted on the rank 0 : each rank combines the partial result of the lower
+        // ranks with the partial result of the upper ranks, so the order of the operands is kept for
+        // the non commutative operations. The result is sent to root if root isn't 0.
+        void Group::reduce( int rk, int root, const void* snd, void* rcv, std::size_t bytes,
+                            const Combine& combine ) {
+            const int         n = size( );
+            std::vector<char> acc( static_cast<const char*>( snd ), static_cast<const char*>( snd ) + bytes );
+            std::vector<char> tmp( bytes );
+            for ( int mask = 1; mask < n; mask <<= 1 ) {
+                if ( rk & mask ) {
+                    send( collective, rk, rk - mask, tag_reduce, acc.data( ), bytes );
+                    break;
+                }
+                if ( rk + mask < n ) {
+                    recv( collective, rk, rk + mask, tag_reduce, tmp.data( ), bytes );
+                    combine( acc.data( ), tmp.data( ), bytes );
+                    acc.swap( tmp );
+                }
+            }
+            if ( ( rk == 0 ) && ( root == 0 ) ) {
+                if ( bytes > 0 ) std::memcpy( rcv, acc.data( ), bytes );
+            } else if ( rk == 0 )
+                send( collective, rk, root, tag_reduce, acc.data( ), bytes );
+            else if ( rk == root )
+                recv( collective, rk, 0, tag_reduce, rcv, bytes );
+        }
+        // .........................................................................................
+        void Group::allreduce( int rk, const void* snd, void* rcv, std::size_t bytes, const Combine& combine ) {
+            reduce( rk, 0, snd, rcv, bytes, combine );
+            bcast( rk, 0, rcv, bytes );
+        }
+        // .........................................................................................
+        // The root receives directly in its buffer the contributions of the other ranks
+        void Group::gatherv( int rk, int root, const void* snd, std::size_t bytes, void* rcv,
+                             const std::vector<std::size_t>& counts ) {
+            if ( rk != root ) {
+                send( collective, rk, root, tag_gather, snd, bytes );
+                return;
+            }
+            assert( int( counts.size( ) ) == size( ) );
+            std::vector<std::shared_ptr<Completion>> rcvs;
+            char*                                    pt_rcv = static_cast<char*>( rcv );
+            for ( int r = 0; r < size( ); ++r ) {
+                if ( r == rk ) {
+                    if ( bytes > 0 ) std::memcpy( pt_rcv, snd, std::min( bytes, counts[r] ) );
+                } else
+                    rcvs.push_back( irecv( collective, rk, r, tag_gather, pt_rcv, counts[r] ) );
+                pt_rcv += counts[r];
+            }
+            for ( auto& r : rcvs ) wait( rk, *r );
+        }
+        // .........................................................................................
+        void Group::scatterv( int rk, int root, const void* snd, const std::vector<std::size_t>& counts, void* rcv,
+                              std::size_t bytes ) {
+            if ( rk != root ) {
+                recv( collective, rk, root, tag_scatter, rcv, bytes );
+                return;
+            }
+            assert( int( counts.size( ) ) == size( ) );
+            std::vector<std::shared_ptr<Completion>> snds;
+            const char*                              pt_snd = static_cast<const char*>( snd );
+            for ( int r = 0; r < size( ); ++r ) {
+                if ( r == rk ) {
+                    if ( bytes > 0 ) std::memcpy( rcv, pt_snd, std::min( bytes, counts[r] ) );
+                } else
+                    snds.push_back( isend( collective, rk, r, tag_scatter, pt_snd, counts[r] ) );
+                pt_snd += counts[r];
+            }
+            for ( auto& s : snds ) wait( rk, *s );
+        }
+        // .........................................................................................
+        void Group::allgatherv( int rk, const void* snd, std::size_t bytes, void* rcv,
+                                const std::vector<std::size_t>& counts ) {
+            std::size_t total = 0;
+            for ( auto c : counts ) total += c;
+            gatherv( rk, 0, snd, bytes, rcv, counts );
+            bcast( rk, 0, rcv, total );
+        }
+        // .........................................................................................
+        void Group::alltoallv( int rk, const void* snd, const std::vector<std::size_t>& snd_counts, void* rcv,
+                               const std::vector<std::size_t>& rcv_counts ) {
+            const int n = size( );
+            assert( ( int( snd_counts.size( ) ) == n ) && ( int( rcv_counts.size( ) ) == n ) );
+            std::vector<std::size_t> snd_displs( n, 0 ), rcv_displs( n, 0 );
+            for ( int r = 1; r < n; ++r ) {
+                snd_displs[r] = snd_displs[r - 1] + snd_counts[r - 1];
+                rcv_displs[r] = rcv_displs[r - 1] + rcv_counts[r - 1];
+            }
+            const char* pt_snd = static_cast<const char*>( snd );
+            char*       pt_rcv = static_cast<char*>( rcv );
+            std::vector<std::shared_ptr<Completion>> reqs;
+            // Shifted order to avoid that all the ranks send first to the same rank
+            for ( int i = 1; i < n; ++i ) {
+                int src = ( rk - i + n ) % n;
+                reqs.push_back( irecv( collective, rk, src, tag_alltoall, pt_rcv + rcv_displs[src], rcv_counts[src] ) );
+            }
+            for ( int i = 1; i < n; ++i ) {
+                int dst = ( rk + i ) % n;
+                reqs.push_back( isend( collective, rk, dst, tag_alltoall, pt_snd + snd_displs[dst], snd_counts[dst] ) );
+            }
+            if ( snd_counts[rk] > 0 )
+                std::memcpy( pt_rcv + rcv_displs[rk], pt_snd + snd_displs[rk], std::min( snd_counts[rk], rcv_counts[rk] ) );
+            for ( auto& r : reqs ) wait( rk, *r );
+        }
+        // .........................................................................................
+        // The messages are delivered to the mailboxes when sent, so after a barrier all the messages
+        // of the exchange are probed. The second barrier prevents that a message of the next exchange
+        // is received in this one.
+        void Group::sparse_exchange( int rk, const std::vector<Outgoing>& messages, const Allocate& allocate ) {
+            std::vector<std::shared_ptr<Completion>> sends;
+            sends.reserve( messages.size( ) );
+            for ( const auto& msg : messages )
+                sends.push_back( isend( collective, rk, msg.dest, tag_sparse, msg.data, msg.bytes ) );
+            barrier( rk );
+            Status status;
+            while ( endpoint( rk, collective ).probe( any_source, tag_sparse, status ) )
+                recv( collective, rk, status.source( ), tag_sparse, allocate( status.source( ), status.m_bytes ),
+                      status.m_bytes );
+            for ( auto& s : sends ) wait( rk, *s );
+            barrier( rk );
+        }
+        // =========================================================================================
+        // The rank 0 gathers the colors and the keys, builds the groups and sends to each rank its
+        // group ( as a pointer on a heap allocated shared pointer ) and its new rank.
+        std::pair<std::shared_ptr<Group>, int> Group::split( int rk, int color, int key ) {
+            struct Answer {
+                std::shared_ptr<Group>* group;
+                int                     rank;
+            };
+            std::array<int, 2> color_key{{color, key}};
+            if ( rk != 0 ) {
+                send( collective, rk, 0, tag_split, color_key.data( ), sizeof( color_key ) );
+                Answer answer;
+                recv( collective, rk, 0, tag_split, &answer, sizeof( Answer ) );
+                if ( answer.group == nullptr ) return {nullptr, undefined};
+                std::shared_ptr<Group> group = std::move( *answer.group );
+                delete answer.group;
+                return {group, answer.rank};
+            }
+            const int                       n = size( );
+            std::vector<std::array<int, 3>> members( n ); // ( color, key, rank )
+            members[0] = {{color, key, 0}};
+            for ( int r = 1; r < n; ++r ) {
+                recv( collective, rk, r, tag_split, color_key.data( ), sizeof( color_key ) );
+                members[r] = {{color_key[0], color_key[1], r}};
+            }
+            std::sort( members.begin( ), members.end( ) );
+            std::shared_ptr<Group> world = ( m_world ? m_world : shared_from_this( ) );
+            std::vector<Answer>    answers( n, Answer{nullptr, undefined} );
+            std::pair<std::shared_ptr<Group>, int> mine{nullptr, undefined};
+            for ( std::size_t beg = 0, end; beg < members.size( ); beg = end ) {
+                for ( end = beg + 1; ( end < members.size( ) ) && ( members[end][0] == members[beg][0] ); ++end )
+                    ;
+                if ( members[beg][0] == undefined ) continue;
+                std::vector<Rank*> ranks;
+                for ( std::size_t i = beg; i < end; ++i ) ranks.push_back( m_ranks[members[i][2]] );
+                auto group = std::make_shared<Group>( world, std::move( ranks ) );
+                enroll( group );
+                for ( std::size_t i = beg; i < end; ++i ) {
+                    int r = members[i][2];
+                    if ( r == 0 )
+                        mine = {group, int( i - beg )};
+                    else
+                        answers[r] = Answer{new std::shared_ptr<Group>( group ), int( i - beg )};
+                }
+            }
+            for ( int r = 1; r < n; ++r ) send( collective, rk, r, tag_split, &answers[r], sizeof( Answer ) );
+            return mine;
+        }
+        // =========================================================================================
+        Process& current_process( ) {
+            static thread_local Process process;
+            return process;
+        }
+    }
+}
+#endif
@@ -0,0 +1,214 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Implementation of the tracing of the communications
+#include "parallel/tracer.hpp"
+#include "parallel/communicator"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#if defined( USE_THREADS )
+#include "parallel/thread_runtime.hpp"
+#endif
+
+namespace Parallel {
+    namespace {
+        const int nb_buckets = 48; // Bucket b counts the messages of [2^(b-1), 2^b[ bytes ( bucket 0 : empty )
+
+        // The flag and the origin are read without the lock when the communications are timed
+        struct State {
+            std::atomic<bool>                                  is_enabled{false};
+            std::string                                        filename;
+            std::atomic<std::chrono::steady_clock::time_point> origin{std::chrono::steady_clock::time_point( )};
+            std::vector<Tracer::Event>                         ring;
+            std::size_t                                        next = 0, nb_events = 0;
+            std::vector<double>                                sent; // Bytes sent to each rank of the world
+            std::vector<double>                                histogram = std::vector<double>( nb_buckets, 0. );
+            std::vector<double>                                calls     = std::vector<double>( Tracer::nb_calls, 0. );
+            std::vector<double>                                bytes     = std::vector<double>( Tracer::nb_calls, 0. );
+            std::vector<double>                                times     = std::vector<double>( Tracer::nb_calls, 0. );
+            std::mutex                                         mutex;
+        };
+        // With the threads implementation, each thread is a rank with its own trace
+        State& state( ) {
+#if defined( USE_THREADS )
+            return Threads::rank_local<State>( );
+#else
+            static State st;
+            return st;
+#endif
+        }
+        // ----------------------------------------------------------------------------------------
+        int bucket( std::size_t bytes ) {
+            int b = 0;
+            while ( ( bytes > 0 ) && ( b < nb_buckets - 1 ) ) {
+                bytes >>= 1;
+                ++b;
+            }
+            return b;
+        }
+        // ----------------------------------------------------------------------------------------
+        void add_sent( State& st, int world_rank, double bytes ) {
+            if ( ( world_rank < 0 ) || ( bytes <= 0. ) ) return;
+            if ( st.sent.size( ) <= std::size_t( world_rank ) ) st.sent.resize( world_rank + 1, 0. );
+            st.sent[world_rank] += bytes;
+        }
+    }
+    // ============================================================================================
+    const char* Tracer::name( Call call ) {
+        static const char* names[] = {"send",   "isend",   "recv",      "irecv",    "probe",
+                                      "bcast",  "reduce",  "allreduce", "gather",   "scatter",
+                                      "allgather", "alltoall", "barrier", "exchange"};
+        return ( call < nb_calls ? names[call] : "unknown" );
+    }
+    // --------------------------------------------------------------------------------------------
+    void Tracer::enable( std::size_t capacity, const std::string& filename ) {
+        State&                      st = state( );
+        std::lock_guard<std::mutex> lock( st.mutex );
+        st.ring.assign( capacity, Event{send, 0, 0, 0, 0., 0.} );
+        st.next = st.nb_events = 0;
+        st.filename            = filename;
+        st.origin              = std::chrono::steady_clock::now( );
+        st.sent.clear( );
+        st.histogram.assign( nb_buckets, 0. );
+        st.calls.assign( nb_calls, 0. );
+        st.bytes.assign( nb_calls, 0. );
+        st.times.assign( nb_calls, 0. );
+        st.is_enabled = ( capacity > 0 );
+    }
+    // --------------------------------------------------------------------------------------------
+    void Tracer::disable( ) { state( ).is_enabled = false; }
+    // --------------------------------------------------------------------------------------------
+    bool Tracer::enabled( ) { return state( ).is_enabled; }
+    // --------------------------------------------------------------------------------------------
+    double Tracer::now( ) {
+        return std::chrono::duration<double>( std::chrono::steady_clock::now( ) - state( ).origin.load( ) ).count( );
+    }
+    // --------------------------------------------------------------------------------------------
+    std::vector<Tracer::Event> Tracer::events( ) {
+        State&                      st = state( );
+        std::lock_guard<std::mutex> lock( st.mutex );
+        std::vector<Event>          evts;
+        evts.reserve( st.nb_events );
+        std::size_t first = ( st.next + st.ring.size( ) - st.nb_events ) % std::max( st.ring.size( ), std::size_t( 1 ) );
+        for ( std::size_t i = 0; i < st.nb_events; ++i ) evts.push_back( st.ring[( first + i ) % st.ring.size( )] );
+        return evts;
+    }
+    // --------------------------------------------------------------------------------------------
+    void Tracer::record( const Communicator& com, const Scope& scope, double end ) {
+        State& st   = state( );
+        int    peer = ( scope.m_peer >= 0 ? com.worldRank( scope.m_peer ) : scope.m_peer );
+        std::lock_guard<std::mutex> lock( st.mutex );
+        if ( !st.is_enabled ) return;
+        st.ring[st.next] = Event{scope.m_call, peer, scope.m_tag, scope.m_bytes, scope.m_start, end};
+        st.next          = ( st.next + 1 ) % st.ring.size( );
+        st.nb_events     = std::min( st.nb_events + 1, st.ring.size( ) );
+        st.calls[scope.m_call] += 1.;
+        st.bytes[scope.m_call] += double( scope.m_bytes );
+        st.times[scope.m_call] += end - scope.m_start;
+        // The received messages are counted by their sender
+        if ( ( scope.m_call == recv ) || ( scope.m_call == irecv ) || ( scope.m_call == probe ) ) return;
+        if ( scope.m_bytes > 0 ) st.histogram[bucket( scope.m_bytes )] += 1.;
+        // Traffic matrix : data sent by this rank to the other ranks
+        int self = com.worldRank( com.rank );
+        switch ( scope.m_call ) {
+            case send:
+            case isend:
+                if ( peer != self ) add_sent( st, peer, double( scope.m_bytes ) );
+                break;
+            case reduce:
+            case gather:
+                if ( peer != self ) add_sent( st, peer, double( scope.m_bytes ) );
+                break;
+            case bcast:
+            case scatter:
+                // Only the root sends, to all the other ranks
+                if ( peer != self ) break;
+                // fall through
+            case allgather:
+            case alltoall:
+                for ( int r = 0; r < com.size; ++r ) {
+                    if ( r == com.rank ) continue;
+                    double bytes = ( scope.m_counts != nullptr ? double( ( *scope.m_counts )[r] * scope.m_item_size )
+                                                               : double( scope.m_bytes ) );
+                    add_sent( st, com.worldRank( r ), bytes );
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    // --------------------------------------------------------------------------------------------
+    void Tracer::report( std::ostream& out, const Communicator& com, int root ) {
+        State& st         = state( );
+        bool   was_enabled = st.is_enabled.exchange( false ); // The communications of the report aren't traced
+        std::vector<double> row( com.size, 0. ), matrix;
+        for ( int r = 0; r < com.size; ++r ) {
+            std::size_t w = std::size_t( com.worldRank( r ) );
+            if ( w < st.sent.size( ) ) row[r] = st.sent[w];
+        }
+        if ( com.rank == root ) matrix.resize( std::size_t( com.size ) * com.size );
+        com.gather( row.size( ), row.data( ), matrix.data( ), root );
+        std::vector<double> stats;
+        stats.insert( stats.end( ), st.histogram.begin( ), st.histogram.end( ) );
+        stats.insert( stats.end( ), st.calls.begin( ), st.calls.end( ) );
+        stats.insert( stats.end( ), st.bytes.begin( ), st.bytes.end( ) );
+        stats.insert( stats.end( ), st.times.begin( ), st.times.end( ) );
+        std::vector<double> total( stats.size( ) );
+        com.reduce( stats.size( ), stats.data( ), total.data( ), Parallel::sum, root );
+        st.is_enabled = was_enabled;
+        if ( com.rank != root ) return;
+
+        const double* histogram = total.data( );
+        const double* calls     = histogram + nb_buckets;
+        const double* bytes     = calls + nb_calls;
+        const double* times     = bytes + nb_calls;
+        out << "================ Communications of " << com.size << " ranks ================" << std::endl;
+        out << std::setw( 10 ) << "operation" << std::setw( 12 ) << "calls" << std::setw( 16 ) << "bytes"
+            << std::setw( 14 ) << "time (s)" << std::setw( 14 ) << "MB/s" << std::endl;
+        for ( int c = 0; c < nb_calls; ++c ) {
+            if ( calls[c] == 0. ) continue;
+            out << std::setw( 10 ) << name( Call( c ) ) << std::setw( 12 ) << std::size_t( calls[c] )
+                << std::setw( 16 ) << std::size_t( bytes[c] ) << std::setw( 14 ) << times[c] << std::setw( 14 )
+                << ( times[c] > 0. ? 1.E-6 * bytes[c] / times[c] : 0. ) << std::endl;
+        }
+        out << "---------------- Traffic matrix ( bytes, sender x receiver ) ----------------" << std::endl;
+        out << std::setw( 6 ) << "";
+        for ( int j = 0; j < com.size; ++j ) out << std::setw( 14 ) << j;
+        out << std::endl;
+        for ( int i = 0; i < com.size; ++i ) {
+            out << std::setw( 6 ) << i;
+            for ( int j = 0; j < com.size; ++j )
+                out << std::setw( 14 ) << std::size_t( matrix[std::size_t( i ) * com.size + j] );
+            out << std::endl;
+        }
+        out << "---------------- Message sizes ----------------" << std::endl;
+        for ( int b = 1; b < nb_buckets; ++b ) {
+            if ( histogram[b] == 0. ) continue;
+            out << "[ " << std::setw( 14 ) << ( std::size_t( 1 ) << ( b - 1 ) ) << ", " << std::setw( 14 )
+                << ( std::size_t( 1 ) << b ) << " [ : " << std::size_t( histogram[b] ) << std::endl;
+        }
+    }
+    // --------------------------------------------------------------------------------------------
+    void Tracer::finalize( ) {
+        if ( !enabled( ) ) return;
+        Communicator  world;
+        std::ofstream file;
+        if ( ( world.rank == 0 ) && !state( ).filename.empty( ) ) file.open( state( ).filename );
+        report( file.is_open( ) ? file : std::cout, world );
+        disable( );
+    }
+}
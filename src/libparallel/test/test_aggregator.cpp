@@ -0,0 +1,87 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the aggregation of small messages
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/aggregator.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+struct Item {
+    int origin;
+    long value;
+    int hops; // Number of times the item must still be forwarded
+};
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const long nbItems = 10000;
+    // Each item is sent to value % size, and forwarded hops times to the next process by the handlers
+    long received = 0, sum = 0;
+    std::vector<long> from(com.size, 0);
+    Parallel::Aggregator<Item> *pt_channel = nullptr;
+    Parallel::Aggregator<Item> channel(
+        com,
+        [&](int, const Item &item) {
+            if (item.hops > 0) {
+                pt_channel->send(Item{item.origin, item.value, item.hops - 1}, (com.rank + 1) % com.size);
+                return;
+            }
+            ++received;
+            sum += item.value;
+            ++from[item.origin];
+        },
+        64);
+    pt_channel = &channel;
+    for (long i = 0; i < nbItems; ++i) {
+        long value = com.rank * nbItems + i;
+        channel.send(Item{com.rank, value, int(i % 3)}, int(value % com.size));
+        if (i % 1000 == 0) channel.poll();
+    }
+    channel.finish();
+    check(channel.nbItemsSent() >= std::size_t(nbItems), "number of sent items");
+    check(channel.nbMessagesSent() < channel.nbItemsSent(), "aggregation of the items");
+
+    long total_received, total_sum;
+    com.allreduce(received, total_received, Parallel::sum);
+    com.allreduce(sum, total_sum, Parallel::sum);
+    long n = com.size * nbItems;
+    check(total_received == n, "number of handled items");
+    check(total_sum == n * (n - 1) / 2, "sum of the handled items");
+    std::vector<long> total_from(com.size);
+    com.allreduce(com.size, from.data(), total_from.data(), Parallel::sum);
+    bool ok = true;
+    for (int r = 0; r < com.size; ++r) ok = ok && (total_from[r] == nbItems);
+    check(ok, "origin of the handled items");
+
+    // Without delay, poll sends the buffers which aren't full
+    received = 0;
+    Parallel::Aggregator<Item> timed(com, [&](int, const Item &) { ++received; }, 1000000, 0.);
+    timed.send(Item{com.rank, 0, 0}, (com.rank + 1) % com.size);
+    while (received == 0) timed.poll();
+    check(timed.nbMessagesSent() == 1, "flush after the maximal delay");
+    timed.finish();
+
+    return check.result();
+}
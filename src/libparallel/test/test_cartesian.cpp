@@ -0,0 +1,109 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the cartesian communicators and of the halo exchanges
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/cartesian_communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <string>
+#include <vector>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    // Periodic 2D grid : shifts and neighbor collectives
+    Parallel::CartesianCommunicator grid(com, {0, 0}, {true, true});
+    check(grid.dimensions()[0] * grid.dimensions()[1] == com.size, "dimensions of the grid");
+    check(grid.coordinates(grid.rank) == grid.coordinates(), "coordinates of the process");
+    std::vector<std::size_t> counts(4, 2);
+    std::vector<int> snd(8), rcv(8, -1), expected(8);
+    for (int d = 0; d < 2; ++d) {
+        auto src_dst = grid.shift(d);
+        check(src_dst.first == grid.neighbor(d == 0 ? std::vector<int>{-1, 0} : std::vector<int>{0, -1}), "shift");
+        // What is sent in the positive direction is received from the negative direction and vice versa
+        snd[4 * d + 0] = grid.rank;
+        snd[4 * d + 1] = -1;
+        snd[4 * d + 2] = grid.rank;
+        snd[4 * d + 3] = +1;
+        expected[4 * d + 0] = src_dst.first;
+        expected[4 * d + 1] = +1;
+        expected[4 * d + 2] = src_dst.second;
+        expected[4 * d + 3] = -1;
+    }
+    grid.neighbor_alltoallv(counts, snd.data(), counts, rcv.data());
+    check(rcv == expected, "neighbor_alltoallv");
+    std::vector<int> ranks(4, -1);
+    grid.neighbor_allgather(1, &grid.rank, ranks.data());
+    check((ranks[0] == expected[0]) && (ranks[3] == expected[6]), "neighbor_allgather");
+
+    // Halo exchange on a periodic 2D row-major array, with corners
+    {
+        const int nx = 5, ny = 4, g = 2;
+        const int NX = nx * grid.dimensions()[0], NY = ny * grid.dimensions()[1];
+        const int ox = nx * grid.coordinates()[0], oy = ny * grid.coordinates()[1];
+        auto value = [&](int i, int j) { return 1000. * ((i + NX) % NX) + ((j + NY) % NY); };
+        std::vector<double> u((nx + 2 * g) * (ny + 2 * g), -1.);
+        for (int i = 0; i < nx; ++i)
+            for (int j = 0; j < ny; ++j) u[(i + g) * (ny + 2 * g) + j + g] = value(ox + i, oy + j);
+        Parallel::HaloExchange<double> halo(grid, {nx + 2 * g, ny + 2 * g}, {g, g});
+        halo.exchange(u.data());
+        bool ok = true;
+        for (int i = -g; i < nx + g; ++i)
+            for (int j = -g; j < ny + g; ++j) ok = ok && (u[(i + g) * (ny + 2 * g) + j + g] == value(ox + i, oy + j));
+        check(ok, "periodic halo exchange with corners");
+    }
+    // Halo exchange on a non periodic 3D column-major array, faces only
+    {
+        Parallel::CartesianCommunicator cube(com, {0, 0, 0}, {false, false, false});
+        const std::size_t n = 3, m = n + 2;
+        const auto &dims = cube.dimensions();
+        const auto &pos  = cube.coordinates();
+        auto value       = [&](long i, long j, long k) {
+            return int(((pos[0] * long(n) + i) * 100 + pos[1] * long(n) + j) * 100 + pos[2] * long(n) + k);
+        };
+        auto index = [&](long i, long j, long k) { return (i + 1) + m * ((j + 1) + m * (k + 1)); };
+        std::vector<int> u(m * m * m, -1);
+        for (long k = 0; k < long(n); ++k)
+            for (long j = 0; j < long(n); ++j)
+                for (long i = 0; i < long(n); ++i) u[index(i, j, k)] = value(i, j, k);
+        Parallel::HaloExchange<int> halo(cube, {m, m, m}, {1, 1, 1}, Parallel::HaloStencil::faces, {1, m, m * m});
+        check(halo.nbNeighbors() <= 6, "number of neighbors for the faces");
+        halo.start(u.data());
+        halo.finish();
+        bool ok = true;
+        for (long k = -1; k <= long(n); ++k)
+            for (long j = -1; j <= long(n); ++j)
+                for (long i = -1; i <= long(n); ++i) {
+                    const long c[3]   = {i, j, k};
+                    int nb_outside    = 0;
+                    bool outside_grid = false;
+                    for (int d = 0; d < 3; ++d) {
+                        if ((c[d] < 0) || (c[d] >= long(n))) {
+                            ++nb_outside;
+                            outside_grid = outside_grid || (c[d] < 0 ? pos[d] == 0 : pos[d] == dims[d] - 1);
+                        }
+                    }
+                    const int expect = ((nb_outside > 1) || outside_grid ? -1 : value(i, j, k));
+                    ok               = ok && (u[index(i, j, k)] == expect);
+                }
+        check(ok, "non periodic halo exchange of the faces");
+    }
+
+    return check.result();
+}
@@ -0,0 +1,104 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the gather, scatter, allgather and alltoall families of collective operations
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+struct Point {
+    double x, y;
+    int id;
+};
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const int root = com.size - 1;
+    // Gather of one object ( native type and packed type ) per process :
+    std::vector<int> ranks(com.size, -1);
+    com.gather(com.rank, ranks.data(), root);
+    if (com.rank == root)
+        for (int i = 0; i < com.size; ++i) check(ranks[i] == i, "gather of one int");
+    std::vector<Point> points(com.size);
+    Point pt{1. * com.rank, -1. * com.rank, com.rank};
+    com.allgather(pt, points.data());
+    for (int i = 0; i < com.size; ++i)
+        check((points[i].x == i) && (points[i].y == -i) && (points[i].id == i), "allgather of one packed object");
+    // Gatherv of a variable number of objects per process :
+    std::vector<double> loc(com.rank + 1, double(com.rank));
+    std::vector<std::size_t> counts(com.size);
+    for (int i = 0; i < com.size; ++i) counts[i] = i + 1;
+    std::vector<double> glob(com.size * (com.size + 1) / 2, -1.);
+    com.gatherv(loc.size(), loc.data(), counts, glob.data(), 0);
+    if (com.rank == 0) {
+        std::size_t ind = 0;
+        for (int i = 0; i < com.size; ++i)
+            for (int j = 0; j <= i; ++j) check(glob[ind++] == double(i), "gatherv on buffers");
+    }
+    std::vector<double> allglob;
+    auto allcounts = com.allgatherv(loc, allglob);
+    check(allglob.size() == std::size_t(com.size * (com.size + 1) / 2), "size of allgatherv container");
+    check(allcounts == counts, "counts returned by allgatherv");
+    std::list<double> lloc(loc.begin(), loc.end()), lglob;
+    auto lcounts = com.gatherv(lloc, lglob, root);
+    if (com.rank == root) {
+        check(lcounts == counts, "counts returned by gatherv");
+        check(std::vector<double>(lglob.begin(), lglob.end()) == allglob, "gatherv on lists");
+    }
+    // Scatter and scatterv :
+    std::vector<int> to_scatter;
+    if (com.rank == 0)
+        for (int i = 0; i < com.size; ++i) to_scatter.push_back(10 * i);
+    int value = -1;
+    com.scatter(to_scatter.data(), value, 0);
+    check(value == 10 * com.rank, "scatter of one int");
+    std::vector<double> rcv;
+    com.scatterv(allglob, counts, rcv, 0);
+    check(rcv == loc, "scatterv on containers");
+    std::vector<double> brcv(com.rank + 1);
+    com.scatterv(counts, allglob.data(), brcv.size(), brcv.data(), 0);
+    check(brcv == loc, "scatterv on buffers");
+    // All to all :
+    std::vector<int> snd(com.size), arcv(com.size);
+    for (int i = 0; i < com.size; ++i) snd[i] = 100 * com.rank + i;
+    com.alltoall(snd.data(), arcv.data());
+    for (int i = 0; i < com.size; ++i) check(arcv[i] == 100 * i + com.rank, "alltoall");
+    // Each process sends i+1 values to the process i :
+    std::vector<std::size_t> snd_counts(com.size);
+    std::vector<int> vsnd;
+    for (int i = 0; i < com.size; ++i) {
+        snd_counts[i] = i + 1;
+        for (int j = 0; j <= i; ++j) vsnd.push_back(com.rank);
+    }
+    std::vector<int> vrcv;
+    auto rcv_counts = com.alltoallv(snd_counts, vsnd, vrcv);
+    check(vrcv.size() == std::size_t(com.size * (com.rank + 1)), "size of alltoallv container");
+    for (int i = 0; i < com.size; ++i) {
+        check(rcv_counts[i] == std::size_t(com.rank + 1), "counts returned by alltoallv");
+        for (int j = 0; j <= com.rank; ++j) check(vrcv[i * (com.rank + 1) + j] == i, "alltoallv");
+    }
+
+    return check.result();
+}
@@ -0,0 +1,157 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of each algorithm of the collective operations, then of the algorithms chosen by autotuning
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/collective_algorithms.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// Affine maps x -> a.x + b modulo a prime : their composition is associative but not commutative
+struct Affine {
+    long a, b;
+};
+const long modulo = 1000003L;
+Affine compose(const Affine &first, const Affine &second) {
+    return Affine{(first.a * second.a) % modulo, (first.b * second.a + second.b) % modulo};
+}
+Affine affine_of(int rank, std::size_t i) { return Affine{long(rank + 2 + i % 7), long(3 * rank + 1 + i % 5)}; }
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    using Algorithm = Parallel::CollectiveAlgorithm;
+    Parallel::CollectiveAlgorithms coll(com);
+    coll.setSegmentSize(1000); // Several segments in the chain for the largest messages
+    const std::vector<std::size_t> sizes{1, 3, 17, 1000, 20000};
+    const int p = com.size;
+
+    for (Algorithm algorithm : {Algorithm::automatic, Algorithm::library, Algorithm::binomial, Algorithm::chain}) {
+        const std::string name = "bcast (algorithm " + std::to_string(int(algorithm)) + ")";
+        for (std::size_t n : sizes)
+            for (int root : {0, p - 1, p / 2}) {
+                std::vector<double> buffer(n, -1.);
+                if (com.rank == root)
+                    for (std::size_t i = 0; i < n; ++i) buffer[i] = 0.5 * i + root;
+                coll.bcast(n, buffer.data(), root, algorithm);
+                bool ok = true;
+                for (std::size_t i = 0; i < n; ++i) ok = ok && (buffer[i] == 0.5 * i + root);
+                check(ok, name);
+            }
+    }
+
+    const std::vector<Algorithm> reductions{Algorithm::automatic, Algorithm::library, Algorithm::recursive_doubling,
+                                            Algorithm::recursive_halving, Algorithm::ring};
+    for (Algorithm algorithm : reductions) {
+        const std::string name = "allreduce (algorithm " + std::to_string(int(algorithm)) + ")";
+        for (std::size_t n : sizes) {
+            std::vector<long> values(n), sums(n), maxs(n);
+            for (std::size_t i = 0; i < n; ++i) values[i] = long(i) + com.rank;
+            coll.allreduce(n, values.data(), sums.data(), Parallel::sum, algorithm);
+            coll.allreduce(n, values.data(), maxs.data(), Parallel::max, algorithm);
+            bool ok = true;
+            for (std::size_t i = 0; i < n; ++i)
+                ok = ok && (sums[i] == long(i) * p + p * (p - 1) / 2) && (maxs[i] == long(i) + p - 1);
+            check(ok, name + " with predefined operations");
+            // In place reduction
+            coll.allreduce(n, values.data(), values.data(), Parallel::sum, algorithm);
+            check(values == sums, name + " in place");
+        }
+    }
+    for (Algorithm algorithm : {Algorithm::automatic, Algorithm::library, Algorithm::recursive_doubling}) {
+        const std::string name = "non commutative allreduce (algorithm " + std::to_string(int(algorithm)) + ")";
+        for (std::size_t n : sizes) {
+            std::vector<Affine> maps(n), result(n);
+            for (std::size_t i = 0; i < n; ++i) maps[i] = affine_of(com.rank, i);
+            coll.allreduce(n, maps.data(), result.data(), compose, false, algorithm);
+            bool ok = true;
+            for (std::size_t i = 0; i < n; ++i) {
+                Affine expected = affine_of(0, i);
+                for (int r = 1; r < p; ++r) expected = compose(expected, affine_of(r, i));
+                ok = ok && (result[i].a == expected.a) && (result[i].b == expected.b);
+            }
+            check(ok, name);
+        }
+    }
+    bool thrown = false;
+    try {
+        Affine map = affine_of(com.rank, 0), result;
+        coll.allreduce(1, &map, &result, compose, false, Algorithm::ring);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    check(thrown, "rejection of a non commutative operation by the ring");
+
+    for (Algorithm algorithm : {Algorithm::automatic, Algorithm::library, Algorithm::ring,
+                                Algorithm::recursive_doubling, Algorithm::bruck}) {
+        const std::string name = "allgather (algorithm " + std::to_string(int(algorithm)) + ")";
+        for (std::size_t n : sizes) {
+            std::vector<int> values(n), all(n * p, -1);
+            for (std::size_t i = 0; i < n; ++i) values[i] = int(1000 * i) + com.rank;
+            coll.allgather(n, values.data(), all.data(), algorithm);
+            bool ok = true;
+            for (int r = 0; r < p; ++r)
+                for (std::size_t i = 0; i < n; ++i) ok = ok && (all[r * n + i] == int(1000 * i) + r);
+            check(ok, name);
+        }
+    }
+
+    // Table of the algorithms : the default ones below the first entry
+    {
+        using Collective = Parallel::CollectiveAlgorithms::Collective;
+        Parallel::CollectiveAlgorithms table(com);
+        table.setAlgorithm(Collective::allreduce, 4096, Algorithm::library);
+        table.setAlgorithm(Collective::allreduce, 1024, Algorithm::ring);
+        check(table.select(Collective::allreduce, 100) == Algorithm::recursive_doubling, "default algorithm");
+        check((table.select(Collective::allreduce, 1024) == Algorithm::ring) &&
+                  (table.select(Collective::allreduce, 2000) == Algorithm::ring) &&
+                  (table.select(Collective::allreduce, 1 << 20) == Algorithm::library),
+              "algorithms given by size");
+        check(table.select(Collective::allreduce, 2000, false) == Algorithm::recursive_doubling,
+              "algorithm of a non commutative operation");
+        table.setAlgorithm(Collective::allreduce, 1024, Algorithm::recursive_halving);
+        check(table.select(Collective::allreduce, 1024) == Algorithm::recursive_halving, "change of an algorithm");
+        check(table.select(Collective::bcast, 100) == Algorithm::binomial, "algorithms of the other operations");
+    }
+
+    // The algorithms chosen by autotuning must be the same on all the processes
+    coll.autotune(std::size_t(1) << 14, 2);
+    for (auto c : {Parallel::CollectiveAlgorithms::Collective::bcast,
+                   Parallel::CollectiveAlgorithms::Collective::allreduce,
+                   Parallel::CollectiveAlgorithms::Collective::allgather})
+        for (std::size_t bytes : {1UL, 8UL, 1000UL, 100000UL}) {
+            int algorithm = int(coll.select(c, bytes)), minAlg, maxAlg;
+            com.allreduce(algorithm, minAlg, Parallel::min);
+            com.allreduce(algorithm, maxAlg, Parallel::max);
+            check((minAlg == maxAlg) && (Algorithm(algorithm) != Algorithm::automatic), "autotuned algorithms");
+        }
+    std::vector<double> values(5000, double(com.rank)), sums(5000);
+    coll.allreduce(values.size(), values.data(), sums.data(), Parallel::sum);
+    check(sums == std::vector<double>(5000, p * (p - 1) / 2.), "autotuned allreduce");
+    log << LogInformation << "Allreduce of 8 bytes : algorithm "
+        << int(coll.select(Parallel::CollectiveAlgorithms::Collective::allreduce, 8)) << ", of 1 MB : algorithm "
+        << int(coll.select(Parallel::CollectiveAlgorithms::Collective::allreduce, 1 << 20)) << std::endl;
+
+    return check.result();
+}
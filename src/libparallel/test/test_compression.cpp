@@ -0,0 +1,135 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the lossless compression of the floating point buffers
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/compression.hpp"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename K>
+bool same_bits(const std::vector<K> &a, const std::vector<K> &b) {
+    return (a.size() == b.size()) && (std::memcmp(a.data(), b.data(), a.size() * sizeof(K)) == 0);
+}
+template <typename K>
+std::vector<K> round_trip(const std::vector<K> &values, std::size_t &nbBytes) {
+    std::vector<unsigned char> stream = Parallel::Compression::compress(values.size(), values.data());
+    nbBytes                           = stream.size();
+    std::vector<K> result(values.size());
+    Parallel::Compression::decompress(stream.size(), stream.data(), result.size(), result.data());
+    return result;
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const std::size_t n = 100000;
+    std::vector<double> smooth(n);
+    for (std::size_t i = 0; i < n; ++i) smooth[i] = 1. + std::floor(1.E6 * std::sin(1.E-4 * i)) * 1.E-6;
+    std::vector<float> noise(n);
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (auto &x : noise) x = dist(gen);
+    // Compression of the buffers
+    {
+        std::size_t nbBytes;
+        check(same_bits(round_trip(smooth, nbBytes), smooth), "round trip of smooth values");
+        check(nbBytes < n * sizeof(double), "compression of smooth values");
+        std::vector<double> steps(n);
+        for (std::size_t i = 0; i < n; ++i) steps[i] = double(i / 100);
+        check(same_bits(round_trip(steps, nbBytes), steps) && (nbBytes < n * sizeof(double) / 4),
+              "compression of piecewise constant values");
+        check(same_bits(round_trip(noise, nbBytes), noise), "round trip of random values");
+        check(nbBytes <= n * sizeof(float) + 16, "size of incompressible values");
+        std::vector<double> special{0., -0., std::numeric_limits<double>::quiet_NaN(),
+                                    std::numeric_limits<double>::infinity(), std::numeric_limits<double>::denorm_min(),
+                                    -std::numeric_limits<double>::max(), 0., 0., 0., 0.};
+        check(same_bits(round_trip(special, nbBytes), special), "round trip of special values");
+        std::vector<float> empty;
+        check(same_bits(round_trip(empty, nbBytes), empty), "round trip of an empty buffer");
+        std::vector<float> tiny{1.5f, 0.f};
+        check(same_bits(round_trip(tiny, nbBytes), tiny), "round trip of a tiny buffer");
+        // Length of a run longer than 64 bits after the header ( number of values, size of the values and mode )
+        std::vector<double> zeros(64, 0.);
+        std::vector<unsigned char> corrupted = Parallel::Compression::compress(zeros.size(), zeros.data());
+        corrupted.resize(sizeof(std::uint64_t) + 2);
+        corrupted.push_back(0);
+        corrupted.insert(corrupted.end(), 12, 0xFF);
+        corrupted.push_back(1);
+        bool rejected = false;
+        try {
+            Parallel::Compression::decompress(corrupted.size(), corrupted.data(), zeros.size(), zeros.data());
+        } catch (const std::runtime_error &) {
+            rejected = true;
+        }
+        check(rejected, "error for a corrupted run length");
+        bool thrown = false;
+        std::vector<unsigned char> stream = Parallel::Compression::compress(n, smooth.data());
+        std::vector<double> small(n / 2);
+        try {
+            Parallel::Compression::decompress(stream.size(), stream.data(), small.size(), small.data());
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        check(thrown, "error for a wrong number of values");
+    }
+    // Compressed messages
+    {
+        // The compressed message follows another message from the same process
+        if (com.rank == 0 && com.size > 1) {
+            int other = 17;
+            com.send(other, 1, 2);
+            com.sendCompressed(n, smooth.data(), 1, 1);
+        }
+        if (com.rank == 1) {
+            std::vector<double> rcv(n);
+            Parallel::Status status = com.recvCompressed(n, rcv.data(), Parallel::any_source, 1);
+            int other;
+            com.recv(other, 0, 2);
+            check(same_bits(rcv, smooth) && (status.source() == 0) && (other == 17), "compressed send and receive");
+        }
+        std::vector<float> values(n, 0.f);
+        if (com.rank == 0) values = noise;
+        com.bcastCompressed(n, values.data(), values.data(), 0);
+        check(same_bits(values, noise), "compressed broadcast");
+        std::vector<double> fields(n, 0.);
+        com.setCompression(1024);
+        check(com.compressionThreshold() == 1024, "compression threshold");
+        if (com.rank == com.size - 1)
+            com.bcast(n, smooth.data(), fields.data(), com.size - 1);
+        else
+            com.bcast(n, fields.data(), com.size - 1);
+        check(same_bits(fields, smooth), "broadcast compressed by the threshold");
+        std::vector<int> ints(n, com.rank == 0 ? 3 : 0);
+        com.bcast(n, ints.data(), ints.data(), 0);
+        check(ints == std::vector<int>(n, 3), "broadcast of values which aren't compressed");
+    }
+
+    return check.result();
+}
@@ -0,0 +1,94 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the communication tasks written as coroutines ( C++20 )
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/coroutine.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+using Parallel::Async::Task;
+// Exchange of a message with each neighbour of the ring, several rounds
+Task ring(const Parallel::Communicator &com, int tag, int nbRounds, std::vector<int> &received) {
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+    for (int round = 0; round < nbRounds; ++round) {
+        int snd = 1000 * tag + round, rcv = -1;
+        auto r  = Parallel::Async::recv(com, 1, &rcv, prev, tag);
+        co_await Parallel::Async::send(com, 1, &snd, next, tag);
+        Parallel::Status status = co_await r;
+        if (status.source() == prev) received.push_back(rcv);
+        co_await Parallel::Async::yield();
+    }
+}
+Task collectives(const Parallel::Communicator &com, int tag, std::vector<long> &result) {
+    co_await Parallel::Async::barrier(com, tag);
+    std::vector<long> values(3, com.rank == 1 % com.size ? 7 : 0);
+    co_await Parallel::Async::bcast(com, values.size(), values.data(), 1 % com.size, tag);
+    std::vector<long> loc{com.rank + 1L, values[0], 1L}, glob(3);
+    co_await Parallel::Async::allreduce(com, loc.size(), loc.data(), glob.data(),
+                                        [](long a, long b) { return a + b; }, tag);
+    result = glob;
+}
+Task failing(const Parallel::Communicator &com) {
+    co_await Parallel::Async::yield();
+    if (com.size > 0) throw std::runtime_error("failure of a task");
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    // Several tasks interleaved on the same process
+    {
+        std::vector<int> ring1, ring2;
+        std::vector<long> glob1, glob2;
+        Parallel::Async::Scheduler scheduler;
+        scheduler.spawn(ring(com, 1, 5, ring1));
+        scheduler.spawn(ring(com, 2, 5, ring2));
+        scheduler.spawn(collectives(com, 3, glob1));
+        scheduler.spawn(collectives(com, 4, glob2));
+        scheduler.run();
+        check((ring1 == std::vector<int>{1000, 1001, 1002, 1003, 1004}) &&
+                  (ring2 == std::vector<int>{2000, 2001, 2002, 2003, 2004}),
+              "interleaved rings");
+        std::vector<long> expected{com.size * (com.size + 1L) / 2, 7L * com.size, long(com.size)};
+        check((glob1 == expected) && (glob2 == expected), "interleaved collective operations");
+    }
+    // The exception of a task is thrown by run, after the end of the other tasks
+    {
+        std::vector<int> received;
+        Parallel::Async::Scheduler scheduler;
+        scheduler.spawn(failing(com));
+        scheduler.spawn(ring(com, 5, 2, received));
+        bool thrown = false;
+        try {
+            scheduler.run();
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        check(thrown && (received.size() == 2), "exception thrown by a task");
+    }
+
+    return check.result();
+}
@@ -0,0 +1,125 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the distributions of the distributed arrays and of the update of their ghost layers
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/distributed_array.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace {
+double value(std::size_t i, std::size_t j) { return 1000. * double(i) + double(j); }
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+
+    // Block distribution in two dimensions with two ghost layers
+    const std::size_t nx = 13, ny = 10;
+    Parallel::DistributedArray<double, 2> u(com, {{nx, ny}}, 2);
+    check(u.grid_shape()[0] * u.grid_shape()[1] == com.size, "grid of processes");
+    long nb_local = long(u.local_size()), nb_total;
+    com.allreduce(nb_local, nb_total, Parallel::sum);
+    check(nb_total == long(nx * ny), "number of elements of the block distribution");
+    u.fill(-1.);
+    const auto n = u.local_shape();
+    bool ok = true;
+    for (long i = 0; i < long(n[0]); ++i)
+        for (long j = 0; j < long(n[1]); ++j) {
+            auto g = u.to_global({{i, j}});
+            ok     = ok && (u.owner(g) == com.rank) && (u.to_local(g) == decltype(u)::local_index{{i, j}});
+            u({{i, j}}) = value(g[0], g[1]);
+        }
+    check(ok, "global to local translation of the block distribution");
+    u.update_ghosts();
+    // All the elements of the ghost layers ( corners included ) inside the array are updated
+    ok = true;
+    for (long i = -2; i < long(n[0]) + 2; ++i)
+        for (long j = -2; j < long(n[1]) + 2; ++j) {
+            auto g = u.to_global({{i, j}});
+            if ((n[0] == 0) || (n[1] == 0) || (long(g[0]) < 0) || (g[0] >= nx) || (long(g[1]) < 0) || (g[1] >= ny))
+                continue;
+            ok = ok && (u({{i, j}}) == value(g[0], g[1])) && (u.at(g) == u({{i, j}}));
+        }
+    check(ok, "update of the ghost layers");
+    bool thrown = false;
+    try {
+        u.at({{nx, 0}});
+    } catch (std::out_of_range &) {
+        thrown = true;
+    }
+    check(thrown, "access out of the array");
+
+    // Ghost layers wider than the elements owned by some neighbours
+    Parallel::DistributedArray<double, 1> s(com, {{5}}, 2);
+    s.fill(-1.);
+    const long ns = long(s.local_shape()[0]);
+    for (long i = 0; i < ns; ++i) s({{i}}) = double(s.to_global({{i}})[0]);
+    s.update_ghosts();
+    ok = true;
+    for (long i : {-1L, ns}) {
+        auto g = s.to_global({{i}});
+        if ((ns == 0) || (long(g[0]) < 0) || (g[0] >= 5)) continue;
+        ok = ok && (s({{i}}) == double(g[0]));
+    }
+    check(ok, "update of the ghost layers wider than the neighbours");
+
+    // Cyclic and block cyclic distributions, the first dimension on all the processes
+    std::array<Parallel::DistributedArray<int, 2>::Dimension, 2> dims;
+    dims[0].size         = 23;
+    dims[0].distribution = Parallel::Distribution::block_cyclic;
+    dims[0].block_size   = 3;
+    dims[0].nb_procs     = com.size;
+    dims[1].size         = 5;
+    dims[1].distribution = Parallel::Distribution::cyclic;
+    Parallel::DistributedArray<int, 2> v(com, dims);
+    check((v.grid_shape()[0] == com.size) && (v.grid_shape()[1] == 1), "given grid of processes");
+    nb_local = long(v.local_size());
+    com.allreduce(nb_local, nb_total, Parallel::sum);
+    check(nb_total == 23 * 5, "number of elements of the block cyclic distribution");
+    ok = true;
+    for (long i = 0; i < long(v.local_shape()[0]); ++i)
+        for (long j = 0; j < long(v.local_shape()[1]); ++j) {
+            auto g = v.to_global({{i, j}});
+            ok     = ok && (g[0] < 23) && (g[0] / 3 % std::size_t(com.size) == std::size_t(com.rank)) &&
+                 (v.owner(g) == com.rank) && (v.to_local(g) == decltype(v)::local_index{{i, j}});
+            v({{i, j}}) = int(g[0] * 5 + g[1]);
+        }
+    check(ok, "global to local translation of the block cyclic distribution");
+    // Each element has a single owner
+    long sum_local = 0, sum;
+    for (long i = 0; i < long(v.local_shape()[0]); ++i)
+        for (long j = 0; j < long(v.local_shape()[1]); ++j) sum_local += v({{i, j}});
+    com.allreduce(sum_local, sum, Parallel::sum);
+    check(sum == 23 * 5 * (23 * 5 - 1) / 2, "elements of the block cyclic distribution");
+
+    thrown = false;
+    try {
+        dims[1].ghosts = 1;
+        Parallel::DistributedArray<int, 2> w(com, dims);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    check(thrown, "ghost layers of a cyclic distribution");
+
+    return check.result();
+}
@@ -0,0 +1,122 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the collective read and write of the distributed arrays : an array written with a
+// distribution is read back with another one.
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/file.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+double value(std::size_t i, std::size_t j) { return 100. * double(i) + double(j); }
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const std::string filename = "test_file.dat";
+    const std::size_t nx = 17, ny = 11;
+
+    // Block distribution with ghost layers ( not written )
+    Parallel::DistributedArray<double, 2> u(com, {{nx, ny}}, 1);
+    u.fill(-1.);
+    for (long i = 0; i < long(u.local_shape()[0]); ++i)
+        for (long j = 0; j < long(u.local_shape()[1]); ++j) {
+            auto g      = u.to_global({{i, j}});
+            u({{i, j}}) = value(g[0], g[1]);
+        }
+    {
+        Parallel::File file(com, filename, Parallel::File::out);
+        file.write(u);
+    }
+
+    // Read back with a block cyclic distribution of the rows and a cyclic distribution of the columns
+    {
+        Parallel::File file(com, filename, Parallel::File::in);
+        check(file.header().item_size == sizeof(double) && file.header().kind == 'f', "type of the header");
+        auto shape = file.shape<2>();
+        check(shape[0] == nx && shape[1] == ny, "shape of the header");
+        std::array<Parallel::DistributedArray<double, 2>::Dimension, 2> dims;
+        dims[0].size         = shape[0];
+        dims[0].distribution = Parallel::Distribution::block_cyclic;
+        dims[0].block_size   = 2;
+        dims[1].size         = shape[1];
+        dims[1].distribution = Parallel::Distribution::cyclic;
+        Parallel::DistributedArray<double, 2> v(com, dims);
+        file.read(v);
+        bool ok = true;
+        for (long i = 0; i < long(v.local_shape()[0]); ++i)
+            for (long j = 0; j < long(v.local_shape()[1]); ++j) {
+                auto g = v.to_global({{i, j}});
+                ok     = ok && (v({{i, j}}) == value(g[0], g[1]));
+            }
+        check(ok, "read of a distributed array");
+        bool thrown = false;
+        try {
+            Parallel::DistributedArray<float, 2> w(com, {{nx, ny}});
+            file.read(w);
+        } catch (std::runtime_error &) {
+            thrown = true;
+        }
+        check(thrown, "read with a wrong type");
+    }
+
+    // Blocks of rows of a matrix, read back as a distributed array
+    const std::size_t nb_rows = 3;
+    std::vector<int> block(nb_rows * ny);
+    for (std::size_t i = 0; i < block.size(); ++i) block[i] = int(com.rank * block.size() + i);
+    {
+        Parallel::File file(com, filename, Parallel::File::out);
+        file.write<int, 2>({{nb_rows * com.size, ny}}, {{nb_rows * com.rank, 0}}, {{nb_rows, ny}}, block.data());
+    }
+    {
+        Parallel::File file(com, filename, Parallel::File::in);
+        Parallel::DistributedArray<int, 2> m(com, file.shape<2>());
+        file.read(m);
+        bool ok = true;
+        for (long i = 0; i < long(m.local_shape()[0]); ++i)
+            for (long j = 0; j < long(m.local_shape()[1]); ++j) {
+                auto g = m.to_global({{i, j}});
+                ok     = ok && (m({{i, j}}) == int(g[0] * ny + g[1]));
+            }
+        check(ok, "write of blocks of a matrix");
+        // The block of the next process
+        int next = (com.rank + 1) % com.size;
+        std::vector<int> next_block(nb_rows * ny);
+        file.read<int, 2>({{nb_rows * next, 0}}, {{nb_rows, ny}}, next_block.data());
+        check(next_block[0] == int(next * block.size()) && next_block.back() == int((next + 1) * block.size() - 1),
+              "read of a block");
+        bool thrown = false;
+        try {
+            file.read<int, 2>({{0, 0}}, {{65536, 65536}}, next_block.data());
+        } catch (std::overflow_error &) {
+            thrown = true;
+        }
+        check(thrown, "read of a block over the largest count");
+    }
+    com.barrier();
+    if (com.rank == 0) std::remove(filename.c_str());
+
+    return check.result();
+}
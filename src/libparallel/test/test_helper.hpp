@@ -0,0 +1,70 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Checks and verdict shared by the tests of the library
+#ifndef _PARALLEL_TEST_HELPER_HPP_
+#define _PARALLEL_TEST_HELPER_HPP_
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include <cstdlib>
+#include <string>
+
+namespace Test {
+/**
+ * @brief      Print the verdict of a test and return the exit code of the program
+ */
+inline int verdict(Core::Logger &log, bool passed) {
+    if (passed)
+        log << LogInformation << Core::Logger::BGreen << "Test passed." << Core::Logger::Normal << std::endl;
+    else
+        log << LogError << "Test failed !" << std::endl;
+    return (passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+/**
+ * @brief      Checks of a test on the processes of a communicator : each failed check is logged
+ *             with the rank, and the test passes if all the checks of all the processes pass.
+ *
+ * @code
+ *             Test::Checker check(log, com);
+ *             check(sum == expected, "allreduce");
+ *             return check.result();
+ * @endcode
+ */
+class Checker {
+  public:
+    Checker(Core::Logger &log, const Parallel::Communicator &com) : m_log(log), m_com(com) {}
+    Checker(const Checker &) = delete;
+    Checker &operator=(const Checker &) = delete;
+
+    void operator()(bool cond, const std::string &msg) {
+        if (!cond) {
+            m_log << LogError << "Rank " << m_com.rank << " : " << msg << " failed !" << std::endl;
+            m_ok = false;
+        }
+    }
+    /**
+     * @brief      Verdict of the test on all the processes ( collective call ) and exit code
+     */
+    int result() const {
+        int allOK = (m_ok ? 1 : 0), globOK;
+        m_com.allreduce(allOK, globOK, Parallel::min);
+        return verdict(m_log, globOK == 1);
+    }
+
+  private:
+    Core::Logger &m_log;
+    const Parallel::Communicator &m_com;
+    bool m_ok = true;
+};
+}
+#endif
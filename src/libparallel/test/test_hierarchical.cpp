@@ -0,0 +1,93 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the two level collective operations ( the nodes are emulated by groups of consecutive ranks )
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+struct Cell {
+    double value;
+    int owner;
+};
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const std::size_t n    = 1000;
+    const double sum_ranks = com.size * (com.size - 1) / 2.;
+    for (int ranks_per_node : {0, 2, 3}) {
+        const std::string nodes = " with " + std::to_string(ranks_per_node) + " ranks per node";
+        com.setHierarchicalCollectives(std::numeric_limits<std::size_t>::max(), ranks_per_node);
+        // Explicit two level operations, for all the roots ( leaders of a node or not )
+        for (int root = 0; root < com.size; ++root) {
+            std::vector<double> values(n), bcasted(n, -1.);
+            for (std::size_t i = 0; i < n; ++i) values[i] = root + double(i);
+            com.hierarchical_bcast(n, values.data(), bcasted.data(), root);
+            check(std::equal(values.begin(), values.end(), bcasted.begin()), "broadcast" + nodes);
+
+            std::vector<Cell> cells(n, Cell{double(com.rank), com.rank});
+            if (com.rank != root) std::fill(cells.begin(), cells.end(), Cell{-1., -1});
+            com.hierarchical_bcast(n, cells.data(), cells.data(), root);
+            check(std::all_of(cells.begin(), cells.end(), [&](const Cell &c) { return c.owner == root; }),
+                  "broadcast in place of packed objects" + nodes);
+
+            for (std::size_t i = 0; i < n; ++i) values[i] = com.rank + double(i);
+            std::vector<double> sums(n, 0.);
+            com.hierarchical_reduce(n, values.data(), sums.data(), Parallel::sum, root);
+            if (com.rank == root) {
+                bool ok = true;
+                for (std::size_t i = 0; i < n; ++i) ok = ok && (sums[i] == sum_ranks + com.size * double(i));
+                check(ok, "reduce" + nodes);
+            }
+        }
+        std::vector<double> values(n), sums(n, 0.);
+        for (std::size_t i = 0; i < n; ++i) values[i] = com.rank + double(i);
+        com.hierarchical_allreduce(n, values.data(), sums.data(), Parallel::sum);
+        bool ok = true;
+        for (std::size_t i = 0; i < n; ++i) ok = ok && (sums[i] == sum_ranks + com.size * double(i));
+        check(ok, "allreduce" + nodes);
+        com.hierarchical_allreduce(n, values.data(), values.data(), Parallel::sum);
+        check(values == sums, "allreduce in place" + nodes);
+        int max_rank;
+        com.hierarchical_allreduce(1, &com.rank, &max_rank, Parallel::max);
+        check(max_rank == com.size - 1, "allreduce with max" + nodes);
+
+        // The usual operations switch to the two level algorithms from the threshold
+        com.setHierarchicalCollectives(1024, ranks_per_node);
+        std::vector<double> large(n, double(com.rank)), small(10, double(com.rank));
+        com.bcast(n, large.data(), large.data(), com.size - 1);
+        com.bcast(small.size(), small.data(), small.data(), com.size - 1);
+        check((large[n - 1] == com.size - 1.) && (small[9] == com.size - 1.), "switched broadcast" + nodes);
+        std::vector<double> large_sums(n);
+        com.allreduce(n, large.data(), large_sums.data(), Parallel::sum);
+        check(large_sums[0] == com.size * (com.size - 1.), "switched allreduce" + nodes);
+        com.reduce(n, large.data(), large_sums.data(), Parallel::min, 0);
+        if (com.rank == 0) check(large_sums[0] == com.size - 1., "switched reduce" + nodes);
+    }
+    com.setHierarchicalCollectives(std::numeric_limits<std::size_t>::max());
+
+    return check.result();
+}
@@ -0,0 +1,135 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the messages with more elements than the largest count given to MPI. The largest count
+// is lowered, so the buffers of a few thousands elements are sent in blocks.
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+struct Particle {
+    double x, y;
+    int id;
+};
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    check(Parallel::Communicator::maxCount() == Parallel::Communicator::default_max_count, "default largest count");
+    // Two full blocks and a partial one
+    Parallel::Communicator::setMaxCount(1000);
+    const std::size_t n = 2500;
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+
+    // Point to point messages along a ring
+    std::vector<double> snd(n), rcv(n, -1.);
+    for (std::size_t i = 0; i < n; ++i) snd[i] = com.rank * 1.E4 + i;
+    Parallel::Request req = com.isend(n, snd.data(), next, 1);
+    Parallel::Status status = com.recv(n, rcv.data(), prev, 1);
+    req.wait();
+    bool ok = true;
+    for (std::size_t i = 0; i < n; ++i) ok = ok && (rcv[i] == prev * 1.E4 + i);
+    check(ok, "send and receive of a buffer");
+    check(status.source() == prev, "status of a large message");
+
+    std::vector<Particle> particles(n), rcv_particles(n);
+    for (std::size_t i = 0; i < n; ++i) particles[i] = Particle{double(i), double(com.rank), int(i)};
+    req = com.isend(n, particles.data(), next, 2);
+    Parallel::Request rreq = com.irecv(n, rcv_particles.data(), prev, 2);
+    rreq.wait();
+    req.wait();
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i)
+        ok = ok && (rcv_particles[i].x == i) && (rcv_particles[i].y == prev) && (rcv_particles[i].id == int(i));
+    check(ok, "non blocking send and receive of packed objects");
+
+    // The receive sizes the container from the number of elements of the message
+    std::vector<double> container;
+    req = com.isend(snd, next, 3);
+    com.recv(container, prev, 3);
+    req.wait();
+    check(container == rcv, "receive of a container");
+    std::vector<Particle> rcv_container;
+    req = com.isend(particles, next, 4);
+    com.recv(rcv_container, prev, 4);
+    req.wait();
+    check(rcv_container.size() == n, "receive of a container of packed objects");
+
+    // Broadcasts
+    std::vector<double> bcasted(n, -1.);
+    com.bcast(n, (com.rank == 0 ? snd.data() : nullptr), bcasted.data(), 0);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) ok = ok && (bcasted[i] == double(i));
+    check(ok, "broadcast of a buffer");
+    std::vector<Particle> bcasted_particles(n);
+    com.bcast(n, (com.rank == 0 ? particles.data() : nullptr), bcasted_particles.data(), 0);
+    check(std::all_of(bcasted_particles.begin(), bcasted_particles.end(), [](const Particle &p) { return p.y == 0.; }),
+          "broadcast of packed objects");
+
+    // Reductions, done by successive calls on the blocks
+    const double sum_ranks = com.size * (com.size - 1) / 2.;
+    std::vector<double> values(n), sums(n, 0.);
+    for (std::size_t i = 0; i < n; ++i) values[i] = com.rank + double(i);
+    com.reduce(n, values.data(), sums.data(), Parallel::sum, 0);
+    if (com.rank == 0) {
+        ok = true;
+        for (std::size_t i = 0; i < n; ++i) ok = ok && (sums[i] == sum_ranks + com.size * double(i));
+        check(ok, "reduce of a buffer");
+    }
+    std::vector<double> in_place(values);
+    com.allreduce(n, in_place.data(), in_place.data(), Parallel::sum);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) ok = ok && (in_place[i] == sum_ranks + com.size * double(i));
+    check(ok, "allreduce in place");
+    std::vector<double> vsums;
+    com.allreduce(values, vsums, Parallel::sum);
+    check(vsums == in_place, "allreduce of a container");
+    auto keep_max = [](const Particle &a, const Particle &b) { return (a.y > b.y ? a : b); };
+    std::vector<Particle> max_particles(n);
+    com.allreduce(n, particles.data(), max_particles.data(), keep_max, true);
+    check(std::all_of(max_particles.begin(), max_particles.end(),
+                      [&](const Particle &p) { return p.y == com.size - 1.; }),
+          "allreduce of packed objects with a functor");
+
+    // v-collective operations : large counts with MPI 4, an error otherwise
+    std::vector<std::size_t> counts(com.size, n);
+    std::vector<double> gathered(n * com.size, -1.);
+#if defined(PARALLEL_LARGE_COUNT_FUNCTIONS)
+    com.allgatherv(n, snd.data(), counts, gathered.data());
+    check((gathered[n * prev] == prev * 1.E4) && (gathered[n * com.size - 1] == (com.size - 1) * 1.E4 + n - 1),
+          "allgatherv of buffers");
+#else
+    bool thrown = false;
+    try {
+        com.allgatherv(n, snd.data(), counts, gathered.data());
+    } catch (std::overflow_error &) {
+        thrown = true;
+    }
+    check(thrown, "error for an allgatherv over the largest count");
+#endif
+
+    Parallel::Communicator::setMaxCount(Parallel::Communicator::default_max_count);
+    return check.result();
+}
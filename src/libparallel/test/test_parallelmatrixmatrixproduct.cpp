@@ -17,10 +17,12 @@
 #include "core/logger.hpp"
 #include "core/multitimer.hpp"
 #include "core/std_cpp_chronometer.hpp"
+#include "parallel/broadcast_pipeline.hpp"
 #include "parallel/communicator"
 #include "parallel/context.hpp"
 #include "parallel/log_from_distributed_file.hpp"
 #include "parallel/log_from_root_output.hpp"
+#include "parallel/process_grid.hpp"
 #include <cassert>
 #include <cmath>
 #include <string>
@@ -181,19 +183,23 @@ int main(int nargs, char *argv[]) {
 
     std::size_t dim    = 120;
     if (nargs > 1) dim = std::stoul(std::string(argv[1]));
-    // Prepare the parallel computation :
-    int p                 = int(std::sqrt(globCom.size));
+    // Prepare the parallel computation : the grid of blocks is placed on the nodes, so most of the
+    // broadcasts in the rows and the columns stay inside the nodes
+    int p = int(std::sqrt(globCom.size));
+    Parallel::ProcessGrid grid(globCom, {p, p});
     std::size_t dim_block = dim / p;
-    int IBlock            = globCom.rank % p;
-    int JBlock            = globCom.rank / p;
+    int IBlock            = grid.coordinates()[0];
+    int JBlock            = grid.coordinates()[1];
     std::size_t begRow    = IBlock * dim_block;
     std::size_t begCol    = JBlock * dim_block;
     log << LogInformation << "Number of blocks per direction " << p << std::endl
         << "Dimension of each block : " << dim_block << std::endl
+        << "Blocks of each node : " << grid.node_dimensions()[0] << " x " << grid.node_dimensions()[1] << std::endl
         << "Indice of C block : " << IBlock << " : " << JBlock << std::endl
         << "Beginning of the row and column indices : " << begRow << ", " << begCol << std::endl;
-    Parallel::Communicator rowCom(globCom, IBlock, JBlock);
-    Parallel::Communicator colCom(globCom, JBlock, IBlock);
+    auto pt_rowCom = grid.line(1);
+    auto pt_colCom = grid.line(0);
+    Parallel::Communicator &rowCom = *pt_rowCom, &colCom = *pt_colCom;
     assert(rowCom.size == p);
     assert(rowCom.rank == JBlock);
     assert(colCom.size == p);
@@ -219,14 +225,14 @@ int main(int nargs, char *argv[]) {
     BlockMatrix<double> C(A.getNRows(), B.getNCols());
     // Parallel product :
 
+    // The blocks of A and B of the step kBlock+1 are broadcast during the product of the step kBlock
     timer["Product Matrix-matrix"].start();
-    BlockMatrix<double> Atmp(dim_block, dim_block), Btmp(dim_block, dim_block);
-
-    for (int kBlock = 0; kBlock < p; ++kBlock) {
-        rowCom.bcast(A, Atmp, kBlock);
-        colCom.bcast(B, Btmp, kBlock);
-        prodMatrixMatrixBloc(Atmp, Btmp, C);
-    }
+    Parallel::BroadcastPipeline<BlockMatrix<double>> pipeline;
+    pipeline.add(rowCom, A, [](int kBlock) { return kBlock; }, [&A](int) -> const BlockMatrix<double> & { return A; });
+    pipeline.add(colCom, B, [](int kBlock) { return kBlock; }, [&B](int) -> const BlockMatrix<double> & { return B; });
+    pipeline.run(p, [&C](int, const std::vector<const BlockMatrix<double> *> &blocks) {
+        prodMatrixMatrixBloc(*blocks[0], *blocks[1], C);
+    });
     timer["Product Matrix-matrix"].stop();
 
     timer["Verify Matrix-matrix"].start();
@@ -0,0 +1,81 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the grids of processes placed on the nodes ( emulated by groups of consecutive ranks )
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "parallel/process_grid.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+
+    // Shapes of the tiles
+    using Grid = Parallel::ProcessGrid;
+    check(Grid::node_tile({4, 4}, 4) == std::vector<int>({2, 2}), "square tile");
+    check(Grid::node_tile({2, 4}, 4) == std::vector<int>({2, 2}), "tile of a rectangular grid");
+    check(Grid::node_tile({6, 2}, 4) == std::vector<int>({2, 2}), "tile constrained by the grid");
+    check(Grid::node_tile({8, 8, 8}, 8) == std::vector<int>({2, 2, 2}), "3D tile");
+    check(Grid::node_tile({3, 3}, 2).empty(), "grid without tile");
+    check(Grid::balanced_dimensions(12, {0, 0}) == std::vector<int>({3, 4}), "balanced dimensions");
+    check(Grid::balanced_dimensions(12, {2, 0, 0}) == std::vector<int>({2, 3, 2}), "fixed dimension");
+    bool thrown = false;
+    try {
+        Grid grid(com, {com.size + 1});
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    check(thrown, "grid larger than the communicator");
+
+    // Nodes of two or four processes ( the last one may be smaller, so the order is kept )
+    const int ranks_per_node = (com.size % 4 == 0 ? 4 : 2);
+    Grid grid(com, {(com.size % 2 == 0 ? 2 : 1), 0}, ranks_per_node);
+    const auto &dims   = grid.dimensions();
+    const auto &coords = grid.coordinates();
+    check(dims[0] * dims[1] == com.size, "size of the grid");
+    check(grid.communicator().rank == grid.rankOf(coords) && grid.coordinates(grid.communicator().rank) == coords,
+          "rank of the coordinates");
+    // Each position of the grid is given to one process
+    std::vector<int> positions(com.size);
+    com.allgather(grid.rankOf(coords), positions.data());
+    check(std::set<int>(positions.begin(), positions.end()).size() == std::size_t(com.size),
+          "permutation of the ranks");
+    auto row = grid.line(1), column = grid.line(0);
+    check(row->size == dims[1] && row->rank == coords[1], "row communicator");
+    check(column->size == dims[0] && column->rank == coords[0], "column communicator");
+    // The processes of a node form a tile of the grid
+    const auto &tile = grid.node_dimensions();
+    if (tile[0] * tile[1] == ranks_per_node) {
+        const int node = com.rank / ranks_per_node;
+        std::vector<int> row_nodes(row->size), column_nodes(column->size);
+        row->allgather(node, row_nodes.data());
+        column->allgather(node, column_nodes.data());
+        check(std::count(row_nodes.begin(), row_nodes.end(), node) == tile[1] &&
+                  std::count(column_nodes.begin(), column_nodes.end(), node) == tile[0],
+              "processes of a node in a tile");
+    }
+
+    return check.result();
+}
@@ -0,0 +1,59 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the progress thread of the context
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+    // Large messages around a ring, transferred while the process computes
+    auto exchange = [&](const std::string &msg) {
+        const std::size_t n = std::size_t(1) << 20;
+        std::vector<double> snd(n, double(com.rank)), rcv(n, -1.);
+        Parallel::Request rcv_req = com.irecv(n, rcv.data(), prev, 1);
+        Parallel::Request snd_req = com.isend(n, snd.data(), next, 1);
+        double x = 0.;
+        for (int i = 0; i < 1000000; ++i) x += std::sqrt(double(i));
+        snd_req.wait();
+        rcv_req.wait();
+        check((x > 0.) && std::all_of(rcv.begin(), rcv.end(), [prev](double v) { return v == prev; }), msg);
+    };
+    check(!context.hasProgressThread(), "no progress thread by default");
+    if (context.levelOfThreadSupport() == Parallel::Context::Multiple) {
+        context.startProgressThread();
+        check(context.hasProgressThread(), "start of the progress thread");
+        exchange("exchange with the progress thread");
+        context.stopProgressThread();
+        check(!context.hasProgressThread(), "stop of the progress thread");
+        // Busy polling thread pinned on the first core, stopped by the destructor of the context
+        context.startProgressThread(0., 0);
+        exchange("exchange with a pinned progress thread");
+    }
+    exchange("exchange without progress thread");
+
+    return check.result();
+}
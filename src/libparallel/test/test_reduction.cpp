@@ -0,0 +1,90 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the reductions with predefined operations and user functors
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+struct MinMax {
+    double min, max;
+};
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const int root       = com.size - 1;
+    const double sum_ref = com.size * (com.size + 1) / 2.;
+    // Predefined operation on buffers :
+    std::vector<double> loc(100, com.rank + 1.), glob(100, 0.);
+    com.reduce(loc.size(), loc.data(), glob.data(), Parallel::sum, root);
+    if (com.rank == root)
+        check(std::all_of(glob.begin(), glob.end(), [&](double v) { return v == sum_ref; }), "reduce with sum");
+    // User functors on scalars, buffers and containers ( several calls reuse the same MPI operation ) :
+    auto add = [](const double &x, const double &y) { return x + y; };
+    for (int i = 0; i < 3; ++i) {
+        double x = com.rank + 1., y = 0.;
+        com.allreduce(x, y, add, true);
+        check(y == sum_ref, "allreduce of a scalar with a functor");
+        com.reduce(x, y, add, true, root);
+        if (com.rank == root) check(y == sum_ref, "reduce of a scalar with a functor");
+    }
+    std::fill(glob.begin(), glob.end(), 0.);
+    com.allreduce(loc.size(), loc.data(), glob.data(), add, true);
+    check(std::all_of(glob.begin(), glob.end(), [&](double v) { return v == sum_ref; }), "allreduce with a functor");
+    std::vector<double> vglob;
+    com.allreduce(loc, vglob, add, true);
+    check(vglob == glob, "allreduce of a container with a functor");
+    // Functor with a state on a packed type : the bounds clamp the partial results, so the result
+    // doesn't depend on the order of the combinations
+    double lower = 0.5, upper = com.size - 1.5;
+    auto minmax  = [&lower, &upper](const MinMax &a, const MinMax &b) {
+        return MinMax{std::max(std::min(a.min, b.min), lower), std::min(std::max(a.max, b.max), upper)};
+    };
+    MinMax mm{double(com.rank), double(com.rank)}, res{-1., -1.};
+    com.allreduce(mm, res, minmax, true);
+    if (com.size == 1)
+        check((res.min == 0.) && (res.max == 0.), "allreduce of a packed type with a functor");
+    else
+        check((res.min == lower) && (res.max == upper), "allreduce of a packed type with a functor");
+    // Containers of a packed type :
+    auto hull = [](const MinMax &a, const MinMax &b) {
+        return MinMax{std::min(a.min, b.min), std::max(a.max, b.max)};
+    };
+    std::vector<MinMax> vmm(10), vres;
+    for (std::size_t i = 0; i < vmm.size(); ++i) vmm[i] = MinMax{double(com.rank + i), double(com.rank + i)};
+    auto is_hull = [&](const std::vector<MinMax> &v) {
+        bool ok = (v.size() == vmm.size());
+        for (std::size_t i = 0; ok && (i < v.size()); ++i)
+            ok = (v[i].min == double(i)) && (v[i].max == double(com.size - 1 + i));
+        return ok;
+    };
+    com.allreduce(vmm, vres, hull, true);
+    check(is_hull(vres), "allreduce of a container of a packed type with a functor");
+    vres.clear();
+    com.reduce(vmm, vres, hull, true, root);
+    if (com.rank == root) check(is_hull(vres), "reduce of a container of a packed type with a functor");
+
+    return check.result();
+}
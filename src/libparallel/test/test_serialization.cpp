@@ -0,0 +1,136 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the messages of serialized objects : standard containers of non trivially copyable
+// values and user types with a serialize member or a Serializer specialization.
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+struct Mesh {
+    std::string name;
+    std::vector<double> coordinates;
+    std::map<int, std::vector<int>> groups;
+    template <typename Archive>
+    void serialize(Archive &ar) {
+        ar & name & coordinates & groups;
+    }
+    bool operator==(const Mesh &m) const {
+        return (name == m.name) && (coordinates == m.coordinates) && (groups == m.groups);
+    }
+};
+// A type which can't be changed
+struct Label {
+    Label() = default;
+    explicit Label(const std::string &s) : text(s) {}
+    Label(const Label &) = default;
+    Label &operator=(const Label &) = default;
+    ~Label() {}
+    std::string text;
+};
+Mesh make_mesh(int rank) {
+    Mesh mesh;
+    mesh.name = "mesh of " + std::to_string(rank);
+    mesh.coordinates.resize(3000);
+    for (std::size_t i = 0; i < mesh.coordinates.size(); ++i) mesh.coordinates[i] = rank + 0.5 * i;
+    mesh.groups[1] = {1, 2, 3};
+    mesh.groups[7] = std::vector<int>(rank, 7);
+    return mesh;
+}
+}
+namespace Parallel {
+namespace Serialization {
+template <>
+struct Serializer<Label> {
+    template <typename Archive>
+    static void apply(Archive &ar, Label &label) {
+        ar & label.text;
+    }
+};
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    static_assert(!Parallel::Serialization::needs_serialization<std::vector<double>>::value, "flat container");
+    static_assert(Parallel::Serialization::needs_serialization<std::vector<std::string>>::value, "strings");
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+
+    // The large coordinates are referenced by the stream, the other parts are copied
+    Mesh mesh = make_mesh(com.rank);
+    {
+        Parallel::Serialization::OutputArchive archive(mesh);
+        const auto &parts = archive.parts();
+        check((parts.size() == 3) && (parts[1].data == (const char *)mesh.coordinates.data()), "zero copy parts");
+        Mesh copy;
+        std::vector<char> stream = archive.contiguous();
+        Parallel::Serialization::deserialize(stream.data(), stream.size(), copy);
+        check(copy == mesh, "serialization of an object");
+    }
+
+    // Point to point messages along a ring
+    std::vector<std::string> words{"alpha", "", std::string(5000, 'x'), std::to_string(com.rank)}, rcv_words;
+    std::map<std::string, double> values{{"pi", 3.14159}, {"rank", double(com.rank)}}, rcv_values;
+    std::vector<std::vector<double>> rows(3), rcv_rows;
+    for (std::size_t i = 0; i < rows.size(); ++i) rows[i].assign(100 * i, double(com.rank));
+    std::list<Label> labels{Label("a"), Label(std::to_string(com.rank))}, rcv_labels;
+    Mesh rcv_mesh;
+    if (com.size > 1) {
+        // The rank 0 sends first, the other ranks forward after their receive
+        auto send_all = [&]() {
+            com.send(words, next, 1);
+            com.send(values, next, 2);
+            com.send(rows, next, 3);
+            com.send(labels, next, 4);
+            com.send(mesh, next, 5);
+        };
+        if (com.rank == 0) send_all();
+        com.recv(rcv_words, prev, 1);
+        com.recv(rcv_values, prev, 2);
+        com.recv(rcv_rows, prev, 3);
+        com.recv(rcv_labels, prev, 4);
+        com.recv(rcv_mesh, prev, 5);
+        if (com.rank != 0) send_all();
+        check((rcv_words.size() == 4) && (rcv_words[2] == words[2]) && (rcv_words[3] == std::to_string(prev)),
+              "message of strings");
+        check((rcv_values.size() == 2) && (rcv_values["rank"] == prev), "message of a map");
+        check((rcv_rows.size() == 3) && (rcv_rows[2] == std::vector<double>(200, double(prev))),
+              "message of vectors");
+        check((rcv_labels.size() == 2) && (rcv_labels.back().text == std::to_string(prev)),
+              "message of a type with a Serializer");
+        check(rcv_mesh == make_mesh(prev), "message of a type with a serialize member");
+    }
+
+    // Broadcasts
+    Mesh bcasted = (com.rank == 0 ? make_mesh(42) : Mesh());
+    com.bcast(bcasted, bcasted, 0);
+    check(bcasted == make_mesh(42), "broadcast of an object");
+    std::vector<std::string> names;
+    if (com.rank == 0) names = {"a", "bb", "ccc"};
+    com.bcast(names, names, 0);
+    check((names.size() == 3) && (names[2] == "ccc"), "broadcast of strings");
+
+    return check.result();
+}
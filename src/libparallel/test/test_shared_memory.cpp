@@ -0,0 +1,63 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the node communicators and of the shared memory windows
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "parallel/window.hpp"
+#include "test_helper.hpp"
+#include <string>
+#include <vector>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv, false);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    auto node = com.split_shared();
+    check((node->size >= 1) && (node->size <= com.size), "size of the node communicator");
+    // Each process of the node writes in its part, and reads directly the part of the others
+    {
+        const std::size_t n = 16;
+        Parallel::SharedWindow<int> win(*node, n);
+        for (std::size_t i = 0; i < n; ++i) win.data()[i] = node->rank * 100 + int(i);
+        win.fence();
+        bool ok = true;
+        for (int rk = 0; rk < node->size; ++rk) {
+            ok = ok && (win.size(rk) == n);
+            for (std::size_t i = 0; i < n; ++i) ok = ok && (win.data(rk)[i] == rk * 100 + int(i));
+        }
+        check(ok, "direct read of the memory of the other processes");
+        win.fence();
+    }
+    // Table stored once per node, allocated by the first process of the node
+    {
+        const std::size_t n = 1000;
+        Parallel::SharedWindow<double> table(*node, node->rank == 0 ? n : 0);
+        check(table.size(0) == n, "size of the shared table");
+        if (node->rank == 0)
+            for (std::size_t i = 0; i < n; ++i) table.data()[i] = 0.5 * i;
+        table.fence();
+        const double *values = table.data(0);
+        bool ok              = true;
+        for (std::size_t i = 0; i < n; ++i) ok = ok && (values[i] == 0.5 * i);
+        check(ok, "table shared by the node");
+        table.fence();
+    }
+
+    return check.result();
+}
@@ -0,0 +1,90 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the sparse exchange : each process sends to a few processes chosen by a pseudo random
+// pattern, known only by the senders, during several consecutive exchanges.
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+struct Particle {
+    double position[3];
+    int identifier;
+};
+// Destinations of the process rank during the exchange round
+std::vector<int> destinations(int rank, int size, int round) {
+    std::vector<int> dests;
+    for (int d = 0; d < size; ++d)
+        if ((rank * 7 + d * 13 + round * 5) % 4 == 0) dests.push_back(d);
+    return dests;
+}
+// Number of values sent from source to dest ( empty, eager and large messages )
+std::size_t message_size(int source, int dest, int round) {
+    const std::size_t sizes[] = {0, 1, 100, 20000};
+    return sizes[(source + dest + round) % 4];
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+
+    // Consecutive exchanges without synchronisation between them
+    for (int round = 0; round < 10; ++round) {
+        std::map<int, std::vector<double>> messages;
+        for (int dest : destinations(com.rank, com.size, round))
+            messages[dest].assign(message_size(com.rank, dest, round), 1000. * com.rank + dest);
+        auto received          = com.sparse_exchange(messages);
+        bool ok                = true;
+        std::size_t nb_sources = 0;
+        for (int source = 0; source < com.size; ++source) {
+            auto dests = destinations(source, com.size, round);
+            if (std::find(dests.begin(), dests.end(), com.rank) == dests.end()) continue;
+            ++nb_sources;
+            const std::vector<double> expected(message_size(source, com.rank, round), 1000. * source + com.rank);
+            auto it = received.find(source);
+            ok      = ok && (it != received.end()) && (it->second == expected);
+        }
+        ok = ok && (received.size() == nb_sources);
+        check(ok, "sparse exchange of the round " + std::to_string(round));
+    }
+
+    // Migration of particles to the next process
+    std::map<int, std::vector<Particle>> leaving;
+    if (com.size > 1) {
+        auto &particles = leaving[(com.rank + 1) % com.size];
+        for (int i = 0; i < 3; ++i) particles.push_back(Particle{{double(i), 0., 0.}, 10 * com.rank + i});
+    }
+    auto arriving  = com.sparse_exchange(leaving);
+    const int prev = (com.rank + com.size - 1) % com.size;
+    check((com.size == 1 && arriving.empty()) ||
+              (arriving.size() == 1 && arriving[prev].size() == 3 && arriving[prev][2].identifier == 10 * prev + 2 &&
+               arriving[prev][2].position[0] == 2.),
+          "sparse exchange of structures");
+
+    // Nothing to send
+    check(com.sparse_exchange(std::map<int, std::vector<int>>()).empty(), "empty sparse exchange");
+
+    return check.result();
+}
@@ -0,0 +1,84 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the global communicator, of the deferred splits and of the startup times
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "core/multitimer.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/deferred_communicator.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv, Parallel::Context::Multiple);
+    Core::Logger log;
+    // The listener uses the global communicator : no other duplication
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    const Parallel::Communicator &com = Parallel::Context::globalCommunicator();
+    Test::Checker check(log, com);
+    check(Parallel::Context::startupTime(Parallel::Context::Initialization).nb_calls == 1, "time of the initialization");
+    check(Parallel::Context::startupTime(Parallel::Context::Duplication).nb_calls == 1, "single global communicator");
+    check(&Parallel::Context::globalCommunicator() == &com, "same global communicator");
+#if defined(USE_MPI)
+    // Concurrent accesses of the threads of a process to the global communicator
+    std::vector<const Parallel::Communicator *> seen(4, nullptr);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < seen.size(); ++t)
+        threads.emplace_back([&seen, t]() { seen[t] = &Parallel::Context::globalCommunicator(); });
+    for (auto &th : threads) th.join();
+    for (auto pt_com : seen) check(pt_com == &com, "global communicator shared by the threads");
+#endif
+
+    // The splits are only done by the use of the communicators
+    const unsigned long nb_splits = Parallel::Context::startupTime(Parallel::Context::Split).nb_calls;
+    Parallel::DeferredCommunicator evenOdd(com, com.rank % 2, com.rank);
+    Parallel::DeferredCommunicator unused(com, 0, com.rank);
+    check(!evenOdd.created() && (Parallel::Context::startupTime(Parallel::Context::Split).nb_calls == nb_splits),
+          "deferred split");
+    const Parallel::Communicator &half = evenOdd.get();
+    check(evenOdd.created() && (&evenOdd.get() == &half), "split at the first use");
+    check(half.size == (com.size + 1 - com.rank % 2) / 2 && half.rank == com.rank / 2, "ranks of the split");
+    int sum, expected = 0;
+    half.allreduce(com.rank, sum, Parallel::sum);
+    for (int r = com.rank % 2; r < com.size; r += 2) expected += r;
+    check(sum == expected, "communications on the deferred communicator");
+    Parallel::DeferredCommunicator node([&com]() { return com.split_shared(); });
+    check(node.get().size >= 1, "deferred split by node");
+    check(!unused.created() && (Parallel::Context::startupTime(Parallel::Context::Split).nb_calls == nb_splits + 2),
+          "number of splits");
+    // The communicators created after the startup aren't recorded
+    Parallel::Context::endStartup();
+    Parallel::Communicator late(com, com.rank % 2, com.rank), copy(com);
+    check(Parallel::Context::startupEnded() &&
+              (Parallel::Context::startupTime(Parallel::Context::Split).nb_calls == nb_splits + 2) &&
+              (Parallel::Context::startupTime(Parallel::Context::Duplication).nb_calls == 1),
+          "end of the startup");
+
+    // Report through the timer
+    Core::MultiTimer<std::string> timer;
+    timer.subscribe<Parallel::Context::StartupChronometer>("Startup");
+    std::ostringstream report;
+    report << timer;
+    check(report.str().find("[ Split of communicators ] => Number of calls : " + std::to_string(nb_splits + 2)) !=
+              std::string::npos,
+          "report of the startup times");
+    log << LogInformation << timer << std::endl;
+
+    return check.result();
+}
@@ -0,0 +1,83 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the distributed task pool on an irregular tree of tasks created by the rank 0
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "parallel/task_pool.hpp"
+#include "test_helper.hpp"
+#include <string>
+
+namespace {
+struct Node {
+    long id;
+    int depth;
+};
+// Number of children of a node : the tree is unbalanced
+int nb_children(const Node &node) { return (node.depth < 16 ? int((7 * node.id + node.depth) % 4) : 0); }
+// Some work for each task, so the other processes have the time to steal tasks
+double work(const Node &node) {
+    double x = double(node.id);
+    for (int i = 0; i < 2000; ++i) x = 0.5 * x + 1.;
+    return x;
+}
+// Number of nodes and sum of the identifiers of the subtree of node
+void count(const Node &node, long &nb_nodes, long &sum) {
+    ++nb_nodes;
+    sum += node.id;
+    for (int i = 0; i < nb_children(node); ++i) count(Node{3 * node.id + i + 1, node.depth + 1}, nb_nodes, sum);
+}
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    long nb_ref = 0, sum_ref = 0;
+    const Node root{2, 0};
+    count(root, nb_ref, sum_ref);
+
+    long sum = 0;
+    double dummy = 0.;
+    Parallel::TaskPool<Node> pool(com, [&](const Node &node, Parallel::TaskPool<Node> &p) {
+        dummy += work(node);
+        sum += node.id;
+        for (int i = 0; i < nb_children(node); ++i) p.push(Node{3 * node.id + i + 1, node.depth + 1});
+    });
+    // Several runs of the same pool, the second one with tasks on all the processes
+    for (int run = 0; run < 2; ++run) {
+        if ((com.rank == 0) || (run == 1)) pool.push(root);
+        pool.run();
+        check(pool.size() == 0, "empty deque at the end of the run");
+    }
+    long nb_executed = long(pool.nbTasksExecuted()), total_executed, total_sum, total_stolen;
+    com.allreduce(nb_executed, total_executed, Parallel::sum);
+    com.allreduce(sum, total_sum, Parallel::sum);
+    com.allreduce(long(pool.nbTasksStolen()), total_stolen, Parallel::sum);
+    check(total_executed == (com.size + 1) * nb_ref, "number of executed tasks");
+    check(total_sum == (com.size + 1) * sum_ref, "sum of the executed tasks");
+    if (com.size > 1) check(total_stolen > 0, "tasks stolen from the rank 0");
+    check(dummy > 0., "work of the tasks");
+
+    // Nothing to do
+    Parallel::TaskPool<Node> empty(com, [](const Node &, Parallel::TaskPool<Node> &) {});
+    empty.run();
+    check(empty.nbTasksExecuted() == 0, "run without tasks");
+
+    return check.result();
+}
@@ -0,0 +1,82 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the communications of several threads per process : each thread on its own channel,
+// then all the threads on one profiled communicator.
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "parallel/thread_channels.hpp"
+#include "test_helper.hpp"
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv, Parallel::Context::Multiple);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    check(context.levelOfThreadSupport() == Parallel::Context::Multiple, "multiple thread level support");
+    const int nb_threads = 4, nb_messages = 50;
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+    auto run = [nb_threads](const std::function<void(int)> &body) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nb_threads; ++t) threads.emplace_back(body, t);
+        for (auto &th : threads) th.join();
+    };
+
+    // Same tag and any source on all the channels : each thread receives only its messages
+    Parallel::ThreadChannels channels(com, nb_threads);
+    std::atomic<int> nb_errors(0);
+    run([&](int t) {
+        Parallel::Communicator &channel = channels[t];
+        for (int m = 0; m < nb_messages; ++m) {
+            std::vector<int> msg(100, 1000 * t + m), rcv;
+            Parallel::Request req = channel.isend(msg, next, 0);
+            channel.recv(rcv, Parallel::any_source, 0);
+            req.wait();
+            if (rcv != std::vector<int>(100, 1000 * t + m)) ++nb_errors;
+        }
+        int sum;
+        channel.allreduce(t, sum, Parallel::sum);
+        if (sum != t * channel.size) ++nb_errors;
+    });
+    check(nb_errors == 0, "messages on the channels of the threads");
+
+    // Concurrent messages on a profiled communicator, with a tag by thread
+    Parallel::Communicator shared(com);
+    Parallel::Communicator::Chronometer chrono(shared);
+    run([&](int t) {
+        for (int m = 0; m < nb_messages; ++m) {
+            double value = t + 0.5 * m, rcv;
+            Parallel::Request req = shared.isend(value, next, t);
+            shared.recv(rcv, prev, t);
+            req.wait();
+            if (rcv != value) ++nb_errors;
+        }
+    });
+    check(nb_errors == 0, "concurrent messages on a communicator");
+    std::ostringstream profile;
+    chrono.print(profile);
+    const std::string expected = "Number of calls : " + std::to_string(2 * nb_threads * nb_messages);
+    check(profile.str().find(expected) != std::string::npos, "profile of concurrent communications");
+
+    return check.result();
+}
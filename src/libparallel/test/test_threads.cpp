@@ -0,0 +1,149 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the threads implementation : the ranks are threads of this process
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "test_helper.hpp"
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+// Digits of a number : the concatenation is associative but not commutative
+struct Digits {
+    long value, power;
+};
+}
+
+int main(int nargs, char *argv[]) {
+    const int nbRanks = 4;
+    std::mutex mutex;
+    std::vector<std::string> errors;
+    // The calling thread is a single rank before the spawn : its global communicator isn't the one
+    // of its rank 0 in the spawn
+    Parallel::Context context(nargs, argv);
+    const Parallel::Communicator *single = &Parallel::Context::globalCommunicator();
+    // The listeners of the calling thread use its global communicator
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    log << LogInformation << "Spawn of " << nbRanks << " ranks" << std::endl;
+    Parallel::Context::spawn(nbRanks, [&]() {
+        Parallel::Context context(nargs, argv);
+        Parallel::Communicator com;
+        auto check = [&](bool cond, const std::string &msg) {
+            if (!cond) {
+                std::lock_guard<std::mutex> lock(mutex);
+                errors.push_back("Rank " + std::to_string(com.rank) + " : " + msg);
+            }
+        };
+        check((com.size == nbRanks) && (com.rank >= 0) && (com.rank < nbRanks), "size and rank of the world");
+        const Parallel::Communicator &global = Parallel::Context::globalCommunicator();
+        check((&global != single) && (global.size == nbRanks) && (global.rank == com.rank),
+              "global communicator of the spawned ranks");
+        const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+        // Point to point messages around a ring ( small and large messages )
+        {
+            int value = -1;
+            com.send(100 * com.rank, next, 1);
+            Parallel::Status status = com.recv(value, prev, 1);
+            check((value == 100 * prev) && (status.source() == prev) && (status.tag() == 1), "ring of small messages");
+            const std::size_t n = 200000;
+            std::vector<double> snd(n, double(com.rank)), rcv(n, -1.);
+            Parallel::Request rcv_req = com.irecv(n, rcv.data(), prev, 2);
+            Parallel::Request snd_req = com.isend(n, snd.data(), next, 2);
+            snd_req.wait();
+            rcv_req.wait();
+            check(std::all_of(rcv.begin(), rcv.end(), [prev](double x) { return x == prev; }),
+                  "ring of large messages");
+        }
+        // Messages from any source, containers sized by the incoming message
+        {
+            std::vector<int> values(com.rank + 1, com.rank);
+            if (com.rank != 0) com.send(values, 0, 3);
+            if (com.rank == 0) {
+                std::vector<bool> received(com.size, false);
+                received[0] = true;
+                for (int i = 1; i < com.size; ++i) {
+                    std::vector<int> incoming;
+                    Parallel::Status status = com.recv(incoming, Parallel::any_source, 3);
+                    int src                 = status.source();
+                    received[src]           = (incoming == std::vector<int>(src + 1, src));
+                }
+                check(std::vector<bool>(com.size, true) == received, "receive from any source");
+            }
+            std::list<double> lst(com.rank + 2, 0.5 * com.rank), incoming;
+            Parallel::Request req = com.irecv(incoming, prev, 4);
+            com.send(lst, next, 4);
+            req.wait();
+            check(incoming == std::list<double>(prev + 2, 0.5 * prev), "non blocking receive of a list");
+        }
+        // Collective operations
+        {
+            std::vector<double> values;
+            if (com.rank == 1) values = {1., 2., 3.};
+            com.bcast(values, 1);
+            check(values == std::vector<double>{1., 2., 3.}, "broadcast of a vector");
+            int sum;
+            com.allreduce(com.rank + 1, sum, Parallel::sum);
+            check(sum == com.size * (com.size + 1) / 2, "allreduce");
+            Digits loc{com.rank + 1, 10}, res{0, 0};
+            com.reduce(loc, res, [](const Digits &a, const Digits &b) { return Digits{a.value * b.power + b.value, a.power * b.power}; },
+                       false, 2);
+            if (com.rank == 2) check((res.value == 1234) && (res.power == 10000), "non commutative reduction");
+            std::vector<int> all(com.size);
+            com.allgather(com.rank, all.data());
+            std::vector<int> expected(com.size);
+            std::iota(expected.begin(), expected.end(), 0);
+            check(all == expected, "allgather");
+            std::vector<int> snd(com.size), rcv(com.size);
+            for (int i = 0; i < com.size; ++i) snd[i] = 10 * com.rank + i;
+            com.alltoall(snd.data(), rcv.data());
+            bool ok = true;
+            for (int i = 0; i < com.size; ++i) ok = ok && (rcv[i] == 10 * i + com.rank);
+            check(ok, "alltoall");
+            std::vector<int> gathered;
+            std::vector<std::size_t> counts = com.gatherv(std::vector<int>(com.rank, com.rank), gathered, 0);
+            if (com.rank == 0) check((counts.size() == std::size_t(com.size)) && (gathered.size() == 6), "gatherv");
+            com.barrier();
+        }
+        // Sub-communicators : the messages of two communicators never match
+        {
+            Parallel::Communicator half(com, com.rank % 2, -com.rank);
+            check(half.size == com.size / 2, "size of the split communicator");
+            check(half.translateRank(com) == com.rank, "translation of the ranks");
+            int first;
+            half.allreduce(com.rank, first, Parallel::max);
+            check(first == com.size - 2 + com.rank % 2, "reduction in the split communicator");
+            Parallel::Communicator dup(com.externalCommunicator());
+            int token = -1;
+            dup.send(com.rank, next, 5);
+            com.send(-com.rank, next, 5);
+            com.recv(token, prev, 5);
+            check(token == -prev, "isolation of the duplicated communicator");
+            dup.recv(token, prev, 5);
+            check(token == prev, "message on the duplicated communicator");
+        }
+    });
+    if ((&Parallel::Context::globalCommunicator() != single) || (single->size != 1))
+        errors.push_back("Rank 0 : global communicator after the spawn");
+
+    for (const auto &error : errors) log << LogError << error << " failed !" << std::endl;
+    return Test::verdict(log, errors.empty());
+}
@@ -0,0 +1,85 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the tracing of the communications
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "parallel/tracer.hpp"
+#include "test_helper.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    using Parallel::Tracer;
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+    // Nothing is recorded while the tracing is disabled
+    com.barrier();
+    check(!Tracer::enabled() && Tracer::events().empty(), "disabled tracer");
+
+    Tracer::enable(16);
+    std::vector<double> snd(100, 1.), rcv(100);
+    Parallel::Request req = com.isend(snd.size(), snd.data(), next, 7);
+    Parallel::Status status = com.recv(rcv.size(), rcv.data(), prev, 7);
+    req.wait();
+    check((status.source() == prev) && (status.tag() == 7), "status of the traced receive");
+    std::vector<int> values(4, 0); // The receivers give the size of the message
+    if (com.rank == 0) {
+        values = {1, 2, 3, 4};
+        com.bcast(values, values, 0);
+    } else
+        com.bcast(values, 0);
+    int sum;
+    com.allreduce(1, sum, Parallel::sum);
+    std::vector<Tracer::Event> events = Tracer::events();
+    check(events.size() == 4, "number of events");
+    if (events.size() == 4) {
+        check((events[0].call == Tracer::isend) && (events[0].peer == com.worldRank(next)) && (events[0].tag == 7) &&
+                  (events[0].bytes == 100 * sizeof(double)),
+              "event of isend");
+        check((events[1].call == Tracer::recv) && (events[1].peer == com.worldRank(prev)) &&
+                  (events[1].bytes == 100 * sizeof(double)) && (events[1].end >= events[1].start),
+              "event of recv");
+        check((events[2].call == Tracer::bcast) && (events[2].bytes == 4 * sizeof(int)), "event of bcast");
+        check((events[3].call == Tracer::allreduce) && (events[3].peer == Tracer::all), "event of allreduce");
+    }
+    // The ring buffer keeps the last events
+    for (int i = 0; i < 20; ++i) com.barrier();
+    events = Tracer::events();
+    check((events.size() == 16) && (events.back().call == Tracer::barrier), "ring buffer of the events");
+
+    std::ostringstream out;
+    Tracer::report(out, com);
+    if (com.rank == 0) {
+        const std::string text = out.str();
+        check(text.find("Traffic matrix") != std::string::npos, "traffic matrix in the report");
+        check(text.find("isend") != std::string::npos, "statistics of isend in the report");
+        check(text.find("Message sizes") != std::string::npos, "histogram in the report");
+    } else
+        check(out.str().empty(), "report written by the root only");
+    // The report isn't traced
+    check(Tracer::events().size() == 16 && Tracer::events().back().call == Tracer::barrier, "untraced report");
+    Tracer::disable();
+    com.barrier();
+    check(Tracer::events().back().call == Tracer::barrier && !Tracer::enabled(), "disabled tracer");
+
+    return check.result();
+}
@@ -0,0 +1,96 @@
+// Copyright 2017 Dr. Xavier JUVIGNY
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Test of the one-sided communications
+#include "core/log_to_std_output.hpp"
+#include "core/logger.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "parallel/window.hpp"
+#include "test_helper.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+struct Point {
+    double x, y, z;
+};
+}
+
+int main(int nargs, char *argv[]) {
+    Parallel::Context context(nargs, argv, false);
+    Parallel::Communicator com;
+    Core::Logger log;
+    log.subscribe(new Parallel::LogFromRootOutput<Core::LogToStdOutput>(Core::Logger::information));
+    Test::Checker check(log, com);
+    const int next = (com.rank + 1) % com.size, prev = (com.rank + com.size - 1) % com.size;
+    // Window on user memory, fence epochs : put in the next process, accumulate on the first one
+    {
+        std::vector<int> mem(com.size + 1, 0);
+        Parallel::Window<int> win(com, mem.data(), mem.size());
+        {
+            Parallel::Window<int>::FenceEpoch epoch(win);
+            win.put(com.rank, next, 0);
+            win.accumulate(com.rank + 1, 0, 1);
+        }
+        check(mem[0] == prev, "put in a fence epoch");
+        if (com.rank == 0) check(mem[1] == com.size * (com.size + 1) / 2, "accumulate in a fence epoch");
+    }
+    // Window allocated by MPI, passive target epochs : get the points of the previous process
+    {
+        Parallel::Window<Point> win(com, 4);
+        for (std::size_t i = 0; i < win.size(); ++i) win.data()[i] = Point{double(com.rank), double(i), -1.};
+        com.barrier();
+        std::vector<Point> remote(2);
+        {
+            Parallel::Window<Point>::LockEpoch epoch(win, prev);
+            win.get(2, remote.data(), prev, 1);
+        }
+        check((remote[0].x == prev) && (remote[0].y == 1.) && (remote[1].y == 2.), "get of packed objects");
+        com.barrier();
+    }
+    // Shared counter : each process takes a ticket
+    {
+        Parallel::Window<long> win(com, 1);
+        win.data()[0] = 0;
+        com.barrier();
+        long ticket;
+        {
+            Parallel::Window<long>::LockAllEpoch epoch(win);
+            ticket = win.fetch_and_op(1L, 0, 0);
+        }
+        std::vector<long> tickets(com.size);
+        com.allgather(ticket, tickets.data());
+        std::vector<bool> taken(com.size, false);
+        for (long t : tickets)
+            if ((t >= 0) && (t < com.size)) taken[t] = true;
+        check(std::vector<bool>(com.size, true) == taken, "fetch and op");
+        // Inside a fence epoch, the previous value is given by the fence
+        com.barrier();
+        if (com.rank == 0) win.data()[0] = 0;
+        ticket = -1;
+        {
+            Parallel::Window<long>::FenceEpoch epoch(win);
+            win.fetch_and_op(1L, ticket, 0, 0);
+        }
+        com.allgather(ticket, tickets.data());
+        taken.assign(com.size, false);
+        for (long t : tickets)
+            if ((t >= 0) && (t < com.size)) taken[t] = true;
+        check(std::vector<bool>(com.size, true) == taken, "fetch and op in a fence epoch");
+        if (com.rank == 0) check(win.data()[0] == com.size, "counter after a fence epoch");
+    }
+
+    return check.result();
+}
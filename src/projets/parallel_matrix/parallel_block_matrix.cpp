@@ -4,9 +4,15 @@
 #include <string>
 #include <tuple>
 #include <vector>
+#include "core/log_to_std_output.hpp"
 #include "core/logger.hpp"
 #include "core/multitimer.hpp"
 #include "core/std_cpp_chronometer.hpp"
+#include "parallel/broadcast_pipeline.hpp"
+#include "parallel/communicator"
+#include "parallel/context.hpp"
+#include "parallel/log_from_root_output.hpp"
+#include "parallel/process_grid.hpp"
 
 /**
  * @brief      Représentation d'un bloc de matrice
@@ -81,18 +87,19 @@ private:
  * brief       Compute tensorial vectors
  *
  * Compute two pairs of vectors. Each pair of vectors define a tensor product to
- * compute respectivly the coefficients of the A and B matrices.
+ * compute respectivly the coefficients of the A and B matrices. Only the dim_block
+ * coefficients beginning at the row begRows and at the column begCols are computed.
  */
 template < typename K >
-auto computeTensorVectors( std::size_t dim ) {
+auto computeTensorVectors( std::size_t dim, std::size_t dim_block, std::size_t begRows, std::size_t begCols ) {
     const K          pi = std::acos( K( -1 ) );
-    std::vector< K > u1_r( dim ), v1_c( dim ), u2_r( dim ), v2_c( dim );
+    std::vector< K > u1_r( dim_block ), v1_c( dim_block ), u2_r( dim_block ), v2_c( dim_block );
     const K          lx = 1., ly = 2.;
-    for ( size_t i = 0; i < dim; ++i ) {
-        u1_r[i] = std::cos( 2 * i * pi / dim );
-        v1_c[i] = std::sin( 2 * i * pi / dim );
-        u2_r[i] = i * lx / dim;
-        v2_c[i] = i * ly / dim;
+    for ( size_t i = 0; i < dim_block; ++i ) {
+        u1_r[i] = std::cos( 2 * ( i + begRows ) * pi / dim );
+        v1_c[i] = std::sin( 2 * ( i + begCols ) * pi / dim );
+        u2_r[i] = ( i + begRows ) * lx / dim;
+        v2_c[i] = ( i + begCols ) * ly / dim;
     }
     return std::make_tuple( u1_r, v1_c, u2_r, v2_c );
 }
@@ -169,6 +176,10 @@ bool verifyProdMatMat( std::size_t dimBlock, const K &alpha, const std::vector<
 // _____________________________________________________________________________
 // =============================================================================
 int main( int nargs, char *argv[] ) {
+    Parallel::Context      context( nargs, argv );
+    Parallel::Communicator globCom;
+    Core::Logger           log;
+    log.subscribe( new Parallel::LogFromRootOutput< Core::LogToStdOutput >( Core::Logger::information ) );
     bool profiled = false;
     bool trace = false;
     for ( int iargs = 2; iargs < nargs; ++iargs ) {
@@ -182,6 +193,21 @@ int main( int nargs, char *argv[] ) {
 
     std::size_t dim      = 120;
     if ( nargs > 1 ) dim = std::stoul( std::string( argv[1] ) );
+    // Grid of p x p processes, each one computing a block of C
+    int                   p = int( std::sqrt( globCom.size ) );
+    Parallel::ProcessGrid grid( globCom, {p, p} );
+    std::size_t           dim_block = dim / p;
+    std::size_t           begRow    = grid.coordinates( )[0] * dim_block;
+    std::size_t           begCol    = grid.coordinates( )[1] * dim_block;
+    auto                  rowCom    = grid.line( 1 );
+    auto                  colCom    = grid.line( 0 );
+    if ( trace )
+        log << LogInformation << "Block " << grid.coordinates( )[0] << " : " << grid.coordinates( )[1] << " of "
+            << p << " x " << p << " blocks of dimension " << dim_block << std::endl;
+    if ( profiled ) {
+        timer.subscribe< Parallel::Communicator::Chronometer >( "Row Communicator", *rowCom );
+        timer.subscribe< Parallel::Communicator::Chronometer >( "Column Communicator", *colCom );
+    }
     timer.subscribe< Core::StdChronometer >( "Compute tensor vectors" );
     timer.subscribe< Core::StdChronometer >( "Compute matrices" );
     timer.subscribe< Core::StdChronometer >( "Product Matrix-matrix" );
@@ -189,7 +215,7 @@ int main( int nargs, char *argv[] ) {
 
     timer["Compute tensor vectors"].start( );
     std::vector< double > uA, vA, uB, vB;
-    std::tie( uA, vA, uB, vB ) = computeTensorVectors< double >( dim );
+    std::tie( uA, vA, uB, vB ) = computeTensorVectors< double >( dim, dim_block, begRow, begCol );
     timer["Compute tensor vectors"].stop( );
 
     timer["Compute matrices"].start( );
@@ -197,20 +223,29 @@ int main( int nargs, char *argv[] ) {
     auto B = computeMatrice( uB, vB );
     timer["Compute matrices"].stop( );
     BlockMatrix< double > C( A.getNRows( ), B.getNCols( ) );
-    // Parallel product :
+    // Parallel product : the blocks of A and B of the step k+1 are broadcast in the rows and the
+    // columns of the grid during the product of the blocks of the step k
 
     timer["Product Matrix-matrix"].start( );
-    prodMatrixMatrixBloc( A, B, C );
+    Parallel::BroadcastPipeline< BlockMatrix< double > > pipeline;
+    pipeline.add( *rowCom, A, []( int k ) { return k; }, [&A]( int ) -> const BlockMatrix< double > & { return A; } );
+    pipeline.add( *colCom, B, []( int k ) { return k; }, [&B]( int ) -> const BlockMatrix< double > & { return B; } );
+    pipeline.run( p, [&C]( int, const std::vector< const BlockMatrix< double > * > &blocks ) {
+        prodMatrixMatrixBloc( *blocks[0], *blocks[1], C );
+    } );
     timer["Product Matrix-matrix"].stop( );
 
     timer["Verify Matrix-matrix"].start( );
-    std::tie( std::ignore, vA, uB, std::ignore ) = computeTensorVectors< double >( dim );
+    std::tie( std::ignore, vA, uB, std::ignore ) = computeTensorVectors< double >( dim, dim, 0, 0 );
     double vAdotuB = dotProduct( vA, uB );
-    if ( verifyProdMatMat( dim, vAdotuB, uA, vB, C ) ) {
-        std::cout << Core::Logger::BGreen << "Test passed." << Core::Logger::Normal << std::endl;
+    int    isOK    = ( verifyProdMatMat( dim_block, vAdotuB, uA, vB, C ) ? 1 : 0 ), allOK;
+    globCom.allreduce( isOK, allOK, Parallel::min );
+    if ( allOK == 1 ) {
+        log << LogInformation << Core::Logger::BGreen << "Test passed." << Core::Logger::Normal << std::endl;
     } else {
+        log << LogError << "Test failed !" << std::endl;
     }
     timer["Verify Matrix-matrix"].stop( );
-    std::cout << timer << std::endl;
-    return EXIT_SUCCESS;
+    log << LogInformation << timer << std::endl;
+    return ( allOK == 1 ? EXIT_SUCCESS : EXIT_FAILURE );
 }